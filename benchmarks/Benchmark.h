@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal benchmark harness which times a function and writes the results as JSON lines (one object per benchmark
+ * case), so that results of different runs can be compared by a script.
+ */
+class BenchmarkRunner
+{
+public:
+    /**
+     * Describes a single benchmark case.
+     */
+    struct Case
+    {
+        std::string suite;
+        std::string name;
+        std::string sampleType;
+        int numChannels = 0;
+        int numSamples = 0;
+        int numMeters = 1;
+    };
+
+    /**
+     * Constructor.
+     * @param output The stream to write the results to.
+     * @param filter Only cases whose suite or name contains this string are run. An empty filter runs all cases.
+     * @param quick When true, cases run for a shorter amount of time (and benchmarks may limit their parameters).
+     */
+    BenchmarkRunner (std::ostream& output, std::string filter, bool quick) :
+        mOutput (output),
+        mFilter (std::move (filter)),
+        mQuick (quick)
+    {
+    }
+
+    /**
+     * @return True if running in quick mode.
+     */
+    [[nodiscard]] bool isQuick() const
+    {
+        return mQuick;
+    }
+
+    /**
+     * @return True if given case should run.
+     */
+    [[nodiscard]] bool shouldRun (const Case& benchmarkCase) const
+    {
+        return mFilter.empty() || benchmarkCase.suite.find (mFilter) != std::string::npos ||
+               benchmarkCase.name.find (mFilter) != std::string::npos;
+    }
+
+    /**
+     * Times given function, of which each call counts as a single iteration.
+     * @param benchmarkCase The case to report.
+     * @param fn The function to time.
+     */
+    template <class Function>
+    void run (const Case& benchmarkCase, Function&& fn)
+    {
+        runBatched (benchmarkCase, std::numeric_limits<int>::max(), fn, [] {});
+    }
+
+    /**
+     * Times given function, of which each call counts as a single iteration. After every batchSize calls, between() is
+     * called outside of the timed region (for example to drain a queue which would otherwise grow).
+     * @param benchmarkCase The case to report.
+     * @param batchSize The max number of calls in between calls to between().
+     * @param fn The function to time.
+     * @param between The function to call in between batches.
+     */
+    template <class Function, class Between>
+    void runBatched (const Case& benchmarkCase, int batchSize, Function&& fn, Between&& between)
+    {
+        if (!shouldRun (benchmarkCase))
+            return;
+
+        auto const targetNs = mQuick ? kQuickTargetNs : kTargetNs;
+
+        // Find the number of iterations which takes at least the target time. This also warms up caches.
+        int64_t numIterations = 1;
+        while (time (numIterations, batchSize, fn, between) < targetNs && numIterations < (int64_t { 1 } << 40))
+            numIterations *= 2;
+
+        std::vector<double> nsPerIteration;
+        for (int i = 0; i < (mQuick ? kQuickNumRepetitions : kNumRepetitions); i++)
+        {
+            auto const elapsedNs = time (numIterations, batchSize, fn, between);
+            nsPerIteration.push_back (elapsedNs / static_cast<double> (numIterations));
+        }
+
+        std::sort (nsPerIteration.begin(), nsPerIteration.end());
+
+        mOutput << "{\"suite\":\"" << benchmarkCase.suite << "\",\"name\":\"" << benchmarkCase.name
+                << "\",\"sample_type\":\"" << benchmarkCase.sampleType
+                << "\",\"channels\":" << benchmarkCase.numChannels << ",\"samples\":" << benchmarkCase.numSamples
+                << ",\"meters\":" << benchmarkCase.numMeters
+                << ",\"iterations\":" << numIterations
+                << ",\"ns_min\":" << nsPerIteration.front()
+                << ",\"ns_median\":" << nsPerIteration[nsPerIteration.size() / 2] << "}" << std::endl;
+    }
+
+private:
+    static constexpr double kTargetNs = 20.0e6;
+    static constexpr double kQuickTargetNs = 2.0e6;
+    static constexpr int kNumRepetitions = 5;
+    static constexpr int kQuickNumRepetitions = 3;
+
+    std::ostream& mOutput;
+    std::string mFilter;
+    bool mQuick = false;
+
+    template <class Function, class Between>
+    static double time (int64_t numIterations, int batchSize, Function& fn, Between& between)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double elapsedNs = 0.0;
+
+        for (int64_t done = 0; done < numIterations;)
+        {
+            auto const count = std::min (static_cast<int64_t> (batchSize), numIterations - done);
+
+            auto const start = Clock::now();
+            for (int64_t i = 0; i < count; i++)
+                fn();
+            auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (Clock::now() - start);
+            elapsedNs += static_cast<double> (elapsed.count());
+
+            between();
+            done += count;
+        }
+
+        return elapsedNs;
+    }
+};
+
+/**
+ * Makes sure the compiler can't optimise away the calculation of given value.
+ */
+template <class T>
+void doNotOptimise (const T& value)
+{
+    static volatile T sink;
+    sink = value;
+    static_cast<void> (sink);
+}
+
+/// The channel counts to benchmark with.
+inline std::vector<int> getBenchmarkChannelCounts (const BenchmarkRunner& runner)
+{
+    if (runner.isQuick())
+        return { 1, 2, 64 };
+    return { 1, 2, 8, 64, 256, 1024 };
+}
+
+/// The buffer sizes to benchmark with.
+inline std::vector<int> getBenchmarkBufferSizes (const BenchmarkRunner& runner)
+{
+    if (runner.isQuick())
+        return { 64, 1024 };
+    return { 16, 64, 256, 1024, 4096 };
+}
+
+/**
+ * @return The name of given sample type, as reported in the results.
+ */
+template <typename SampleType>
+std::string getSampleTypeName()
+{
+    return std::is_same_v<SampleType, float> ? "float" : "double";
+}
+
+/**
+ * Creates a buffer filled with (reproducible) white noise.
+ * @param numChannels The number of channels.
+ * @param numSamples The number of samples.
+ * @param gain The peak level of the noise.
+ */
+template <typename SampleType>
+juce::AudioBuffer<SampleType> createNoiseBuffer (int numChannels, int numSamples, SampleType gain = 0.5)
+{
+    juce::AudioBuffer<SampleType> buffer (numChannels, numSamples);
+    std::mt19937 generator (42);
+    std::uniform_real_distribution<SampleType> distribution (-gain, gain);
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        auto* channelData = buffer.getWritePointer (ch);
+        for (int i = 0; i < numSamples; i++)
+            channelData[i] = distribution (generator);
+    }
+
+    return buffer;
+}
+
+void runMeteringBenchmarks (BenchmarkRunner& runner);
+void runConversionBenchmarks (BenchmarkRunner& runner);
+void runComponentBenchmarks (BenchmarkRunner& runner);
@@ -0,0 +1,140 @@
+#include "Benchmark.h"
+
+#include <juce-extensions/audio/metering/LevelMeterRegistry.h>
+#include <juce-extensions/components/metering/BackgroundRenderer.h>
+#include <juce-extensions/components/metering/LevelMeterComponent.h>
+
+namespace
+{
+void benchmarkLevelMeterComponentPaint (BenchmarkRunner& runner, int numChannels, int width, int height)
+{
+    auto const name = std::string ("LevelMeterComponent::paint/") + (width > height ? "horizontal" : "vertical");
+
+    BenchmarkRunner::Case benchmarkCase { "components", name, "double", numChannels, 0 };
+
+    if (!runner.shouldRun (benchmarkCase))
+        return;
+
+    LevelMeter levelMeter;
+    levelMeter.prepareToPlay (numChannels);
+
+    LevelMeterComponent levelMeterComponent (levelMeter);
+    levelMeterComponent.setBounds (0, 0, width, height);
+
+    auto const buffer = createNoiseBuffer<float> (numChannels, 512, 0.9f);
+
+    // Keeps the meter moving, otherwise the levels would return to silence during the benchmark.
+    auto feedLevelMeter = [&] {
+        levelMeter.measureBlock (buffer);
+        levelMeter.dispatchMeasurements();
+    };
+
+    feedLevelMeter();
+
+    juce::Image image (juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+    juce::Graphics g (image);
+
+    runner.runBatched (
+        benchmarkCase,
+        64,
+        [&] {
+            levelMeterComponent.paint (g);
+        },
+        feedLevelMeter);
+}
+
+const char* getRenderingModeName (LevelMeterComponent::RenderingMode const renderingMode)
+{
+    switch (renderingMode)
+    {
+        case LevelMeterComponent::RenderingMode::messageThread:
+            return "messageThread";
+        case LevelMeterComponent::RenderingMode::workerThreads:
+            return "workerThreads";
+    }
+
+    return "";
+}
+
+/**
+ * Measures the time the message thread spends on a single frame of many meters: the tick of the registry plus painting
+ * every meter. When rendering on worker threads, the renders started by a frame finish outside of the timing.
+ */
+void benchmarkLevelMeterComponentFrame (BenchmarkRunner& runner, LevelMeterComponent::RenderingMode const renderingMode)
+{
+    constexpr int kNumChannels = 2;
+    constexpr int kNumSamples = 512;
+    constexpr int kWidth = 20;
+    constexpr int kHeight = 300;
+
+    auto const meterCounts = runner.isQuick() ? std::vector<int> { 1, 100 } : std::vector<int> { 1, 10, 100, 1000 };
+    auto const name = std::string ("LevelMeterComponent::frame/") + getRenderingModeName (renderingMode);
+    auto const options = LevelMeterComponent::Options::getDefault().withRenderingMode (renderingMode);
+
+    for (auto numMeters : meterCounts)
+    {
+        BenchmarkRunner::Case benchmarkCase { "components", name, "float", kNumChannels, kNumSamples, numMeters };
+
+        if (!runner.shouldRun (benchmarkCase))
+            continue;
+
+        std::vector<std::unique_ptr<LevelMeter>> levelMeters;
+        std::vector<std::unique_ptr<LevelMeterComponent>> levelMeterComponents;
+
+        for (int i = 0; i < numMeters; i++)
+        {
+            auto& levelMeter = *levelMeters.emplace_back (std::make_unique<LevelMeter>());
+            levelMeter.prepareToPlay (kNumChannels);
+
+            auto& levelMeterComponent = *levelMeterComponents.emplace_back (std::make_unique<LevelMeterComponent> (
+                levelMeter,
+                LevelMeter::Scale::getDefaultScale(),
+                options));
+            levelMeterComponent.setBounds (0, 0, kWidth, kHeight);
+            levelMeterComponent.setVisible (true);
+        }
+
+        auto const buffer = createNoiseBuffer<float> (kNumChannels, kNumSamples, 0.9f);
+        juce::SharedResourcePointer<LevelMeterRegistry> registry;
+        juce::SharedResourcePointer<BackgroundRenderer> renderer;
+
+        // Every meter gets painted over the same image, which is all the message thread would do with it.
+        juce::Image image (juce::Image::ARGB, kWidth, kHeight, true, juce::SoftwareImageType());
+        juce::Graphics g (image);
+
+        auto measureBlocks = [&] {
+            renderer->waitUntilIdle();
+
+            for (auto& levelMeter : levelMeters)
+                levelMeter->measureBlock (buffer);
+        };
+
+        measureBlocks();
+
+        runner.runBatched (
+            benchmarkCase,
+            1,
+            [&] {
+                registry->dispatchMeasurements();
+
+                for (auto& levelMeterComponent : levelMeterComponents)
+                    levelMeterComponent->paint (g);
+            },
+            measureBlocks);
+
+        renderer->waitUntilIdle();
+    }
+}
+} // namespace
+
+void runComponentBenchmarks (BenchmarkRunner& runner)
+{
+    for (auto numChannels : getBenchmarkChannelCounts (runner))
+    {
+        benchmarkLevelMeterComponentPaint (runner, numChannels, 200, 400);
+        benchmarkLevelMeterComponentPaint (runner, numChannels, 400, 40);
+    }
+
+    benchmarkLevelMeterComponentFrame (runner, LevelMeterComponent::RenderingMode::messageThread);
+    benchmarkLevelMeterComponentFrame (runner, LevelMeterComponent::RenderingMode::workerThreads);
+}
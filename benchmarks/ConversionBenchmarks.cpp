@@ -0,0 +1,54 @@
+#include "Benchmark.h"
+
+#include <juce-extensions/audio/conversion/ChannelConversion.h>
+
+namespace
+{
+template <typename SrcType, typename DstType>
+void benchmarkAddConvertChannels (BenchmarkRunner& runner, int numInputChannels, int numOutputChannels)
+{
+    auto const sampleTypeName = getSampleTypeName<SrcType>() + "->" + getSampleTypeName<DstType>();
+    auto const name = "addConvertChannels/" + std::to_string (numInputChannels) + "to" +
+                      std::to_string (numOutputChannels);
+
+    for (auto numSamples : getBenchmarkBufferSizes (runner))
+    {
+        BenchmarkRunner::Case benchmarkCase { "conversion", name, sampleTypeName, numInputChannels, numSamples };
+
+        if (!runner.shouldRun (benchmarkCase))
+            continue;
+
+        auto src = createNoiseBuffer<SrcType> (numInputChannels, numSamples);
+        juce::AudioBuffer<DstType> dst (numOutputChannels, numSamples);
+
+        // Clear every now and then, to keep the values from growing out of range.
+        runner.runBatched (
+            benchmarkCase,
+            1024,
+            [&] {
+                addConvertChannels (src, dst);
+            },
+            [&] {
+                dst.clear();
+            });
+    }
+}
+
+template <typename SrcType, typename DstType>
+void benchmarkAddConvertChannels (BenchmarkRunner& runner)
+{
+    benchmarkAddConvertChannels<SrcType, DstType> (runner, 1, 2);
+    benchmarkAddConvertChannels<SrcType, DstType> (runner, 2, 1);
+
+    for (auto numChannels : getBenchmarkChannelCounts (runner))
+        benchmarkAddConvertChannels<SrcType, DstType> (runner, numChannels, numChannels);
+}
+} // namespace
+
+void runConversionBenchmarks (BenchmarkRunner& runner)
+{
+    benchmarkAddConvertChannels<float, float> (runner);
+    benchmarkAddConvertChannels<double, double> (runner);
+    benchmarkAddConvertChannels<double, float> (runner);
+    benchmarkAddConvertChannels<float, double> (runner);
+}
@@ -0,0 +1,56 @@
+#include "Benchmark.h"
+
+#include <fstream>
+#include <iostream>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * Runs the benchmarks and writes the results as JSON lines.
+ *
+ * Usage: juce-extensions-benchmarks [--filter <text>] [--output <file>] [--quick]
+ */
+int main (int argc, char* argv[])
+{
+    std::string filter;
+    std::string outputPath;
+    bool quick = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string const argument = argv[i];
+
+        if (argument == "--filter" && i + 1 < argc)
+            filter = argv[++i];
+        else if (argument == "--output" && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (argument == "--quick")
+            quick = true;
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--filter <text>] [--output <file>] [--quick]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Needed for the timers used by the level meters and for painting components.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    std::ofstream outputFile;
+    if (!outputPath.empty())
+    {
+        outputFile.open (outputPath);
+        if (!outputFile)
+        {
+            std::cerr << "Failed to open " << outputPath << std::endl;
+            return 1;
+        }
+    }
+
+    BenchmarkRunner runner (outputPath.empty() ? std::cout : outputFile, filter, quick);
+
+    runMeteringBenchmarks (runner);
+    runConversionBenchmarks (runner);
+    runComponentBenchmarks (runner);
+
+    return 0;
+}
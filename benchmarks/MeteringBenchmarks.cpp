@@ -0,0 +1,177 @@
+#include "Benchmark.h"
+
+#include <juce-extensions/audio/metering/LevelMeter.h>
+
+namespace
+{
+/// The number of measureBlock calls in between draining the measurement queue.
+constexpr int kBlocksPerDispatch = 16;
+
+/**
+ * @return A set of levels spread (logarithmically) over the whole range of the default scale, and a bit beyond.
+ */
+std::vector<double> createLevels()
+{
+    std::vector<double> levels (4096);
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        auto const levelDb = -110.0 + 116.0 * static_cast<double> (i) / static_cast<double> (levels.size() - 1);
+        levels[i] = juce::Decibels::decibelsToGain (levelDb, -200.0);
+    }
+    return levels;
+}
+
+template <typename SampleType>
+void benchmarkMeasureBlock (BenchmarkRunner& runner, bool const instrumented)
+{
+    for (auto numChannels : getBenchmarkChannelCounts (runner))
+    {
+        for (auto numSamples : getBenchmarkBufferSizes (runner))
+        {
+            BenchmarkRunner::Case benchmarkCase {
+                "metering",
+                instrumented ? "LevelMeter::measureBlock/instrumented" : "LevelMeter::measureBlock",
+                getSampleTypeName<SampleType>(),
+                numChannels,
+                numSamples,
+            };
+
+            if (!runner.shouldRun (benchmarkCase))
+                continue;
+
+            LevelMeter levelMeter;
+            levelMeter.prepareToPlay (numChannels);
+            levelMeter.setInstrumentationEnabled (instrumented);
+            auto buffer = createNoiseBuffer<SampleType> (numChannels, numSamples);
+
+            runner.runBatched (
+                benchmarkCase,
+                kBlocksPerDispatch,
+                [&] {
+                    levelMeter.measureBlock (buffer);
+                },
+                [&] {
+                    levelMeter.dispatchMeasurements();
+                });
+        }
+    }
+}
+
+/**
+ * A subscriber which only keeps track of the levels, like every subscriber does.
+ */
+class BenchmarkSubscriber : public LevelMeter::Subscriber
+{
+public:
+    explicit BenchmarkSubscriber (LevelMeter& levelMeter) :
+        Subscriber (LevelMeter::Scale::getDefaultScale())
+    {
+        subscribeToLevelMeter (levelMeter);
+    }
+
+private:
+    void levelMeterPrepared ([[maybe_unused]] int numChannels) override {}
+};
+
+const char* getDispatchModeName (LevelMeter::DispatchMode const dispatchMode)
+{
+    switch (dispatchMode)
+    {
+        case LevelMeter::DispatchMode::everyMeasurement:
+            return "everyMeasurement";
+        case LevelMeter::DispatchMode::peakPerTick:
+            return "peakPerTick";
+        case LevelMeter::DispatchMode::changedChannels:
+            return "changedChannels";
+    }
+
+    return "";
+}
+
+/**
+ * Measures the cost of a single tick of the registry, as a function of the number of level meters.
+ */
+void benchmarkRegistryTick (BenchmarkRunner& runner, LevelMeter::DispatchMode const dispatchMode)
+{
+    constexpr int kNumChannels = 2;
+    constexpr int kNumSamples = 512;
+
+    auto const meterCounts = runner.isQuick() ? std::vector<int> { 1, 100 } : std::vector<int> { 1, 10, 100, 1000 };
+    auto const name = std::string ("LevelMeterRegistry::dispatchMeasurements/") + getDispatchModeName (dispatchMode);
+
+    for (auto numMeters : meterCounts)
+    {
+        BenchmarkRunner::Case benchmarkCase { "metering", name, "float", kNumChannels, kNumSamples, numMeters };
+
+        if (!runner.shouldRun (benchmarkCase))
+            continue;
+
+        std::vector<std::unique_ptr<LevelMeter>> levelMeters;
+        std::vector<std::unique_ptr<BenchmarkSubscriber>> subscribers;
+
+        for (int i = 0; i < numMeters; i++)
+        {
+            auto& levelMeter = *levelMeters.emplace_back (std::make_unique<LevelMeter>());
+            levelMeter.prepareToPlay (kNumChannels);
+            levelMeter.setDispatchMode (dispatchMode);
+            subscribers.push_back (std::make_unique<BenchmarkSubscriber> (levelMeter));
+        }
+
+        auto const buffer = createNoiseBuffer<float> (kNumChannels, kNumSamples);
+        juce::SharedResourcePointer<LevelMeterRegistry> registry;
+
+        // Every tick dispatches the blocks measured since the previous tick, which is not part of the timing.
+        auto measureBlocks = [&] {
+            for (auto& levelMeter : levelMeters)
+                for (int i = 0; i < kBlocksPerDispatch; i++)
+                    levelMeter->measureBlock (buffer);
+        };
+
+        measureBlocks();
+
+        runner.runBatched (
+            benchmarkCase,
+            1,
+            [&] {
+                registry->dispatchMeasurements();
+            },
+            measureBlocks);
+    }
+}
+
+template <typename SampleType>
+void benchmarkLevelPeakValue (BenchmarkRunner& runner, const std::vector<double>& levels)
+{
+    LevelPeakValue<SampleType> peakValue;
+    peakValue.setPeakHoldTime (LevelMeterConstants::kPeakHoldDefaultValueTimeMs);
+    size_t i = 0;
+
+    runner.run ({ "metering", "LevelPeakValue::getNextLevel", getSampleTypeName<SampleType>(), 1, 0 }, [&] {
+        peakValue.updateLevel (static_cast<SampleType> (levels[i++ % levels.size()]));
+        doNotOptimise (peakValue.getNextLevel());
+    });
+}
+} // namespace
+
+void runMeteringBenchmarks (BenchmarkRunner& runner)
+{
+    benchmarkMeasureBlock<float> (runner, false);
+    benchmarkMeasureBlock<double> (runner, false);
+    benchmarkMeasureBlock<float> (runner, true);
+
+    benchmarkRegistryTick (runner, LevelMeter::DispatchMode::everyMeasurement);
+    benchmarkRegistryTick (runner, LevelMeter::DispatchMode::peakPerTick);
+    benchmarkRegistryTick (runner, LevelMeter::DispatchMode::changedChannels);
+
+    auto const levels = createLevels();
+
+    auto const& scale = LevelMeter::Scale::getDefaultScale();
+    size_t i = 0;
+
+    runner.run ({ "metering", "Scale::calculateProportionForLevel", "double", 1, 0 }, [&] {
+        doNotOptimise (scale.calculateProportionForLevel (levels[i++ % levels.size()]));
+    });
+
+    benchmarkLevelPeakValue<float> (runner, levels);
+    benchmarkLevelPeakValue<double> (runner, levels);
+}
@@ -0,0 +1,78 @@
+#include "AudioTap.h"
+#include "juce-extensions/audio/conversion/ChannelConversion.h"
+
+AudioTap::AudioTap (int const capacity) :
+    mFifo (std::max (1, capacity)),
+    mBuffer (static_cast<size_t> (mFifo.getTotalSize()), 0.0f)
+{
+}
+
+void AudioTap::setActive (bool const shouldBeActive)
+{
+    mIsActive.store (shouldBeActive, std::memory_order_release);
+}
+
+bool AudioTap::isActive() const
+{
+    return mIsActive.load (std::memory_order_acquire);
+}
+
+template <typename SampleType>
+void AudioTap::push (const SampleType* const* channelData, int const numChannels, int const numSamples)
+{
+    if (!isActive() || numChannels <= 0 || numSamples <= 0)
+        return;
+
+    int start1, size1, start2, size2;
+    mFifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+    if (auto const numDropped = numSamples - (size1 + size2); numDropped > 0)
+        mNumDroppedSamples.fetch_add (static_cast<uint32_t> (numDropped), std::memory_order_relaxed);
+
+    auto const gain = 1.0f / static_cast<float> (numChannels);
+
+    auto writeRegion = [&] (int start, int size, int offset) {
+        if (size <= 0)
+            return;
+
+        auto* dest = mBuffer.data() + start;
+        juce::FloatVectorOperations::clear (dest, size);
+
+        for (int ch = 0; ch < numChannels; ch++)
+            addConvertedSamples (dest, channelData[ch] + offset, size, gain);
+    };
+
+    writeRegion (start1, size1, 0);
+    writeRegion (start2, size2, size1);
+
+    mFifo.finishedWrite (size1 + size2);
+}
+
+// Trigger symbol generation.
+template void AudioTap::push (const float* const* channelData, int numChannels, int numSamples);
+template void AudioTap::push (const double* const* channelData, int numChannels, int numSamples);
+
+int AudioTap::read (float* dest, int const numSamples)
+{
+    int start1, size1, start2, size2;
+    mFifo.prepareToRead (numSamples, start1, size1, start2, size2);
+
+    if (size1 > 0)
+        juce::FloatVectorOperations::copy (dest, mBuffer.data() + start1, size1);
+
+    if (size2 > 0)
+        juce::FloatVectorOperations::copy (dest + size1, mBuffer.data() + start2, size2);
+
+    mFifo.finishedRead (size1 + size2);
+    return size1 + size2;
+}
+
+int AudioTap::getNumReady() const
+{
+    return mFifo.getNumReady();
+}
+
+uint32_t AudioTap::getNumDroppedSamples() const
+{
+    return mNumDroppedSamples.load (std::memory_order_relaxed);
+}
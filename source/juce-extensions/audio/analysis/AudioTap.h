@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+
+/**
+ * Lock-free single producer, single consumer tap which carries a mono sum of the audio from the audio thread to a
+ * consumer on another thread. All storage is allocated up front, pushing is realtime safe.
+ * Samples which don't fit in the tap are dropped (and counted), the tap never blocks the audio thread.
+ */
+class AudioTap
+{
+public:
+    static constexpr int kDefaultCapacity = 1 << 15;
+
+    /**
+     * Constructor.
+     * @param capacity The number of samples the tap can hold.
+     */
+    explicit AudioTap (int capacity = kDefaultCapacity);
+
+    JUCE_DECLARE_NON_COPYABLE (AudioTap)
+    JUCE_DECLARE_NON_MOVEABLE (AudioTap)
+
+    /**
+     * Sets whether the tap is active. While not active, push() returns immediately.
+     * @param shouldBeActive True to activate the tap.
+     */
+    void setActive (bool shouldBeActive);
+
+    /**
+     * @return True if the tap is active.
+     */
+    [[nodiscard]] bool isActive() const;
+
+    /**
+     * Sums given channels to mono and pushes the result into the tap. Only to be called from a single (audio) thread.
+     * @tparam SampleType The type of the audio sample.
+     * @param channelData The audio data.
+     * @param numChannels The number of channels.
+     * @param numSamples The number of samples.
+     */
+    template <typename SampleType>
+    void push (const SampleType* const* channelData, int numChannels, int numSamples);
+
+    /**
+     * Reads samples from the tap. Only to be called from a single (consumer) thread.
+     * @param dest The destination.
+     * @param numSamples The max number of samples to read.
+     * @return The number of samples read.
+     */
+    int read (float* dest, int numSamples);
+
+    /**
+     * @return The number of samples ready to be read.
+     */
+    [[nodiscard]] int getNumReady() const;
+
+    /**
+     * @return The number of samples which got dropped because the tap was full.
+     */
+    [[nodiscard]] uint32_t getNumDroppedSamples() const;
+
+private:
+    juce::AbstractFifo mFifo;
+    std::vector<float> mBuffer;
+    std::atomic<bool> mIsActive { false };
+    std::atomic<uint32_t> mNumDroppedSamples { 0 };
+};
@@ -0,0 +1,97 @@
+#include "LevelHistogram.h"
+
+#include <cmath>
+
+LevelHistogram::LevelHistogram (double const minimumDb, double const maximumDb, double const binWidthDb) :
+    mMinimumDb (minimumDb),
+    mBinWidthDb (std::max (binWidthDb, 0.001)),
+    mCounts (static_cast<size_t> (std::max (1.0, std::ceil ((maximumDb - minimumDb) / mBinWidthDb))), 0)
+{
+}
+
+void LevelHistogram::addLevel (double const level)
+{
+    if (!std::isfinite (level))
+        return;
+
+    // Silence ends up in the first bin.
+    addLevelDb (level > 0.0 ? 20.0 * std::log10 (level) : mMinimumDb);
+}
+
+void LevelHistogram::addLevelDb (double const levelDb, uint64_t const count)
+{
+    // A NaN would make the bin index undefined.
+    if (!std::isfinite (levelDb))
+        return;
+
+    auto const bin = std::floor ((levelDb - mMinimumDb) / mBinWidthDb);
+    auto const lastBin = static_cast<double> (mCounts.size() - 1);
+
+    mCounts[static_cast<size_t> (juce::jlimit (0.0, lastBin, bin))] += count;
+    mTotalCount += count;
+}
+
+void LevelHistogram::merge (const LevelHistogram& other)
+{
+    if (!hasSameLayout (other))
+    {
+        jassertfalse; // Histograms with a different layout can't be merged.
+        return;
+    }
+
+    for (size_t i = 0; i < mCounts.size(); i++)
+        mCounts[i] += other.mCounts[i];
+
+    mTotalCount += other.mTotalCount;
+}
+
+void LevelHistogram::clear()
+{
+    std::fill (mCounts.begin(), mCounts.end(), 0);
+    mTotalCount = 0;
+}
+
+int LevelHistogram::getNumBins() const
+{
+    return static_cast<int> (mCounts.size());
+}
+
+uint64_t LevelHistogram::getCount (int const bin) const
+{
+    if (juce::isPositiveAndBelow (bin, getNumBins()))
+        return mCounts[static_cast<size_t> (bin)];
+    return 0;
+}
+
+uint64_t LevelHistogram::getTotalCount() const
+{
+    return mTotalCount;
+}
+
+double LevelHistogram::getBinLowerDb (int const bin) const
+{
+    return mMinimumDb + mBinWidthDb * bin;
+}
+
+double LevelHistogram::getPercentileDb (double const percentile) const
+{
+    if (mTotalCount == 0)
+        return mMinimumDb;
+
+    auto const target = juce::jlimit (0.0, 100.0, percentile) / 100.0 * static_cast<double> (mTotalCount);
+    uint64_t count = 0;
+
+    for (int bin = 0; bin < getNumBins(); bin++)
+    {
+        count += mCounts[static_cast<size_t> (bin)];
+        if (count > 0 && static_cast<double> (count) >= target)
+            return getBinLowerDb (bin + 1);
+    }
+
+    return getBinLowerDb (getNumBins());
+}
+
+bool LevelHistogram::hasSameLayout (const LevelHistogram& other) const
+{
+    return mMinimumDb == other.mMinimumDb && mBinWidthDb == other.mBinWidthDb && mCounts.size() == other.mCounts.size();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <juce_core/juce_core.h>
+#include <vector>
+
+/**
+ * Histogram of levels in decibels with fixed width bins. Adding a level is O(1) and histograms with the same layout
+ * can be merged by adding their counts, so a histogram of a long stretch of audio can be built from histograms of its
+ * parts (in any order, on any thread).
+ * Levels below the range are counted in the first bin, levels above it in the last bin.
+ */
+class LevelHistogram
+{
+public:
+    static constexpr double kDefaultMinimumDb = -100.0;
+    static constexpr double kDefaultMaximumDb = 6.0;
+    static constexpr double kDefaultBinWidthDb = 0.5;
+
+    /**
+     * Constructor.
+     * @param minimumDb The lower edge of the first bin.
+     * @param maximumDb The upper edge of the last bin.
+     * @param binWidthDb The width of every bin.
+     */
+    explicit LevelHistogram (
+        double minimumDb = kDefaultMinimumDb,
+        double maximumDb = kDefaultMaximumDb,
+        double binWidthDb = kDefaultBinWidthDb);
+
+    /**
+     * Adds a level. Non-finite levels (NaN or infinity) are ignored.
+     * @param level The level as gain.
+     */
+    void addLevel (double level);
+
+    /**
+     * Adds a level in decibels. Non-finite levels (NaN or infinity) are ignored, they have no bin.
+     * @param levelDb The level in decibels.
+     * @param count The number of times to add the level.
+     */
+    void addLevelDb (double levelDb, uint64_t count = 1);
+
+    /**
+     * Adds the counts of another histogram to this one. Both histograms must have the same layout.
+     * @param other The histogram to merge into this one.
+     */
+    void merge (const LevelHistogram& other);
+
+    /**
+     * Resets all counts to zero.
+     */
+    void clear();
+
+    /**
+     * @return The number of bins.
+     */
+    [[nodiscard]] int getNumBins() const;
+
+    /**
+     * @param bin The index of the bin.
+     * @return The number of levels counted in given bin.
+     */
+    [[nodiscard]] uint64_t getCount (int bin) const;
+
+    /**
+     * @return The number of levels counted in all bins.
+     */
+    [[nodiscard]] uint64_t getTotalCount() const;
+
+    /**
+     * @param bin The index of the bin.
+     * @return The lower edge of given bin in decibels.
+     */
+    [[nodiscard]] double getBinLowerDb (int bin) const;
+
+    /**
+     * Finds the level below which given percentage of the counted levels falls.
+     * @param percentile The percentile [0, 100].
+     * @return The upper edge of the bin which contains the percentile, or the minimum if the histogram is empty.
+     */
+    [[nodiscard]] double getPercentileDb (double percentile) const;
+
+    /**
+     * @return True if both histograms have the same range and bin width, which is required for merging.
+     */
+    [[nodiscard]] bool hasSameLayout (const LevelHistogram& other) const;
+
+private:
+    double mMinimumDb = kDefaultMinimumDb;
+    double mBinWidthDb = kDefaultBinWidthDb;
+    std::vector<uint64_t> mCounts;
+    uint64_t mTotalCount = 0;
+};
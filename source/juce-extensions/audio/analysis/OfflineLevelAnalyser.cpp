@@ -0,0 +1,355 @@
+#include "OfflineLevelAnalyser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+double getSumOfSquares (const float* const samples, int const numSamples)
+{
+    // Independent accumulators, so the additions don't all wait on each other.
+    double sums[4] {};
+    int i = 0;
+
+    for (; i + 4 <= numSamples; i += 4)
+        for (int j = 0; j < 4; j++)
+            sums[j] += static_cast<double> (samples[i + j]) * samples[i + j];
+
+    for (; i < numSamples; i++)
+        sums[0] += static_cast<double> (samples[i]) * samples[i];
+
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+} // namespace
+
+/**
+ * State shared by all analysis jobs.
+ */
+struct OfflineLevelAnalyser::AnalysisContext
+{
+    Options options;
+    int numChannels = 0;
+    int64_t lengthInSamples = 0;
+    int windowLength = 1;
+    int64_t chunkLength = 1;
+    int64_t numChunks = 0;
+
+    /// The statistics per chunk, each written by the job which analysed the chunk.
+    std::vector<std::vector<ChannelStatistics>> chunkStatistics;
+
+    std::atomic<int64_t> nextChunk { 0 };
+    std::atomic<bool> failed { false };
+};
+
+class OfflineLevelAnalyser::AnalysisJob : public juce::ThreadPoolJob
+{
+public:
+    AnalysisJob (std::unique_ptr<juce::AudioFormatReader> reader, AnalysisContext& context) :
+        juce::ThreadPoolJob ("Offline level analysis"),
+        mReader (std::move (reader)),
+        mContext (context),
+        mBuffer (context.numChannels, std::max (1, context.options.readBlockLength))
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        for (auto chunk = mContext.nextChunk++; chunk < mContext.numChunks; chunk = mContext.nextChunk++)
+        {
+            if (shouldExit() || mContext.failed)
+                break;
+
+            if (!analyseChunk (chunk))
+                mContext.failed = true;
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    std::unique_ptr<juce::AudioFormatReader> mReader;
+    AnalysisContext& mContext;
+    juce::AudioBuffer<float> mBuffer;
+
+    bool analyseChunk (int64_t const chunk)
+    {
+        auto const& options = mContext.options;
+        auto const start = chunk * mContext.chunkLength;
+        auto const end = std::min (mContext.lengthInSamples, start + mContext.chunkLength);
+
+        auto& statistics = mContext.chunkStatistics[static_cast<size_t> (chunk)];
+        statistics.resize (static_cast<size_t> (mContext.numChannels));
+
+        // Chunks start at a window boundary, so windows never cross chunks.
+        std::vector<double> windowSums (statistics.size(), 0.0);
+        int windowFill = 0;
+
+        for (auto position = start; position < end;)
+        {
+            auto const numSamples = static_cast<int> (std::min<int64_t> (mBuffer.getNumSamples(), end - position));
+            if (!mReader->read (mBuffer.getArrayOfWritePointers(), mContext.numChannels, position, numSamples))
+                return false;
+
+            int windowFillAfterBlock = windowFill;
+
+            for (int ch = 0; ch < mContext.numChannels; ch++)
+            {
+                auto& channel = statistics[static_cast<size_t> (ch)];
+                auto& windowSum = windowSums[static_cast<size_t> (ch)];
+                auto const* samples = mBuffer.getReadPointer (ch);
+                windowFillAfterBlock = windowFill;
+
+                for (int offset = 0; offset < numSamples;)
+                {
+                    auto const segmentLength =
+                        std::min (numSamples - offset, mContext.windowLength - windowFillAfterBlock);
+                    auto const* segment = samples + offset;
+
+                    auto const range = juce::FloatVectorOperations::findMinAndMax (segment, segmentLength);
+                    auto const peak = std::max (-range.getStart(), range.getEnd());
+                    auto const sumOfSquares = getSumOfSquares (segment, segmentLength);
+
+                    channel.peakLevel = std::max (channel.peakLevel, static_cast<double> (peak));
+                    channel.sumOfSquares += sumOfSquares;
+                    windowSum += sumOfSquares;
+
+                    // Only segments which reach the clip level need to be scanned sample by sample.
+                    if (peak >= options.clipLevel)
+                    {
+                        channel.numClippedSamples += std::count_if (segment, segment + segmentLength, [&] (float s) {
+                            return std::abs (s) >= options.clipLevel;
+                        });
+                        channel.clipRuns.append (
+                            ClipRuns::scan (segment, segmentLength, options.clipLevel, channel.minClipRunLength),
+                            channel.minClipRunLength);
+                    }
+                    else
+                    {
+                        channel.clipRuns.append ({ segmentLength, 0, 0, 0 }, channel.minClipRunLength);
+                    }
+
+                    windowFillAfterBlock += segmentLength;
+                    if (windowFillAfterBlock == mContext.windowLength)
+                    {
+                        channel.rmsHistogram.addLevel (std::sqrt (windowSum / mContext.windowLength));
+                        windowSum = 0.0;
+                        windowFillAfterBlock = 0;
+                    }
+
+                    offset += segmentLength;
+                }
+            }
+
+            windowFill = windowFillAfterBlock;
+            position += numSamples;
+        }
+
+        // Only the last chunk can end with a partial window.
+        if (windowFill > 0)
+            for (size_t ch = 0; ch < statistics.size(); ch++)
+                statistics[ch].rmsHistogram.addLevel (std::sqrt (windowSums[ch] / windowFill));
+
+        return true;
+    }
+};
+
+OfflineLevelAnalyser::Options OfflineLevelAnalyser::Options::getDefault()
+{
+    return {};
+}
+
+void OfflineLevelAnalyser::ClipRuns::append (const ClipRuns& following, int const minRunLength)
+{
+    if (following.numSamples == 0)
+        return;
+
+    if (numSamples == 0)
+    {
+        *this = following;
+        return;
+    }
+
+    auto const isAllClipped = leadingRun == numSamples;
+    auto const isFollowingAllClipped = following.leadingRun == following.numSamples;
+
+    if (isAllClipped && isFollowingAllClipped)
+    {
+        leadingRun = trailingRun = numSamples + following.numSamples;
+    }
+    else if (isAllClipped)
+    {
+        leadingRun = numSamples + following.leadingRun;
+        trailingRun = following.trailingRun;
+        numInteriorEvents = following.numInteriorEvents;
+    }
+    else if (isFollowingAllClipped)
+    {
+        trailingRun += following.numSamples;
+    }
+    else
+    {
+        // The run crossing the boundary is interior now.
+        if (trailingRun + following.leadingRun >= std::max (1, minRunLength))
+            numInteriorEvents++;
+
+        numInteriorEvents += following.numInteriorEvents;
+        trailingRun = following.trailingRun;
+    }
+
+    numSamples += following.numSamples;
+}
+
+int64_t OfflineLevelAnalyser::ClipRuns::getNumEvents (int const minRunLength) const
+{
+    auto const isEvent = [minRunLength] (int64_t const runLength) {
+        return runLength > 0 && runLength >= minRunLength;
+    };
+
+    if (numSamples > 0 && leadingRun == numSamples)
+        return isEvent (leadingRun) ? 1 : 0;
+
+    return numInteriorEvents + (isEvent (leadingRun) ? 1 : 0) + (isEvent (trailingRun) ? 1 : 0);
+}
+
+OfflineLevelAnalyser::ClipRuns OfflineLevelAnalyser::ClipRuns::scan (
+    const float* const samples,
+    int const numSamples,
+    float const clipLevel,
+    int const minRunLength)
+{
+    ClipRuns runs { numSamples, 0, 0, 0 };
+    int64_t runLength = 0;
+    bool isAtStart = true;
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        if (std::abs (samples[i]) >= clipLevel)
+        {
+            runLength++;
+            continue;
+        }
+
+        if (isAtStart)
+            runs.leadingRun = runLength;
+        else if (runLength > 0 && runLength >= minRunLength)
+            runs.numInteriorEvents++;
+
+        isAtStart = false;
+        runLength = 0;
+    }
+
+    if (isAtStart)
+        runs.leadingRun = runLength;
+    runs.trailingRun = runLength;
+
+    return runs;
+}
+
+double OfflineLevelAnalyser::ChannelStatistics::getRmsLevel() const
+{
+    if (clipRuns.numSamples == 0)
+        return 0.0;
+    return std::sqrt (sumOfSquares / static_cast<double> (clipRuns.numSamples));
+}
+
+int64_t OfflineLevelAnalyser::ChannelStatistics::getNumClipEvents() const
+{
+    return clipRuns.getNumEvents (minClipRunLength);
+}
+
+void OfflineLevelAnalyser::ChannelStatistics::merge (const ChannelStatistics& following)
+{
+    peakLevel = std::max (peakLevel, following.peakLevel);
+    sumOfSquares += following.sumOfSquares;
+    numClippedSamples += following.numClippedSamples;
+    clipRuns.append (following.clipRuns, minClipRunLength);
+    rmsHistogram.merge (following.rmsHistogram);
+}
+
+std::optional<OfflineLevelAnalyser::Report> OfflineLevelAnalyser::analyse (
+    const ReaderFactory& createReader,
+    const Options& options)
+{
+    auto reader = createReader();
+    if (reader == nullptr || reader->numChannels == 0 || reader->sampleRate <= 0.0)
+        return {};
+
+    auto const sampleRate = reader->sampleRate;
+
+    AnalysisContext context;
+    context.options = options;
+    context.numChannels = static_cast<int> (reader->numChannels);
+    context.lengthInSamples = reader->lengthInSamples;
+    context.windowLength = std::max (1, juce::roundToInt (sampleRate * options.histogramWindowSeconds));
+    context.chunkLength = std::max<int64_t> (1, options.chunkLength / context.windowLength) * context.windowLength;
+    context.numChunks = (context.lengthInSamples + context.chunkLength - 1) / context.chunkLength;
+    context.chunkStatistics.resize (static_cast<size_t> (context.numChunks));
+
+    ChannelStatistics emptyStatistics;
+    emptyStatistics.minClipRunLength = std::max (1, options.minClipRunLength);
+
+    for (auto& statistics : context.chunkStatistics)
+        statistics.assign (static_cast<size_t> (context.numChannels), emptyStatistics);
+
+    auto const numThreads = static_cast<int> (std::clamp<int64_t> (
+        options.numThreads > 0 ? options.numThreads : juce::SystemStats::getNumCpus(),
+        1,
+        std::max<int64_t> (1, context.numChunks)));
+
+    // Readers aren't thread safe, so every job gets its own. If creating more readers fails, fewer threads are used.
+    std::vector<std::unique_ptr<AnalysisJob>> jobs;
+    jobs.push_back (std::make_unique<AnalysisJob> (std::move (reader), context));
+
+    while (static_cast<int> (jobs.size()) < numThreads)
+    {
+        auto jobReader = createReader();
+        if (jobReader == nullptr)
+            break;
+        jobs.push_back (std::make_unique<AnalysisJob> (std::move (jobReader), context));
+    }
+
+    {
+        juce::ThreadPool pool (static_cast<int> (jobs.size()));
+
+        for (auto& job : jobs)
+            pool.addJob (job.get(), false);
+
+        for (auto& job : jobs)
+            pool.waitForJobToFinish (job.get(), -1);
+    }
+
+    if (context.failed)
+        return {};
+
+    Report report;
+    report.sampleRate = sampleRate;
+    report.lengthInSamples = context.lengthInSamples;
+    report.channels.assign (static_cast<size_t> (context.numChannels), emptyStatistics);
+
+    // Chunks have to be merged in order for the clip runs crossing chunk boundaries to be counted.
+    for (auto const& statistics : context.chunkStatistics)
+        for (size_t ch = 0; ch < statistics.size(); ch++)
+            report.channels[ch].merge (statistics[ch]);
+
+    return report;
+}
+
+std::optional<OfflineLevelAnalyser::Report> OfflineLevelAnalyser::analyseFile (
+    const juce::File& file,
+    juce::AudioFormatManager& formatManager,
+    const Options& options)
+{
+    return analyse (
+        [&file, &formatManager]() -> std::unique_ptr<juce::AudioFormatReader> {
+            // Mapped files are read straight from the page cache by every thread, without buffering per reader.
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader {
+                juce::WavAudioFormat().createMemoryMappedReader (file)
+            };
+            if (mappedReader != nullptr && mappedReader->mapEntireFile())
+                return mappedReader;
+
+            return std::unique_ptr<juce::AudioFormatReader> (formatManager.createReaderFor (file));
+        },
+        options);
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "LevelHistogram.h"
+
+#include <functional>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <memory>
+#include <optional>
+#include <vector>
+
+/**
+ * Analyses the levels of audio files (or anything else an AudioFormatReader can read) as fast as possible, for batch
+ * quality control. The audio is split into chunks which are analysed on a thread pool, after which the statistics
+ * of all chunks are merged into a single report per channel. Every thread reads its chunks in small blocks through a
+ * reader of its own, so memory usage doesn't depend on the length of the audio.
+ */
+class OfflineLevelAnalyser
+{
+public:
+    /**
+     * Options to configure the analysis.
+     */
+    struct Options
+    {
+        /// The number of samples per chunk, which gets rounded down to a whole number of histogram windows.
+        int64_t chunkLength = int64_t { 1 } << 20;
+
+        /// The number of samples per read, which determines the memory used by every thread.
+        int readBlockLength = 1 << 15;
+
+        /// The number of threads, or 0 for one thread per CPU.
+        int numThreads = 0;
+
+        /// Samples with an absolute value at or above this level count as clipped.
+        float clipLevel = 0.999f;
+
+        /// The minimum number of consecutive clipped samples which counts as a clip event.
+        int minClipRunLength = 3;
+
+        /// The length of the consecutive windows of which the RMS levels are collected in a histogram.
+        double histogramWindowSeconds = 0.4;
+
+        /**
+         * @returns The default options.
+         */
+        static Options getDefault();
+    };
+
+    /**
+     * Summary of the runs of clipped samples in a stretch of audio, which can be merged with the summary of the stretch
+     * following it to count runs crossing the boundary correctly.
+     */
+    struct ClipRuns
+    {
+        int64_t numSamples = 0;        ///< The number of samples summarised.
+        int64_t leadingRun = 0;        ///< The number of clipped samples at the start.
+        int64_t trailingRun = 0;       ///< The number of clipped samples at the end.
+        int64_t numInteriorEvents = 0; ///< The number of runs touching neither end which count as clip event.
+
+        /**
+         * Appends the summary of the audio directly following the audio of this summary.
+         * @param following The summary to append.
+         * @param minRunLength The minimum length of a run to count as clip event.
+         */
+        void append (const ClipRuns& following, int minRunLength);
+
+        /**
+         * @param minRunLength The minimum length of a run to count as clip event.
+         * @return The number of clip events.
+         */
+        [[nodiscard]] int64_t getNumEvents (int minRunLength) const;
+
+        /**
+         * Summarises given samples.
+         * @param samples The samples.
+         * @param numSamples The number of samples.
+         * @param clipLevel Samples with an absolute value at or above this level count as clipped.
+         * @param minRunLength The minimum length of a run to count as clip event.
+         */
+        static ClipRuns scan (const float* samples, int numSamples, float clipLevel, int minRunLength);
+    };
+
+    /**
+     * The statistics of a single channel.
+     */
+    struct ChannelStatistics
+    {
+        double peakLevel = 0.0;        ///< The highest absolute sample value.
+        double sumOfSquares = 0.0;     ///< The sum of all squared sample values.
+        int64_t numClippedSamples = 0; ///< The number of samples at or above the clip level.
+        ClipRuns clipRuns;             ///< The runs of clipped samples.
+        int minClipRunLength = 1;      ///< The minimum length of a run to count as clip event.
+
+        /// The RMS levels of consecutive windows (see Options::histogramWindowSeconds).
+        LevelHistogram rmsHistogram;
+
+        /**
+         * @return The RMS level of the whole channel.
+         */
+        [[nodiscard]] double getRmsLevel() const;
+
+        /**
+         * @return The number of runs of clipped samples which are at least minClipRunLength long.
+         */
+        [[nodiscard]] int64_t getNumClipEvents() const;
+
+        /**
+         * Merges the statistics of the audio directly following the audio of these statistics. Merging is
+         * associative, so chunks can be merged in any grouping as long as their order is kept.
+         * @param following The statistics to merge.
+         */
+        void merge (const ChannelStatistics& following);
+    };
+
+    /**
+     * The result of the analysis.
+     */
+    struct Report
+    {
+        double sampleRate = 0.0;
+        int64_t lengthInSamples = 0;
+        std::vector<ChannelStatistics> channels;
+    };
+
+    /// Creates a reader for the audio to analyse.
+    using ReaderFactory = std::function<std::unique_ptr<juce::AudioFormatReader>()>;
+
+    /**
+     * Analyses the audio of given reader factory. Creates a reader per thread, all from the calling thread.
+     * @param createReader Creates a reader for the audio to analyse. All readers must read the same audio.
+     * @param options The options for the analysis.
+     * @return The report, or nothing if a reader couldn't be created or reading failed.
+     */
+    static std::optional<Report> analyse (
+        const ReaderFactory& createReader,
+        const Options& options = Options::getDefault());
+
+    /**
+     * Analyses an audio file. WAV files get memory-mapped, other formats are read through the format manager. Both
+     * only keep the block being read in memory, so files can be larger than the available memory.
+     * @param file The file to analyse.
+     * @param formatManager The format manager to create readers with, for files which are not WAV files.
+     * @param options The options for the analysis.
+     * @return The report, or nothing if the file couldn't be read.
+     */
+    static std::optional<Report> analyseFile (
+        const juce::File& file,
+        juce::AudioFormatManager& formatManager,
+        const Options& options = Options::getDefault());
+
+private:
+    struct AnalysisContext;
+    class AnalysisJob;
+};
@@ -0,0 +1,126 @@
+#include "SpectrumAnalyser.h"
+#include "juce-extensions/audio/metering/LevelMeter.h"
+
+SpectrumAnalyser::Options SpectrumAnalyser::Options::getDefault()
+{
+    return {};
+}
+
+SpectrumAnalyser::SpectrumAnalyser (LevelMeter& levelMeter, const Options& options) :
+    Thread ("SpectrumAnalyser"),
+    mOptions (options),
+    mAudioTap (levelMeter.getAudioTap()),
+    mFftSize (1 << juce::jlimit (4, 16, options.fftOrder)),
+    mHopSize (std::max (1, mFftSize / std::max (1, options.overlap))),
+    mPollIntervalMs (juce::jlimit (
+        1,
+        kMaxPollIntervalMs,
+        static_cast<int> (1000.0 * mHopSize / options.sampleRate / 2.0))),
+    mFft (juce::jlimit (4, 16, options.fftOrder)),
+    mWindow (static_cast<size_t> (mFftSize), juce::dsp::WindowingFunction<float>::hann),
+    mInput (static_cast<size_t> (mFftSize), 0.0f),
+    mFftData (static_cast<size_t> (mFftSize * 2), 0.0f),
+    mBandLevels (static_cast<size_t> (std::max (1, options.numBands)))
+{
+    jassert (mOptions.minFrequency > 0.0 && mOptions.minFrequency < mOptions.maxFrequency);
+
+    auto const numBands = static_cast<int> (mBandLevels.size());
+    auto const numBins = mFftSize / 2 + 1;
+    auto const binsPerHz = mFftSize / mOptions.sampleRate;
+    auto const ratio = mOptions.maxFrequency / mOptions.minFrequency;
+
+    for (int band = 0; band < numBands; band++)
+    {
+        auto const lowFrequency = mOptions.minFrequency * std::pow (ratio, band / static_cast<double> (numBands));
+        auto const highFrequency = lowFrequency * std::pow (ratio, 1.0 / static_cast<double> (numBands));
+
+        auto const firstBin = static_cast<int> (std::floor (lowFrequency * binsPerHz));
+        auto const endBin = static_cast<int> (std::ceil (highFrequency * binsPerHz));
+
+        // Every band covers at least one bin.
+        auto const clampedFirstBin = juce::jlimit (0, numBins - 1, firstBin);
+        mBandBins.emplace_back (clampedFirstBin, juce::jlimit (clampedFirstBin + 1, numBins, endBin));
+    }
+
+    for (auto& level : mBandLevels)
+    {
+        level.setMinusInfinityDb (LevelMeterConstants::kDefaultMinusInfinityDb);
+        level.setReturnRate (mOptions.returnRateDbPerSecond);
+    }
+
+    mSpectrum.prepare ({ std::vector<float> (mBandLevels.size(), 0.0f) });
+
+    mAudioTap.setActive (true);
+    startThread();
+}
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    mAudioTap.setActive (false);
+    stopThread (1000);
+}
+
+bool SpectrumAnalyser::updateSpectrum()
+{
+    return mSpectrum.update();
+}
+
+const SpectrumAnalyser::Spectrum& SpectrumAnalyser::getSpectrum() const
+{
+    return mSpectrum.getReadBuffer();
+}
+
+double SpectrumAnalyser::getBandCentreFrequency (int const bandIndex) const
+{
+    auto const ratio = mOptions.maxFrequency / mOptions.minFrequency;
+    return mOptions.minFrequency * std::pow (ratio, (bandIndex + 0.5) / static_cast<double> (mBandLevels.size()));
+}
+
+const SpectrumAnalyser::Options& SpectrumAnalyser::getOptions() const
+{
+    return mOptions;
+}
+
+void SpectrumAnalyser::analyseFrame()
+{
+    std::copy (mInput.begin(), mInput.end(), mFftData.begin());
+    std::fill (mFftData.begin() + mFftSize, mFftData.end(), 0.0f);
+
+    mWindow.multiplyWithWindowingTable (mFftData.data(), static_cast<size_t> (mFftSize));
+    mFft.performFrequencyOnlyForwardTransform (mFftData.data());
+
+    // Scale so that a full scale sine results in a magnitude of 1.0.
+    auto const scale = 2.0f / static_cast<float> (mFftSize);
+
+    for (size_t band = 0; band < mBandBins.size(); band++)
+    {
+        auto [firstBin, endBin] = mBandBins[band];
+        auto const peak = *std::max_element (mFftData.begin() + firstBin, mFftData.begin() + endBin);
+        mBandLevels[band].updateLevel (peak * scale);
+    }
+}
+
+void SpectrumAnalyser::run()
+{
+    while (!threadShouldExit())
+    {
+        while (mAudioTap.getNumReady() >= mHopSize)
+        {
+            // Shift the input by one hop and append the new samples.
+            std::copy (mInput.begin() + mHopSize, mInput.end(), mInput.begin());
+            mAudioTap.read (mInput.data() + mFftSize - mHopSize, mHopSize);
+
+            analyseFrame();
+        }
+
+        // Publish even without new frames, so the levels keep returning when the audio stops.
+        auto& bandLevels = mSpectrum.getWriteBuffer().bandLevels;
+
+        for (size_t band = 0; band < mBandLevels.size(); band++)
+            bandLevels[band] = static_cast<float> (mBandLevels[band].getNextLevel());
+
+        mSpectrum.publish();
+
+        wait (mPollIntervalMs);
+    }
+}
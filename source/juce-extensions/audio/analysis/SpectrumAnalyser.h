@@ -0,0 +1,128 @@
+#pragma once
+
+#include "AudioTap.h"
+#include "juce-extensions/audio/metering/LevelPeakValue.h"
+#include "juce-extensions/core/TripleBuffer.h"
+
+#include <juce_dsp/juce_dsp.h>
+
+class LevelMeter;
+
+/**
+ * Windowed FFT spectrum analyser which reads audio from the AudioTap of a LevelMeter and does all its work on a
+ * dedicated background thread. The band levels are smoothed with the same ballistics as the level meter
+ * (LevelPeakValue) and are handed to the UI as a finished snapshot, so reading the spectrum never waits for the
+ * analysis.
+ * Only one analyser can be attached to a level meter at a time.
+ */
+class SpectrumAnalyser : private juce::Thread
+{
+public:
+    /**
+     * Options to configure the analysis.
+     */
+    struct Options
+    {
+        /// The FFT size as a power of 2.
+        int fftOrder = 11;
+
+        /// The number of FFT frames overlapping each sample (1 means no overlap).
+        int overlap = 4;
+
+        /// The number of logarithmically spaced bands.
+        int numBands = 64;
+
+        /// The frequency of the lower edge of the first band.
+        double minFrequency = 20.0;
+
+        /// The frequency of the upper edge of the last band.
+        double maxFrequency = 20000.0;
+
+        /// The sample rate of the audio being analysed.
+        double sampleRate = 48000.0;
+
+        /// The return rate of the band levels in decibels per second.
+        double returnRateDbPerSecond = LevelMeterConstants::kDefaultReturnRate;
+
+        /**
+         * @returns The default options.
+         */
+        static Options getDefault();
+    };
+
+    /**
+     * The result of the analysis.
+     */
+    struct Spectrum
+    {
+        /// The level of each band as gain [0.0, 1.0].
+        std::vector<float> bandLevels;
+    };
+
+    /**
+     * Constructor. Starts the analysis thread and activates the audio tap of given level meter.
+     * @param levelMeter The level meter to get the audio from. Must outlive this analyser.
+     * @param options The options for the analysis.
+     */
+    explicit SpectrumAnalyser (LevelMeter& levelMeter, const Options& options = Options::getDefault());
+    ~SpectrumAnalyser() override;
+
+    JUCE_DECLARE_NON_COPYABLE (SpectrumAnalyser)
+    JUCE_DECLARE_NON_MOVEABLE (SpectrumAnalyser)
+
+    /**
+     * Picks up the most recent spectrum produced by the analysis thread. Only to be called from a single (UI) thread.
+     * @return True if a new spectrum was picked up since the previous call.
+     */
+    bool updateSpectrum();
+
+    /**
+     * @return The spectrum picked up by the last call to updateSpectrum().
+     */
+    [[nodiscard]] const Spectrum& getSpectrum() const;
+
+    /**
+     * @param bandIndex The index of the band.
+     * @return The centre frequency of given band.
+     */
+    [[nodiscard]] double getBandCentreFrequency (int bandIndex) const;
+
+    /**
+     * @return The options this analyser was created with.
+     */
+    [[nodiscard]] const Options& getOptions() const;
+
+private:
+    /// The max time the analysis thread waits before checking the tap for new audio.
+    static constexpr int kMaxPollIntervalMs = 10;
+
+    Options mOptions;
+    AudioTap& mAudioTap;
+    int mFftSize;
+    int mHopSize;
+    int mPollIntervalMs;
+    juce::dsp::FFT mFft;
+    juce::dsp::WindowingFunction<float> mWindow;
+
+    /// The most recent fftSize samples.
+    std::vector<float> mInput;
+
+    /// Working space for the FFT, twice the FFT size.
+    std::vector<float> mFftData;
+
+    /// The first bin and the end bin (exclusive) for each band.
+    std::vector<std::pair<int, int>> mBandBins;
+
+    /// The smoothed level for each band.
+    std::vector<LevelPeakValue<double>> mBandLevels;
+
+    TripleBuffer<Spectrum> mSpectrum;
+
+    /**
+     * Analyses the current input and feeds the result into the band levels.
+     */
+    void analyseFrame();
+
+    // MARK: juce::Thread overrides -
+    void run() override;
+};
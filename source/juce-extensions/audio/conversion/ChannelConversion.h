@@ -1,55 +1,283 @@
 #pragma once
 
 #include <juce_audio_basics/juce_audio_basics.h>
+#include <limits>
+#include <type_traits>
 
 /**
- * Converts and adds channels from src to dst.
- * @tparam SampleType The type of the samples (float or double)
- * @param src The source channels.
- * @param dst The destination channels.
- * @return True if all input channels were converted to one or more output channels, or false if at least one input
- * channel got lost.
+ * Calls given function for every input channel which gets routed to given output channel when converting from
+ * numInputChannels to numOutputChannels. This defines the conversion rules used by addConvertChannels() and allows
+ * other code (like the level meter) to apply the exact same rules without going through a buffer.
+ * @tparam Function The type of function. Signature: void (int inputChannel, float gain).
+ * @param numInputChannels The number of input channels.
+ * @param numOutputChannels The number of output channels.
+ * @param outputChannel The output channel to find the sources for.
+ * @param fn The function to call for each source.
  */
-template <class SampleType>
-bool addConvertChannels (const juce::AudioBuffer<SampleType>& src, juce::AudioBuffer<SampleType>& dst)
+template <class Function>
+void forEachConversionSource (int numInputChannels, int numOutputChannels, int outputChannel, Function&& fn)
 {
     const float minus_3db = 1.0f / sqrtf (2.0f);
 
-    auto numInputChannels = src.getNumChannels();
-    auto numOutputChannels = dst.getNumChannels();
+    // Mono source to stereo destination: route the mono input channel to both left and right.
+    if (numInputChannels == 1 && numOutputChannels == 2)
+    {
+        fn (0, 1.0f);
+        return;
+    }
+
+    // Stereo source to mono destination: sum left and right and reduce gain by -3.01dB per channel.
+    if (numInputChannels == 2 && numOutputChannels == 1)
+    {
+        fn (0, minus_3db);
+        fn (1, minus_3db);
+        return;
+    }
 
+    // At this point we just pass the channels 1:1 for at most std::min(src, dst) channels.
+    if (outputChannel < numInputChannels)
+        fn (outputChannel, 1.0f);
+}
+
+/**
+ * @param numInputChannels The number of input channels.
+ * @param numOutputChannels The number of output channels.
+ * @return True if converting from numInputChannels to numOutputChannels routes every input channel to at least one
+ * output channel, or false if at least one input channel would get lost.
+ */
+inline bool isLosslessChannelConversion (int numInputChannels, int numOutputChannels)
+{
     if (numOutputChannels <= 0)
         return false; // With no output channels there is nothing we can do here.
 
-    // Mono source
-    if (numInputChannels == 1)
+    if (numInputChannels == 2 && numOutputChannels == 1)
+        return true;
+
+    return numInputChannels <= numOutputChannels;
+}
+
+/**
+ * @tparam SrcType The type of the source samples (float, double or a signed integer type like int16_t or int32_t).
+ * @tparam DstType The type of the destination samples (float or double).
+ * @return The factor which maps full scale of SrcType to [-1.0, 1.0], which is 1 for floating point sources.
+ */
+template <class SrcType, class DstType>
+constexpr DstType getFullScaleGain()
+{
+    if constexpr (std::is_integral_v<SrcType>)
+        return static_cast<DstType> (1.0 / (static_cast<double> (std::numeric_limits<SrcType>::max()) + 1.0));
+    else
+        return DstType (1);
+}
+
+/**
+ * Converts given samples to DstType, applies gain and adds the result to dst, in a single pass. Integer sources (PCM)
+ * get scaled so that full scale maps to [-1.0, 1.0].
+ * @tparam SrcType The type of the source samples (float, double or a signed integer type like int16_t or int32_t).
+ * @tparam DstType The type of the destination samples (float or double).
+ * @param dst The destination samples.
+ * @param src The source samples.
+ * @param numSamples The number of samples.
+ * @param gain The gain to apply.
+ */
+template <class SrcType, class DstType>
+void addConvertedSamples (DstType* dst, const SrcType* src, int numSamples, DstType gain)
+{
+    static_assert (std::is_floating_point_v<DstType>, "Destination samples must be float or double");
+    static_assert (std::is_floating_point_v<SrcType> || std::is_signed_v<SrcType>, "Unsupported source sample type");
+
+    if constexpr (std::is_same_v<SrcType, DstType>)
     {
-        // Stereo destination
-        if (numOutputChannels == 2)
-        {
-            // Route the mono input channel to both left and right.
-            dst.addFrom (0, 0, src, 0, 0, src.getNumSamples());
-            dst.addFrom (1, 0, src, 0, 0, src.getNumSamples());
-            return true;
-        }
+        if (gain == DstType (1))
+            juce::FloatVectorOperations::add (dst, src, numSamples);
+        else
+            juce::FloatVectorOperations::addWithMultiply (dst, src, gain, numSamples);
     }
-    // Stereo source
-    else if (numInputChannels == 2)
+    else
     {
-        // Mono destination
-        if (numOutputChannels == 1)
+        gain *= getFullScaleGain<SrcType, DstType>();
+
+        // Because src and dst are of different types they can't alias, which lets the compiler vectorise this loop.
+        for (int i = 0; i < numSamples; i++)
+            dst[i] += static_cast<DstType> (src[i]) * gain;
+    }
+}
+
+/**
+ * Converts and adds the channels from src which belong to a single output channel of dst.
+ * @tparam SrcType The type of the source samples (float, double or a signed integer type like int16_t or int32_t).
+ * @tparam DstType The type of the destination samples (float or double).
+ * @param src The source channels.
+ * @param numInputChannels The number of source channels.
+ * @param dst The destination channels.
+ * @param numOutputChannels The number of destination channels.
+ * @param outputChannel The channel of dst to add to.
+ * @param numSamples The number of samples to convert.
+ */
+template <class SrcType, class DstType>
+void addConvertChannel (
+    const SrcType* const* src,
+    int numInputChannels,
+    DstType* const* dst,
+    int numOutputChannels,
+    int outputChannel,
+    int numSamples)
+{
+    forEachConversionSource (numInputChannels, numOutputChannels, outputChannel, [&] (int inputChannel, float gain) {
+        addConvertedSamples (dst[outputChannel], src[inputChannel], numSamples, static_cast<DstType> (gain));
+    });
+}
+
+/**
+ * Converts and adds the channels from src which belong to a single output channel of dst.
+ * @tparam SrcType The type of the source samples (float or double)
+ * @tparam DstType The type of the destination samples (float or double)
+ * @param src The source channels.
+ * @param dst The destination channels.
+ * @param outputChannel The channel of dst to add to.
+ * @param numSamples The number of samples to convert.
+ */
+template <class SrcType, class DstType>
+void addConvertChannel (
+    const juce::AudioBuffer<SrcType>& src,
+    juce::AudioBuffer<DstType>& dst,
+    int outputChannel,
+    int numSamples)
+{
+    addConvertChannel (
+        src.getArrayOfReadPointers(),
+        src.getNumChannels(),
+        dst.getArrayOfWritePointers(),
+        dst.getNumChannels(),
+        outputChannel,
+        numSamples);
+}
+
+/**
+ * Converts and adds the channels from src which belong to a single output channel of dst, and finds the peak level of
+ * the resulting output channel in the same pass. This saves reading the output channel a second time when metering.
+ * @tparam SrcType The type of the source samples (float, double or a signed integer type like int16_t or int32_t).
+ * @tparam DstType The type of the destination samples (float or double).
+ * @param src The source channels.
+ * @param numInputChannels The number of source channels.
+ * @param dst The destination channels.
+ * @param numOutputChannels The number of destination channels.
+ * @param outputChannel The channel of dst to add to.
+ * @param numSamples The number of samples to convert.
+ * @return The highest absolute value of the first numSamples samples of the output channel, after adding.
+ */
+template <class SrcType, class DstType>
+DstType addConvertChannelAndFindPeak (
+    const SrcType* const* src,
+    int numInputChannels,
+    DstType* const* dst,
+    int numOutputChannels,
+    int outputChannel,
+    int numSamples)
+{
+    // No conversion routes more than two input channels to an output channel.
+    const SrcType* sources[2] {};
+    DstType gains[2] {};
+    int numSources = 0;
+
+    forEachConversionSource (numInputChannels, numOutputChannels, outputChannel, [&] (int inputChannel, float gain) {
+        jassert (numSources < 2);
+        sources[numSources] = src[inputChannel];
+        gains[numSources] = static_cast<DstType> (gain) * getFullScaleGain<SrcType, DstType>();
+        numSources++;
+    });
+
+    auto* output = dst[outputChannel];
+
+    // Accumulate the peak in independent lanes, which lets the compiler keep every lane in a SIMD register.
+    constexpr int kNumLanes = 8;
+    DstType lanePeaks[kNumLanes] {};
+
+    auto process = [&] (auto&& getInput) {
+        int i = 0;
+        for (; i + kNumLanes <= numSamples; i += kNumLanes)
         {
-            // Sum left and right and reduce gain by -3.01dB per channel.
-            dst.addFrom (0, 0, src, 0, 0, src.getNumSamples(), minus_3db);
-            dst.addFrom (0, 0, src, 1, 0, src.getNumSamples(), minus_3db);
-            return true;
+            for (int lane = 0; lane < kNumLanes; lane++)
+            {
+                auto const sample = output[i + lane] + getInput (i + lane);
+                output[i + lane] = sample;
+                lanePeaks[lane] = std::max (lanePeaks[lane], std::abs (sample));
+            }
         }
-    }
 
-    // At this point we just pass the channels 1:1 for at most std::min(src, dst) channels.
-    for (int ch = 0; ch < std::min (numInputChannels, numOutputChannels); ch++)
-        dst.addFrom (ch, 0, src, ch, 0, std::min (src.getNumSamples(), dst.getNumSamples()));
+        for (int lane = 0; i < numSamples; i++, lane++)
+        {
+            auto const sample = output[i] + getInput (i);
+            output[i] = sample;
+            lanePeaks[lane] = std::max (lanePeaks[lane], std::abs (sample));
+        }
+    };
+
+    if (numSources == 0)
+        process ([] (int) { return DstType {}; });
+    else if (numSources == 1)
+        process ([&] (int i) { return static_cast<DstType> (sources[0][i]) * gains[0]; });
+    else
+        process ([&] (int i) {
+            return static_cast<DstType> (sources[0][i]) * gains[0] + static_cast<DstType> (sources[1][i]) * gains[1];
+        });
+
+    DstType peak {};
+    for (auto const lanePeak : lanePeaks)
+        peak = std::max (peak, lanePeak);
+    return peak;
+}
+
+/**
+ * Converts and adds channels from src to dst. The sample types of src and dst don't have to match, the sample type
+ * conversion happens in the same pass as the channel conversion.
+ * @tparam SrcType The type of the source samples (float, double or a signed integer type like int16_t or int32_t).
+ * @tparam DstType The type of the destination samples (float or double).
+ * @param src The source channels.
+ * @param numInputChannels The number of source channels.
+ * @param dst The destination channels.
+ * @param numOutputChannels The number of destination channels.
+ * @param numSamples The number of samples to convert.
+ * @return True if all input channels were converted to one or more output channels, or false if at least one input
+ * channel got lost.
+ */
+template <class SrcType, class DstType>
+bool addConvertChannels (
+    const SrcType* const* src,
+    int numInputChannels,
+    DstType* const* dst,
+    int numOutputChannels,
+    int numSamples)
+{
+    if (numOutputChannels <= 0)
+        return false; // With no output channels there is nothing we can do here.
+
+    for (int ch = 0; ch < numOutputChannels; ch++)
+        addConvertChannel (src, numInputChannels, dst, numOutputChannels, ch, numSamples);
 
     // Return true if all input channels were added to the output buffer, otherwise return false.
-    return numInputChannels <= numOutputChannels;
+    return isLosslessChannelConversion (numInputChannels, numOutputChannels);
+}
+
+/**
+ * Converts and adds channels from src to dst.
+ * @tparam SrcType The type of the source samples (float or double)
+ * @tparam DstType The type of the destination samples (float or double)
+ * @param src The source channels.
+ * @param dst The destination channels.
+ * @return True if all input channels were converted to one or more output channels, or false if at least one input
+ * channel got lost.
+ */
+template <class SrcType, class DstType>
+bool addConvertChannels (const juce::AudioBuffer<SrcType>& src, juce::AudioBuffer<DstType>& dst)
+{
+    if (dst.getNumChannels() <= 0)
+        return false; // With no output channels there is nothing we can do here.
+
+    return addConvertChannels (
+        src.getArrayOfReadPointers(),
+        src.getNumChannels(),
+        dst.getArrayOfWritePointers(),
+        dst.getNumChannels(),
+        std::min (src.getNumSamples(), dst.getNumSamples()));
 }
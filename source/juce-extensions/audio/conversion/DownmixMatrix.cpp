@@ -0,0 +1,104 @@
+#include "DownmixMatrix.h"
+#include "ChannelConversion.h"
+
+DownmixMatrix::DownmixMatrix (int const numInputChannels, int const numOutputChannels) :
+    mNumInputChannels (std::max (0, numInputChannels)),
+    mNumOutputChannels (std::max (0, numOutputChannels)),
+    mGains (static_cast<size_t> (mNumInputChannels * mNumOutputChannels), 0.0f)
+{
+}
+
+DownmixMatrix DownmixMatrix::createForChannelConversion (int const numInputChannels, int const numOutputChannels)
+{
+    DownmixMatrix matrix (numInputChannels, numOutputChannels);
+
+    for (int out = 0; out < matrix.getNumOutputChannels(); out++)
+    {
+        forEachConversionSource (numInputChannels, numOutputChannels, out, [&] (int in, float gain) {
+            matrix.setGain (out, in, gain);
+        });
+    }
+
+    return matrix;
+}
+
+DownmixMatrix DownmixMatrix::createStereoFold (const juce::AudioChannelSet& inputLayout)
+{
+    const float minus_3db = 1.0f / sqrtf (2.0f);
+
+    DownmixMatrix matrix (inputLayout.size(), 2);
+
+    for (int in = 0; in < inputLayout.size(); in++)
+    {
+        switch (inputLayout.getTypeOfChannel (in))
+        {
+            case juce::AudioChannelSet::left:
+                matrix.setGain (0, in, 1.0f);
+                break;
+            case juce::AudioChannelSet::right:
+                matrix.setGain (1, in, 1.0f);
+                break;
+            case juce::AudioChannelSet::LFE:
+            case juce::AudioChannelSet::LFE2:
+                break; // LFE is not part of the fold.
+            case juce::AudioChannelSet::leftCentre:
+            case juce::AudioChannelSet::leftSurround:
+            case juce::AudioChannelSet::leftSurroundSide:
+            case juce::AudioChannelSet::leftSurroundRear:
+            case juce::AudioChannelSet::wideLeft:
+            case juce::AudioChannelSet::topFrontLeft:
+            case juce::AudioChannelSet::topSideLeft:
+            case juce::AudioChannelSet::topRearLeft:
+                matrix.setGain (0, in, minus_3db);
+                break;
+            case juce::AudioChannelSet::rightCentre:
+            case juce::AudioChannelSet::rightSurround:
+            case juce::AudioChannelSet::rightSurroundSide:
+            case juce::AudioChannelSet::rightSurroundRear:
+            case juce::AudioChannelSet::wideRight:
+            case juce::AudioChannelSet::topFrontRight:
+            case juce::AudioChannelSet::topSideRight:
+            case juce::AudioChannelSet::topRearRight:
+                matrix.setGain (1, in, minus_3db);
+                break;
+            default:
+                // Centre channels and channels without a known position end up in the middle.
+                matrix.setGain (0, in, minus_3db);
+                matrix.setGain (1, in, minus_3db);
+                break;
+        }
+    }
+
+    return matrix;
+}
+
+void DownmixMatrix::setGain (int const outputChannel, int const inputChannel, float const gain)
+{
+    if (!juce::isPositiveAndBelow (outputChannel, mNumOutputChannels) ||
+        !juce::isPositiveAndBelow (inputChannel, mNumInputChannels))
+    {
+        jassertfalse; // Route out of range.
+        return;
+    }
+
+    mGains[static_cast<size_t> (outputChannel * mNumInputChannels + inputChannel)] = gain;
+}
+
+float DownmixMatrix::getGain (int const outputChannel, int const inputChannel) const
+{
+    if (!juce::isPositiveAndBelow (outputChannel, mNumOutputChannels) ||
+        !juce::isPositiveAndBelow (inputChannel, mNumInputChannels))
+        return 0.0f;
+
+    return mGains[static_cast<size_t> (outputChannel * mNumInputChannels + inputChannel)];
+}
+
+int DownmixMatrix::getNumInputChannels() const
+{
+    return mNumInputChannels;
+}
+
+int DownmixMatrix::getNumOutputChannels() const
+{
+    return mNumOutputChannels;
+}
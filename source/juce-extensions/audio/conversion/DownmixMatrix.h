@@ -0,0 +1,68 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+
+/**
+ * Describes a (virtual) downmix as a matrix of gains from every input channel to every output channel.
+ * The matrix is meant to be created on a non-realtime thread and then be used read-only from the audio thread.
+ */
+class DownmixMatrix
+{
+public:
+    /**
+     * Constructor. All gains will be initialised to zero.
+     * @param numInputChannels The number of input channels.
+     * @param numOutputChannels The number of output channels.
+     */
+    DownmixMatrix (int numInputChannels, int numOutputChannels);
+
+    /**
+     * Creates a matrix which applies the same rules as addConvertChannels().
+     * @param numInputChannels The number of input channels.
+     * @param numOutputChannels The number of output channels.
+     * @return The created matrix.
+     */
+    static DownmixMatrix createForChannelConversion (int numInputChannels, int numOutputChannels);
+
+    /**
+     * Creates a matrix which folds given layout into stereo, following ITU-R BS.775. Left and right channels are added
+     * to their own side at unity gain, centre channels are added to both sides at -3dB, all other left or right
+     * channels (surrounds, rears, heights) are added to their own side at -3dB and LFE channels are dropped.
+     * @param inputLayout The layout of the input channels (e.g. 7.1.4).
+     * @return The created matrix.
+     */
+    static DownmixMatrix createStereoFold (const juce::AudioChannelSet& inputLayout);
+
+    /**
+     * Sets the gain for given route.
+     * @param outputChannel The output channel.
+     * @param inputChannel The input channel.
+     * @param gain The gain to apply.
+     */
+    void setGain (int outputChannel, int inputChannel, float gain);
+
+    /**
+     * @param outputChannel The output channel.
+     * @param inputChannel The input channel.
+     * @return The gain for given route, or zero if the route is out of range.
+     */
+    [[nodiscard]] float getGain (int outputChannel, int inputChannel) const;
+
+    /**
+     * @return The number of input channels.
+     */
+    [[nodiscard]] int getNumInputChannels() const;
+
+    /**
+     * @return The number of output channels.
+     */
+    [[nodiscard]] int getNumOutputChannels() const;
+
+private:
+    int mNumInputChannels = 0;
+    int mNumOutputChannels = 0;
+
+    /// Gains, stored per output channel (row major).
+    std::vector<float> mGains;
+};
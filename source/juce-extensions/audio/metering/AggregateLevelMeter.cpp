@@ -0,0 +1,201 @@
+#include "AggregateLevelMeter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+AggregateLevelMeter::ChildInput::ChildInput (LevelMeter& childToSubscribeTo) :
+    Subscriber (Scale::getDefaultScale(), std::numeric_limits<int>::max()),
+    child (childToSubscribeTo),
+    childAggregate (dynamic_cast<AggregateLevelMeter*> (&childToSubscribeTo))
+{
+    subscribeToLevelMeter (child);
+}
+
+void AggregateLevelMeter::ChildInput::updateWithMeasurement (const Measurement& measurement)
+{
+    // No ballistics needed here, only the highest measurement of the tick.
+    if (!juce::isPositiveAndBelow (measurement.channelIndex, static_cast<int> (pendingMeasurements.size())))
+        return;
+
+    auto& pending = pendingMeasurements[static_cast<size_t> (measurement.channelIndex)];
+    if (measurement.peakLevel > pending.peakLevel)
+        pending = measurement;
+
+    hasChanged = true;
+}
+
+void AggregateLevelMeter::ChildInput::measurementUpdatesFinished()
+{
+    // The child got reset (like when it goes away), its latest levels no longer count.
+    if (isResetting())
+    {
+        for (auto& measurement : pendingMeasurements)
+            measurement.peakLevel = -1.0;
+        for (auto& measurement : latestMeasurements)
+            measurement.peakLevel = -1.0;
+
+        wasInvalidated = true;
+    }
+}
+
+void AggregateLevelMeter::ChildInput::levelMeterPrepared (int const numChannels)
+{
+    pendingMeasurements.assign (static_cast<size_t> (numChannels), { 0, -1.0 });
+    latestMeasurements.assign (static_cast<size_t> (numChannels), { 0, -1.0 });
+    latestTicks.assign (static_cast<size_t> (numChannels), 0);
+    hasChanged = false;
+    wasInvalidated = true;
+}
+
+AggregateLevelMeter::AggregateLevelMeter (Mode const mode) :
+    LevelMeter (LevelMeterRegistry::DispatchKind::aggregate),
+    mMode (mode)
+{
+}
+
+AggregateLevelMeter::~AggregateLevelMeter()
+{
+    // Unsubscribe from the children before the level meter base gets destroyed.
+    mChildInputs.clear();
+}
+
+void AggregateLevelMeter::addChild (LevelMeter& child)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+    jassert (&child != this);
+
+    for (auto& input : mChildInputs)
+        if (&input->child == &child)
+            return;
+
+    mChildInputs.push_back (std::make_unique<ChildInput> (child));
+}
+
+void AggregateLevelMeter::removeChild (LevelMeter& child)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    auto const numChildren = mChildInputs.size();
+
+    mChildInputs.erase (
+        std::remove_if (
+            mChildInputs.begin(),
+            mChildInputs.end(),
+            [&child] (const std::unique_ptr<ChildInput>& input) {
+                return &input->child == &child;
+            }),
+        mChildInputs.end());
+
+    // The levels of the removed child no longer count.
+    mWasChildRemoved = mWasChildRemoved || mChildInputs.size() != numChildren;
+}
+
+int AggregateLevelMeter::getNumChildren() const
+{
+    return static_cast<int> (mChildInputs.size());
+}
+
+void AggregateLevelMeter::dispatchMeasurements()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    // Aggregates shared by multiple parents get dispatched once per tick, manual calls outside of a tick always run.
+    auto& registry = getRegistry();
+    auto const tick = registry.getTickCount();
+    if (std::exchange (mLastDispatchedTick, tick) == tick && registry.isDispatching())
+        return;
+
+    // Make sure aggregates below this one published their measurements of this tick.
+    for (auto& input : mChildInputs)
+        if (input->childAggregate != nullptr)
+            input->childAggregate->dispatchMeasurements();
+
+    auto const numChannels = static_cast<size_t> (std::max (1, getNumChannels()));
+    mCombinedMeasurements.resize (numChannels);
+    mIsChannelChanged.assign (numChannels, std::exchange (mWasChildRemoved, false));
+
+    // Take the levels published this tick as the latest levels, and find the channels they feed.
+    for (auto& input : mChildInputs)
+    {
+        if (std::exchange (input->wasInvalidated, false))
+            mIsChannelChanged.assign (numChannels, true);
+
+        if (!std::exchange (input->hasChanged, false))
+            continue;
+
+        for (size_t childChannel = 0; childChannel < input->pendingMeasurements.size(); childChannel++)
+        {
+            auto& pending = input->pendingMeasurements[childChannel];
+            if (pending.peakLevel < 0.0)
+                continue;
+
+            input->latestMeasurements[childChannel] = pending;
+            input->latestTicks[childChannel] = tick;
+            pending.peakLevel = -1.0;
+
+            auto const ch = getAggregateChannel (static_cast<int> (childChannel), numChannels);
+            if (ch < numChannels)
+                mIsChannelChanged[ch] = true;
+        }
+    }
+
+    bool hasChanged = false;
+
+    for (size_t ch = 0; ch < numChannels; ch++)
+    {
+        mCombinedMeasurements[ch] = { static_cast<int> (ch), -1.0 };
+        hasChanged = hasChanged || mIsChannelChanged[ch];
+    }
+
+    if (hasChanged)
+    {
+        // Recombine the changed channels from the latest levels of all children, also the ones which skipped this
+        // tick. In energy sum mode, the combined levels hold the sum of the squared levels until being dispatched.
+        for (auto& input : mChildInputs)
+        {
+            for (size_t childChannel = 0; childChannel < input->latestMeasurements.size(); childChannel++)
+            {
+                auto const& latest = input->latestMeasurements[childChannel];
+                if (latest.peakLevel < 0.0 || tick - input->latestTicks[childChannel] > kMaxLevelAgeTicks)
+                    continue;
+
+                auto const ch = getAggregateChannel (static_cast<int> (childChannel), numChannels);
+                if (ch >= numChannels || !mIsChannelChanged[ch])
+                    continue;
+
+                auto& combined = mCombinedMeasurements[ch];
+                auto const accumulated = std::max (0.0, combined.peakLevel);
+
+                combined.peakLevel = mMode == Mode::maximum ? std::max (accumulated, latest.peakLevel)
+                                                            : accumulated + latest.peakLevel * latest.peakLevel;
+                combined.blockInterval = std::max (combined.blockInterval, latest.blockInterval);
+                combined.sampleStride = std::max (combined.sampleStride, latest.sampleStride);
+                combined.isIntegrated = latest.isIntegrated;
+            }
+        }
+
+        for (size_t ch = 0; ch < numChannels; ch++)
+        {
+            if (!mIsChannelChanged[ch])
+                continue;
+
+            // A changed channel which no child feeds anymore drops to silence.
+            auto& combined = mCombinedMeasurements[ch];
+            if (combined.peakLevel < 0.0)
+                combined.peakLevel = 0.0;
+            else if (mMode == Mode::energySum)
+                combined.peakLevel = std::sqrt (combined.peakLevel);
+
+            dispatchToSubscribers (combined);
+        }
+    }
+
+    // Dispatches anything measured on this level meter directly and finishes the update of the subscribers.
+    LevelMeter::dispatchMeasurements();
+}
+
+size_t AggregateLevelMeter::getAggregateChannel (int const childChannel, size_t const numChannels) const
+{
+    return numChannels == 1 ? size_t { 0 } : static_cast<size_t> (childChannel);
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "LevelMeter.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * A level meter for group, VCA and master views which derives its levels from the measurements its child level
+ * meters publish, instead of measuring audio. Children can be aggregates themselves, which makes it possible to build
+ * a tree of meters. Subscribe to it like any other level meter.
+ *
+ * The aggregate keeps the latest level per channel of every child, which is the highest peak the child published
+ * during the last tick it published anything. A child which skips a tick (because its blocks are longer than a tick,
+ * it sheds load or it lags behind) keeps contributing its latest level, until that gets older than kMaxLevelAgeTicks.
+ * Every tick, the channels to which any child published something get recombined from the latest levels of all
+ * children. When no child changed, nothing gets recomputed or dispatched (the subscribers still get
+ * measurementUpdatesFinished()), and neither do the aggregates above it.
+ *
+ * Channel c of a child feeds channel c of the aggregate, or channel 0 if the aggregate has a single channel (see
+ * prepareToPlay()). Other channels are ignored.
+ * Only to be used from the message thread. Children must be removed before they get destroyed.
+ */
+class AggregateLevelMeter : public LevelMeter
+{
+public:
+    /// The number of ticks after which the latest level of a child which stopped publishing no longer counts.
+    static constexpr uint64_t kMaxLevelAgeTicks = LevelMeterConstants::kRefreshRateHz / 2;
+
+    /**
+     * The way the levels of the children get combined.
+     */
+    enum class Mode
+    {
+        /// The highest level of all children, for peak views.
+        maximum,
+
+        /// The square root of the summed squared levels, which assumes uncorrelated children. For RMS and loudness.
+        energySum,
+    };
+
+    /**
+     * Constructor.
+     * @param mode The way the levels of the children get combined.
+     */
+    explicit AggregateLevelMeter (Mode mode = Mode::maximum);
+    ~AggregateLevelMeter() override;
+
+    JUCE_DECLARE_NON_COPYABLE (AggregateLevelMeter)
+    JUCE_DECLARE_NON_MOVEABLE (AggregateLevelMeter)
+
+    /**
+     * Adds a child level meter. Adding the same child twice has no effect.
+     * @param child The child, which can be an aggregate itself (as long as this doesn't create a cycle).
+     */
+    void addChild (LevelMeter& child);
+
+    /**
+     * Removes a child level meter.
+     * @param child The child to remove.
+     */
+    void removeChild (LevelMeter& child);
+
+    /**
+     * @return The number of children.
+     */
+    [[nodiscard]] int getNumChildren() const;
+
+    /**
+     * Combines the measurements the children published this tick and hands the result to the subscribers. Child
+     * aggregates get dispatched first. Within a registry tick, every aggregate gets dispatched once: by the first
+     * parent which needs its measurements, or by the registry. Calls outside of a tick (like manual calls to drive the
+     * meter without a running message loop) always dispatch.
+     */
+    void dispatchMeasurements() override;
+
+private:
+    /**
+     * Receives the measurements of a single child.
+     */
+    class ChildInput : public Subscriber
+    {
+    public:
+        explicit ChildInput (LevelMeter& child);
+
+        /// The child this input is subscribed to.
+        LevelMeter& child;
+
+        /// The child as an aggregate, if it is one.
+        AggregateLevelMeter* childAggregate = nullptr;
+
+        /// The highest measurement per channel since the last tick, of which peakLevel is negative if none.
+        std::vector<Measurement> pendingMeasurements;
+
+        /// The latest level per channel (see the class description), of which peakLevel is negative if none.
+        std::vector<Measurement> latestMeasurements;
+
+        /// The tick during which each latest level was published.
+        std::vector<uint64_t> latestTicks;
+
+        /// True if at least one measurement arrived since the last tick.
+        bool hasChanged = false;
+
+        /// True if the latest levels were dropped since the last tick, because the child got prepared or reset.
+        bool wasInvalidated = false;
+
+        void updateWithMeasurement (const Measurement& measurement) override;
+
+    private:
+        // MARK: LevelMeter::Subscriber overrides -
+        void measurementUpdatesFinished() override;
+        void levelMeterPrepared (int numChannels) override;
+    };
+
+    Mode mMode = Mode::maximum;
+    std::vector<std::unique_ptr<ChildInput>> mChildInputs;
+
+    /// The combined measurements per channel of the current tick, kept to avoid allocating every tick.
+    std::vector<Measurement> mCombinedMeasurements;
+
+    /// The channels to recombine in the current tick, kept to avoid allocating every tick.
+    std::vector<bool> mIsChannelChanged;
+
+    /// True if a child was removed since the last tick, which changes every channel.
+    bool mWasChildRemoved = false;
+
+    /**
+     * @return The channel of this aggregate which given channel of a child feeds, which may be out of range.
+     */
+    [[nodiscard]] size_t getAggregateChannel (int childChannel, size_t numChannels) const;
+
+    /// The registry tick during which this aggregate was last dispatched, see dispatchMeasurements().
+    uint64_t mLastDispatchedTick = 0;
+};
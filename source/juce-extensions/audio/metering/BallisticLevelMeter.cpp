@@ -0,0 +1,55 @@
+#include "BallisticLevelMeter.h"
+
+template <typename BallisticsPolicy>
+void BallisticLevelMeter<BallisticsPolicy>::preparedToPlay (int const numChannels, double const sampleRate)
+{
+    jassert (sampleRate > 0.0); // The ballistics depend on the sample rate.
+
+    mChannels.resize (static_cast<size_t> (std::max (0, numChannels)));
+
+    for (auto& channel : mChannels)
+        channel.prepare (sampleRate > 0.0 ? sampleRate : kFallbackSampleRate);
+}
+
+template <typename BallisticsPolicy>
+bool BallisticLevelMeter<BallisticsPolicy>::isIntegrating() const
+{
+    return true;
+}
+
+template <typename BallisticsPolicy>
+double BallisticLevelMeter<BallisticsPolicy>::integrateChannel (
+    int const channelIndex,
+    const float* const samples,
+    int const numSamples)
+{
+    return integrate (channelIndex, samples, numSamples);
+}
+
+template <typename BallisticsPolicy>
+double BallisticLevelMeter<BallisticsPolicy>::integrateChannel (
+    int const channelIndex,
+    const double* const samples,
+    int const numSamples)
+{
+    return integrate (channelIndex, samples, numSamples);
+}
+
+template <typename BallisticsPolicy>
+template <typename SampleType>
+double BallisticLevelMeter<BallisticsPolicy>::integrate (
+    int const channelIndex,
+    const SampleType* const samples,
+    int const numSamples)
+{
+    if (!juce::isPositiveAndBelow (channelIndex, static_cast<int> (mChannels.size())))
+        return 0.0;
+
+    return mChannels[static_cast<size_t> (channelIndex)].process (samples, numSamples);
+}
+
+// Trigger symbol generation.
+template class BallisticLevelMeter<PpmType1Ballistics>;
+template class BallisticLevelMeter<PpmType2Ballistics>;
+template class BallisticLevelMeter<DigitalPeakBallistics>;
+template class BallisticLevelMeter<VuBallistics>;
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Ballistics.h"
+#include "LevelMeter.h"
+
+#include <vector>
+
+/**
+ * A level meter which runs the ballistics of a standardised meter on the audio thread (see Ballistics.h), so that the
+ * subscribers receive the integrated readings instead of block peaks. The ballistics get selected at compile time, so
+ * only the chosen integrator ends up in the measuring code.
+ *
+ * The meter needs a sample rate: prepare it with LevelMeter::prepareToPlay (numChannels, sampleRate). Every measuring
+ * method of LevelMeter integrates (see LevelMeter::isIntegrating()), also when called through a LevelMeter& or from a
+ * LevelMeterBatch, so no raw block peaks ever get published.
+ * @tparam BallisticsPolicy The ballistics, for example PpmType2Ballistics or VuBallistics.
+ */
+template <typename BallisticsPolicy>
+class BallisticLevelMeter : public LevelMeter
+{
+public:
+    BallisticLevelMeter() = default;
+
+    JUCE_DECLARE_NON_COPYABLE (BallisticLevelMeter)
+    JUCE_DECLARE_NON_MOVEABLE (BallisticLevelMeter)
+
+protected:
+    // MARK: LevelMeter overrides -
+    void preparedToPlay (int numChannels, double sampleRate) override;
+    [[nodiscard]] bool isIntegrating() const override;
+    double integrateChannel (int channelIndex, const float* samples, int numSamples) override;
+    double integrateChannel (int channelIndex, const double* samples, int numSamples) override;
+
+private:
+    /// Used when the meter was prepared without a sample rate.
+    static constexpr double kFallbackSampleRate = 48000.0;
+
+    /// The integrator per channel, only accessed by the audio thread after being prepared.
+    std::vector<BallisticsPolicy> mChannels;
+
+    /**
+     * Runs the integrator of a channel over given samples.
+     * @return The highest reading, or 0.0 for channels beyond the prepared number of channels.
+     */
+    template <typename SampleType>
+    double integrate (int channelIndex, const SampleType* samples, int numSamples);
+};
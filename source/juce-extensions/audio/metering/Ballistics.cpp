@@ -0,0 +1,132 @@
+#include "Ballistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <juce_core/juce_core.h>
+
+namespace
+{
+/// Below this level (-200 dB) the integrators snap to zero, which keeps them out of denormal numbers.
+constexpr double kMinLevel = 1.0e-10;
+} // namespace
+
+PeakProgrammeBallistics::PeakProgrammeBallistics (
+    double const integrationTimeMs,
+    double const integrationReadingDb,
+    double const returnDb,
+    double const returnTimeSeconds) :
+    mIntegrationTimeMs (integrationTimeMs),
+    mIntegrationReadingDb (integrationReadingDb),
+    mReturnDb (returnDb),
+    mReturnTimeSeconds (returnTimeSeconds)
+{
+}
+
+void PeakProgrammeBallistics::prepare (double const sampleRate)
+{
+    // A constant input reaches 1 - (1 - a)^n after n samples, which has to match the reading for the tone burst.
+    auto const numIntegrationSamples = mIntegrationTimeMs / 1000.0 * sampleRate;
+    auto const integrationReading = std::pow (10.0, mIntegrationReadingDb / 20.0);
+    mAttackCoefficient =
+        numIntegrationSamples >= 1.0 ? 1.0 - std::pow (1.0 - integrationReading, 1.0 / numIntegrationSamples) : 1.0;
+
+    mReleaseCoefficient = std::pow (10.0, -mReturnDb / 20.0 / (mReturnTimeSeconds * sampleRate));
+    mSubBlockReleaseCoefficient = std::pow (mReleaseCoefficient, kSubBlockLength);
+
+    reset();
+}
+
+void PeakProgrammeBallistics::reset()
+{
+    mLevel = 0.0;
+}
+
+template <typename SampleType>
+double PeakProgrammeBallistics::process (const SampleType* const samples, int const numSamples)
+{
+    auto level = mLevel;
+    auto highestLevel = 0.0;
+
+    auto const step = [this, &level, &highestLevel] (double const sample) {
+        level = sample > level ? level + (sample - level) * mAttackCoefficient : level * mReleaseCoefficient;
+        highestLevel = std::max (highestLevel, level);
+    };
+
+    int i = 0;
+    for (; i + kSubBlockLength <= numSamples; i += kSubBlockLength)
+    {
+        SampleType peak {};
+        for (int j = 0; j < kSubBlockLength; j++)
+            peak = std::max (peak, std::abs (samples[i + j]));
+
+        // The level is lowest at the end of the sub-block, so when no sample exceeds that nothing attacks.
+        auto const decayedLevel = level * mSubBlockReleaseCoefficient;
+        if (static_cast<double> (peak) <= decayedLevel)
+        {
+            highestLevel = std::max (highestLevel, level * mReleaseCoefficient);
+            level = decayedLevel;
+            continue;
+        }
+
+        for (int j = 0; j < kSubBlockLength; j++)
+            step (static_cast<double> (std::abs (samples[i + j])));
+    }
+
+    for (; i < numSamples; i++)
+        step (static_cast<double> (std::abs (samples[i])));
+
+    mLevel = level < kMinLevel ? 0.0 : level;
+    return highestLevel;
+}
+
+// Trigger symbol generation.
+template double PeakProgrammeBallistics::process (const float* samples, int numSamples);
+template double PeakProgrammeBallistics::process (const double* samples, int numSamples);
+
+PpmType1Ballistics::PpmType1Ballistics() : PeakProgrammeBallistics (5.0, -2.0, 20.0, 1.5) {}
+
+PpmType2Ballistics::PpmType2Ballistics() : PeakProgrammeBallistics (10.0, -4.0, 24.0, 2.8) {}
+
+DigitalPeakBallistics::DigitalPeakBallistics() : PeakProgrammeBallistics (0.0, 0.0, 20.0, 1.7) {}
+
+void VuBallistics::prepare (double const sampleRate)
+{
+    // The step response of two equal one pole stages reaches 99% after 6.64 time constants.
+    constexpr double kRiseTimeSeconds = 0.3;
+    constexpr double kRiseTimeInTimeConstants = 6.64;
+
+    mCoefficient = 1.0 - std::exp (-kRiseTimeInTimeConstants / (kRiseTimeSeconds * sampleRate));
+    reset();
+}
+
+void VuBallistics::reset()
+{
+    mFirstStage = 0.0;
+    mSecondStage = 0.0;
+}
+
+template <typename SampleType>
+double VuBallistics::process (const SampleType* const samples, int const numSamples)
+{
+    // The rectified average of a sine wave is 2 / pi of its peak, its RMS level is 1 / sqrt (2) of its peak.
+    constexpr double kSineRmsScale = juce::MathConstants<double>::pi / (2.0 * juce::MathConstants<double>::sqrt2);
+
+    auto firstStage = mFirstStage;
+    auto secondStage = mSecondStage;
+    auto highestLevel = 0.0;
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        firstStage += (static_cast<double> (std::abs (samples[i])) - firstStage) * mCoefficient;
+        secondStage += (firstStage - secondStage) * mCoefficient;
+        highestLevel = std::max (highestLevel, secondStage);
+    }
+
+    mFirstStage = firstStage < kMinLevel ? 0.0 : firstStage;
+    mSecondStage = secondStage < kMinLevel ? 0.0 : secondStage;
+    return highestLevel * kSineRmsScale;
+}
+
+// Trigger symbol generation.
+template double VuBallistics::process (const float* samples, int numSamples);
+template double VuBallistics::process (const double* samples, int numSamples);
@@ -0,0 +1,105 @@
+#pragma once
+
+/**
+ * Ballistics policies for BallisticLevelMeter. Each policy integrates the samples of a single channel into the reading
+ * of a standardised meter, on the audio thread, so that the reading depends on the signal and the sample rate instead
+ * of on when the UI happens to look at it.
+ *
+ * A policy is default constructible and provides:
+ * - void prepare (double sampleRate), which calculates the coefficients and resets the state;
+ * - void reset(), which resets the state;
+ * - template <typename SampleType> double process (const SampleType* samples, int numSamples), which integrates the
+ *   samples and returns the highest reading during the block.
+ */
+
+/**
+ * Peak programme ballistics: a full wave rectifier with a fast attack and a slow logarithmic return, as used by peak
+ * programme meters (IEC 60268-10) and digital peak meters (IEC 60268-18).
+ *
+ * The attack gets derived from the specified reading for a tone burst of given duration. The return is a constant
+ * number of decibels per second. While no sample exceeds the returning level, the level only decays, which gets done
+ * a whole sub-block at a time after a vectorised check of the sub-block's peak.
+ */
+class PeakProgrammeBallistics
+{
+public:
+    /**
+     * Constructor.
+     * @param integrationTimeMs The duration of the tone burst which defines the attack, or 0.0 for an instant attack.
+     * @param integrationReadingDb The reading (relative to the steady state reading) for that tone burst.
+     * @param returnDb The number of decibels the reading falls in the return time.
+     * @param returnTimeSeconds The return time.
+     */
+    PeakProgrammeBallistics (
+        double integrationTimeMs,
+        double integrationReadingDb,
+        double returnDb,
+        double returnTimeSeconds);
+
+    void prepare (double sampleRate);
+    void reset();
+
+    template <typename SampleType>
+    double process (const SampleType* samples, int numSamples);
+
+private:
+    /// The number of samples which get decayed at once when none of them attacks.
+    static constexpr int kSubBlockLength = 16;
+
+    double mIntegrationTimeMs;
+    double mIntegrationReadingDb;
+    double mReturnDb;
+    double mReturnTimeSeconds;
+
+    double mAttackCoefficient = 1.0;
+    double mReleaseCoefficient = 1.0;
+    double mSubBlockReleaseCoefficient = 1.0;
+    double mLevel = 0.0;
+};
+
+/**
+ * IEC 60268-10 Type I (DIN 45406): a 5 ms tone burst reads -2 dB, the reading returns 20 dB in 1.5 seconds.
+ */
+class PpmType1Ballistics : public PeakProgrammeBallistics
+{
+public:
+    PpmType1Ballistics();
+};
+
+/**
+ * IEC 60268-10 Type II (BBC, EBU): a 10 ms tone burst reads -4 dB, the reading returns 24 dB in 2.8 seconds.
+ */
+class PpmType2Ballistics : public PeakProgrammeBallistics
+{
+public:
+    PpmType2Ballistics();
+};
+
+/**
+ * IEC 60268-18 digital peak meter: an instant attack, the reading returns 20 dB in 1.7 seconds.
+ */
+class DigitalPeakBallistics : public PeakProgrammeBallistics
+{
+public:
+    DigitalPeakBallistics();
+};
+
+/**
+ * Volume indicator (VU meter, IEC 60268-17) ballistics: the full wave rectified signal through a critically damped
+ * second order low pass, reaching 99% of the reading in 300 ms. The reading is scaled so that a sine wave reads its
+ * RMS level. A real VU meter overshoots by about 1%, which this doesn't model.
+ */
+class VuBallistics
+{
+public:
+    void prepare (double sampleRate);
+    void reset();
+
+    template <typename SampleType>
+    double process (const SampleType* samples, int numSamples);
+
+private:
+    double mCoefficient = 1.0;
+    double mFirstStage = 0.0;
+    double mSecondStage = 0.0;
+};
@@ -0,0 +1,135 @@
+#include "ChangedChannelsPublisher.h"
+
+ChangedChannelsPublisher::Options ChangedChannelsPublisher::Options::getDefault()
+{
+    return {};
+}
+
+ChangedChannelsPublisher::ChangedChannelsPublisher (
+    const Options& options,
+    int const numChannels,
+    double const sampleRate) :
+    mNumChannels (std::max (1, numChannels)),
+    mNumWords ((mNumChannels + kBitsPerWord - 1) / kBitsPerWord),
+    mNumFrames (std::max (2, options.numFrames)),
+    mChangeRatio (juce::Decibels::decibelsToGain (static_cast<float> (std::max (0.0, options.changeThresholdDb)))),
+    mFloorLevel (juce::Decibels::decibelsToGain (static_cast<float> (options.floorDb), -1000.0f)),
+    mRefreshIntervalSeconds (options.refreshIntervalSeconds),
+    mFrameInfos (std::make_unique<FrameInfo[]> (static_cast<size_t> (mNumFrames))),
+    mMasks (std::make_unique<uint64_t[]> (static_cast<size_t> (mNumFrames * mNumWords))),
+    mLevels (std::make_unique<float[]> (static_cast<size_t> (mNumFrames * mNumChannels))),
+    mChannels (static_cast<size_t> (mNumChannels)),
+    mPendingLevels (static_cast<size_t> (mNumChannels))
+{
+    setSampleRate (sampleRate);
+}
+
+void ChangedChannelsPublisher::setSampleRate (double const sampleRate)
+{
+    mRefreshInterval = juce::roundToInt ((sampleRate > 0.0 ? sampleRate : 48000.0) * mRefreshIntervalSeconds);
+}
+
+int ChangedChannelsPublisher::getNumChannels() const
+{
+    return mNumChannels;
+}
+
+void ChangedChannelsPublisher::addLevel (int const channelIndex, double const peakLevel, const FrameInfo& frameInfo)
+{
+    if (!juce::isPositiveAndBelow (channelIndex, mNumChannels))
+        return;
+
+    if (!mIsFrameOpen)
+        openFrame (frameInfo);
+
+    if (!mIsFrameAvailable)
+        return;
+
+    auto& state = mChannels[static_cast<size_t> (channelIndex)];
+    auto const level = static_cast<float> (peakLevel);
+    auto const isAboveFloor = level > mFloorLevel;
+
+    auto const isChanged = isAboveFloor
+                               ? !state.wasAboveFloor || level > state.level * mChangeRatio ||
+                                     level < state.level / mChangeRatio ||
+                                     frameInfo.samplePosition - state.samplePosition >= mRefreshInterval ||
+                                     frameInfo.samplePosition < state.samplePosition
+                               : state.wasAboveFloor;
+
+    if (!isChanged)
+        return;
+
+    state.level = level;
+    state.wasAboveFloor = isAboveFloor;
+    state.samplePosition = frameInfo.samplePosition;
+
+    auto& mask = mMasks[getWriteFrame() * static_cast<size_t> (mNumWords) +
+                        static_cast<size_t> (channelIndex / kBitsPerWord)];
+    auto const bit = uint64_t { 1 } << (channelIndex % kBitsPerWord);
+    auto& pendingLevel = mPendingLevels[static_cast<size_t> (channelIndex)];
+
+    // A channel measured twice in the same block shows its highest level.
+    pendingLevel = (mask & bit) != 0 ? std::max (pendingLevel, level) : level;
+    mask |= bit;
+    mHasLevels = true;
+}
+
+void ChangedChannelsPublisher::publishFrame()
+{
+    if (!std::exchange (mIsFrameOpen, false) || !mIsFrameAvailable || !mHasLevels)
+        return;
+
+    auto const frame = getWriteFrame();
+    auto const* masks = mMasks.get() + frame * static_cast<size_t> (mNumWords);
+    auto* levels = mLevels.get() + frame * static_cast<size_t> (mNumChannels);
+
+    // Pack the levels in channel order, which is the order the reader finds the bits in.
+    for (int word = 0; word < mNumWords; word++)
+        for (auto bits = masks[word]; bits != 0; bits &= bits - 1)
+            *levels++ = mPendingLevels[static_cast<size_t> (word * kBitsPerWord + findLowestSetBit (bits))];
+
+    // The only synchronisation per block: makes the whole frame visible to the reader.
+    mWriteIndex.store (mWriteIndex.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+uint64_t ChangedChannelsPublisher::getNumDroppedFrames() const
+{
+    return mNumDroppedFrames.load (std::memory_order_relaxed);
+}
+
+void ChangedChannelsPublisher::openFrame (const FrameInfo& frameInfo)
+{
+    mIsFrameOpen = true;
+    mHasLevels = false;
+
+    auto const writeIndex = mWriteIndex.load (std::memory_order_relaxed);
+    mIsFrameAvailable = writeIndex - mReadIndex.load (std::memory_order_acquire) < static_cast<uint64_t> (mNumFrames);
+
+    if (!mIsFrameAvailable)
+    {
+        mNumDroppedFrames.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Levels folded by another channel map, or taken with another configuration of the level meter, are about other
+    // channels, so publish every channel once.
+    auto const isChannelMapChanged = std::exchange (mChannelMapId, frameInfo.channelMapId) != frameInfo.channelMapId;
+    auto const isEpochChanged = std::exchange (mEpoch, frameInfo.epoch) != frameInfo.epoch;
+
+    if (isChannelMapChanged || isEpochChanged)
+        std::fill (mChannels.begin(), mChannels.end(), ChannelState {});
+
+    auto const frame = getWriteFrame();
+    mFrameInfos[frame] = frameInfo;
+    std::fill_n (mMasks.get() + frame * static_cast<size_t> (mNumWords), mNumWords, uint64_t { 0 });
+}
+
+size_t ChangedChannelsPublisher::getWriteFrame() const
+{
+    return static_cast<size_t> (mWriteIndex.load (std::memory_order_relaxed) % static_cast<uint64_t> (mNumFrames));
+}
+
+int ChangedChannelsPublisher::findLowestSetBit (uint64_t const word)
+{
+    return juce::countNumberOfBits (static_cast<juce::uint64> ((word & (~word + 1)) - 1));
+}
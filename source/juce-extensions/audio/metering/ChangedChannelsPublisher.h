@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "LevelMeterConstants.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+
+/**
+ * Publishes the peak levels of a block of audio from the audio thread, leaving out the channels which didn't change
+ * meaningfully. Most channels of a large input bridge are silent most of the time: a channel only gets published when
+ * its level moved by more than a threshold, when it crossed the floor of the scale (in either direction) or when it
+ * wasn't published for a refresh interval while above the floor (so that a steady level doesn't decay on screen).
+ * Channels which stay below the floor aren't published at all.
+ *
+ * Every block which has anything to publish becomes a frame: a bitmask of the published channels plus their levels,
+ * packed in channel order. Frames live in a ring which is allocated up front and get published with a single release
+ * store, like LevelMeterBatch. Reading a frame costs a word per 64 channels plus the work for the published channels.
+ * When the reader falls behind by more frames than the ring holds, the levels of a block get lost (and counted).
+ *
+ * Levels are added by a single (audio) thread, frames are read by a single other thread.
+ */
+class ChangedChannelsPublisher
+{
+public:
+    struct Options
+    {
+        /// The change in level which counts as meaningful.
+        double changeThresholdDb = 0.5;
+
+        /// Channels at or below the floor are silent.
+        double floorDb = LevelMeterConstants::kDefaultMinusInfinityDb;
+
+        /// The max time between publishing the level of a channel above the floor. Shorter than the time subscribers
+        /// hold a peak, so that a steady level doesn't start to decay.
+        double refreshIntervalSeconds = 0.5 / LevelMeterConstants::kRefreshRateHz;
+
+        /// The number of frames in the ring, which is the number of blocks which can be published between reads.
+        int numFrames = 64;
+
+        /**
+         * @returns The default options.
+         */
+        static Options getDefault();
+    };
+
+    /**
+     * The properties which all levels of a frame share.
+     */
+    struct FrameInfo
+    {
+        int64_t samplePosition = -1;
+        uint16_t blockInterval = 1;
+        uint16_t sampleStride = 1;
+        uint32_t channelMapId = 0;
+        uint32_t epoch = 0; ///< See LevelMeter::setNumChannels().
+    };
+
+    /**
+     * Constructor.
+     * @param options The options.
+     * @param numChannels The max number of channels per block, higher channels are ignored.
+     * @param sampleRate The sample rate, for the refresh interval. Assumes 48 kHz when unknown (0.0).
+     */
+    ChangedChannelsPublisher (const Options& options, int numChannels, double sampleRate);
+
+    JUCE_DECLARE_NON_COPYABLE (ChangedChannelsPublisher)
+    JUCE_DECLARE_NON_MOVEABLE (ChangedChannelsPublisher)
+
+    /**
+     * Updates the refresh interval for another sample rate, without reallocating. Must not be called while levels are
+     * being added.
+     * @param sampleRate The sample rate. Assumes 48 kHz when unknown (0.0).
+     */
+    void setSampleRate (double sampleRate);
+
+    /**
+     * @return The max number of channels per block.
+     */
+    [[nodiscard]] int getNumChannels() const;
+
+    /**
+     * Adds the level of a channel to the frame of the current block, if it changed meaningfully. Realtime safe.
+     * @param channelIndex The index of the channel.
+     * @param peakLevel The peak level.
+     * @param frameInfo The properties of the block, which are taken from the first level of every block.
+     */
+    void addLevel (int channelIndex, double peakLevel, const FrameInfo& frameInfo);
+
+    /**
+     * Publishes the frame of the current block, if any channel was added to it. Realtime safe.
+     */
+    void publishFrame();
+
+    /**
+     * Hands the levels of all frames published since the previous call to given callback, in order.
+     * @param callback Called as callback (const FrameInfo&, int channelIndex, float peakLevel) for every published
+     * level.
+     */
+    template <typename Callback>
+    void readFrames (Callback&& callback);
+
+    /**
+     * @return The number of blocks whose levels were lost because the ring was full. Can be called from any thread.
+     */
+    [[nodiscard]] uint64_t getNumDroppedFrames() const;
+
+    /**
+     * Publishes the frame of the current block (if any) when going out of scope, for measure methods with multiple
+     * exits.
+     */
+    class ScopedFrame
+    {
+    public:
+        explicit ScopedFrame (ChangedChannelsPublisher* publisher) : mPublisher (publisher) {}
+
+        ~ScopedFrame()
+        {
+            if (mPublisher != nullptr)
+                mPublisher->publishFrame();
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedFrame)
+        JUCE_DECLARE_NON_MOVEABLE (ScopedFrame)
+
+    private:
+        ChangedChannelsPublisher* mPublisher = nullptr;
+    };
+
+private:
+    static constexpr int kBitsPerWord = 64;
+
+    /**
+     * The most recently published level of a channel, only accessed by the audio thread.
+     */
+    struct ChannelState
+    {
+        float level = -1.0f; ///< Negative to force the next level to be published.
+        bool wasAboveFloor = true;
+        int64_t samplePosition = 0;
+    };
+
+    int mNumChannels = 0;
+    int mNumWords = 0;
+    int mNumFrames = 0;
+    float mChangeRatio = 1.0f;
+    float mFloorLevel = 0.0f;
+    double mRefreshIntervalSeconds = 0.0;
+    int64_t mRefreshInterval = 0;
+
+    /// The frames: the shared properties, the bitmasks (mNumWords per frame) and the packed levels (mNumChannels per
+    /// frame).
+    std::unique_ptr<FrameInfo[]> mFrameInfos;
+    std::unique_ptr<uint64_t[]> mMasks;
+    std::unique_ptr<float[]> mLevels;
+
+    /// The number of frames published, only written by the audio thread.
+    std::atomic<uint64_t> mWriteIndex { 0 };
+
+    /// The number of frames read, only written by the reading thread.
+    std::atomic<uint64_t> mReadIndex { 0 };
+
+    std::atomic<uint64_t> mNumDroppedFrames { 0 };
+
+    /// The rest is only accessed by the audio thread.
+    std::vector<ChannelState> mChannels;
+
+    /// The levels of the frame being built, by channel.
+    std::vector<float> mPendingLevels;
+
+    uint32_t mChannelMapId = 0;
+    uint32_t mEpoch = 0;
+    bool mIsFrameOpen = false;
+    bool mIsFrameAvailable = false;
+    bool mHasLevels = false;
+
+    /**
+     * Starts the frame of a new block, if the ring has room for it.
+     */
+    void openFrame (const FrameInfo& frameInfo);
+
+    /**
+     * @return The frame the audio thread writes to.
+     */
+    [[nodiscard]] size_t getWriteFrame() const;
+
+    /**
+     * @return The index of the lowest set bit of given (non-zero) word.
+     */
+    static int findLowestSetBit (uint64_t word);
+};
+
+template <typename Callback>
+void ChangedChannelsPublisher::readFrames (Callback&& callback)
+{
+    auto const writeIndex = mWriteIndex.load (std::memory_order_acquire);
+    auto readIndex = mReadIndex.load (std::memory_order_relaxed);
+
+    for (; readIndex < writeIndex; readIndex++)
+    {
+        auto const frame = static_cast<size_t> (readIndex % static_cast<uint64_t> (mNumFrames));
+        auto const& frameInfo = mFrameInfos[frame];
+        auto const* masks = mMasks.get() + frame * static_cast<size_t> (mNumWords);
+        auto const* levels = mLevels.get() + frame * static_cast<size_t> (mNumChannels);
+
+        // Only visits the published channels.
+        for (int word = 0; word < mNumWords; word++)
+            for (auto bits = masks[word]; bits != 0; bits &= bits - 1)
+                callback (frameInfo, word * kBitsPerWord + findLowestSetBit (bits), *levels++);
+    }
+
+    mReadIndex.store (readIndex, std::memory_order_release);
+}
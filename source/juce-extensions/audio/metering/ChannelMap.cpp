@@ -0,0 +1,90 @@
+#include "ChannelMap.h"
+
+#include <algorithm>
+
+ChannelMap ChannelMap::createIdentity()
+{
+    return {};
+}
+
+ChannelMap ChannelMap::createMonoFold()
+{
+    ChannelMap channelMap;
+    channelMap.mType = Type::monoFold;
+    return channelMap;
+}
+
+ChannelMap ChannelMap::createStereoPairs()
+{
+    ChannelMap channelMap;
+    channelMap.mType = Type::stereoPairs;
+    return channelMap;
+}
+
+ChannelMap ChannelMap::createSubset (std::vector<int> channels)
+{
+    ChannelMap channelMap;
+    channelMap.mType = Type::subset;
+    channelMap.mChannels = std::move (channels);
+    return channelMap;
+}
+
+ChannelMap::Type ChannelMap::getType() const
+{
+    return mType;
+}
+
+bool ChannelMap::isIdentity() const
+{
+    return mType == Type::identity;
+}
+
+int ChannelMap::getNumOutputChannels (int const numInputChannels) const
+{
+    switch (mType)
+    {
+        case Type::identity:
+            return numInputChannels;
+        case Type::monoFold:
+            return 1;
+        case Type::stereoPairs:
+            return (numInputChannels + 1) / 2;
+        case Type::subset:
+            return static_cast<int> (mChannels.size());
+    }
+
+    return numInputChannels;
+}
+
+int ChannelMap::getOutputChannel (int const inputChannel, int const numInputChannels) const
+{
+    if (inputChannel < 0)
+        return -1;
+
+    switch (mType)
+    {
+        case Type::identity:
+            return inputChannel < numInputChannels ? inputChannel : -1;
+        case Type::monoFold:
+            return 0;
+        case Type::stereoPairs:
+            return inputChannel < numInputChannels ? inputChannel / 2 : -1;
+        case Type::subset:
+        {
+            auto const it = std::find (mChannels.begin(), mChannels.end(), inputChannel);
+            return it != mChannels.end() ? static_cast<int> (std::distance (mChannels.begin(), it)) : -1;
+        }
+    }
+
+    return -1;
+}
+
+bool ChannelMap::operator== (const ChannelMap& other) const
+{
+    return mType == other.mType && mChannels == other.mChannels;
+}
+
+bool ChannelMap::operator!= (const ChannelMap& other) const
+{
+    return !(*this == other);
+}
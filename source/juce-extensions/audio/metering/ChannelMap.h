@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * Describes which channels of a level meter a subscriber shows, and how they get folded into the channels of the
+ * subscriber. Every channel of the level meter ends up in at most one channel of the subscriber, which shows the
+ * highest level of its channels.
+ *
+ * A map doesn't depend on the number of channels of the level meter, so it stays valid when the level meter gets
+ * prepared again. LevelMeter compiles the map of its subscribers into the measuring on the audio thread (see
+ * Subscriber::setChannelMap()).
+ */
+class ChannelMap
+{
+public:
+    enum class Type
+    {
+        identity,    ///< Every channel is shown as is.
+        monoFold,    ///< All channels get folded into a single channel.
+        stereoPairs, ///< Every two consecutive channels get folded into a single channel.
+        subset,      ///< Only the selected channels are shown, in the order of selection.
+    };
+
+    /**
+     * Constructor, creates an identity map.
+     */
+    ChannelMap() = default;
+
+    /**
+     * @return A map which shows every channel as is.
+     */
+    static ChannelMap createIdentity();
+
+    /**
+     * @return A map which folds all channels into a single channel.
+     */
+    static ChannelMap createMonoFold();
+
+    /**
+     * @return A map which folds channels 0 and 1 into channel 0, 2 and 3 into channel 1 and so on. A trailing odd
+     * channel gets a channel of its own.
+     */
+    static ChannelMap createStereoPairs();
+
+    /**
+     * Creates a map which only shows the selected channels.
+     * @param channels The channels of the level meter to show, which become channels 0, 1, 2... of the subscriber.
+     * Channels the level meter doesn't have are still shown (without measurements), channels selected twice are
+     * only shown the first time.
+     * @return The created map.
+     */
+    static ChannelMap createSubset (std::vector<int> channels);
+
+    /**
+     * @return The type of map.
+     */
+    [[nodiscard]] Type getType() const;
+
+    /**
+     * @return True if every channel is shown as is.
+     */
+    [[nodiscard]] bool isIdentity() const;
+
+    /**
+     * @param numInputChannels The number of channels of the level meter.
+     * @return The number of channels of the subscriber.
+     */
+    [[nodiscard]] int getNumOutputChannels (int numInputChannels) const;
+
+    /**
+     * @param inputChannel The channel of the level meter.
+     * @param numInputChannels The number of channels of the level meter.
+     * @return The channel of the subscriber which given channel gets folded into, or -1 if it isn't shown.
+     */
+    [[nodiscard]] int getOutputChannel (int inputChannel, int numInputChannels) const;
+
+    bool operator== (const ChannelMap& other) const;
+    bool operator!= (const ChannelMap& other) const;
+
+private:
+    Type mType = Type::identity;
+
+    /// The selected channels, for a subset.
+    std::vector<int> mChannels;
+};
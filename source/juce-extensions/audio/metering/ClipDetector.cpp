@@ -0,0 +1,117 @@
+#include "ClipDetector.h"
+
+ClipDetector::Options ClipDetector::Options::getDefault()
+{
+    return {};
+}
+
+ClipDetector::ClipDetector (const Options& options, int const numChannels) :
+    mClipLevel (options.clipLevel),
+    mMinRunLength (std::max (1, options.minRunLength)),
+    mEvents (static_cast<size_t> (std::max (1, options.queueCapacity)))
+{
+    prepareToPlay (numChannels);
+}
+
+void ClipDetector::prepareToPlay (int const numChannels)
+{
+    mRuns.assign (static_cast<size_t> (std::max (0, numChannels)), {});
+}
+
+void ClipDetector::setOptions (const Options& options)
+{
+    mClipLevel.store (options.clipLevel, std::memory_order_relaxed);
+    mMinRunLength.store (std::max (1, options.minRunLength), std::memory_order_relaxed);
+}
+
+template <typename SampleType>
+void ClipDetector::process (
+    int const channelIndex,
+    const SampleType* const samples,
+    int const numSamples,
+    SampleType const peakLevel,
+    int64_t const samplePosition)
+{
+    if (!juce::isPositiveAndBelow (channelIndex, static_cast<int> (mRuns.size())))
+        return;
+
+    auto& run = mRuns[static_cast<size_t> (channelIndex)];
+
+    // Blocks which were skipped (or not processed while detection was off) end the run.
+    if (run.length > 0 && run.samplePosition + run.length != samplePosition)
+        finishRun (channelIndex, run);
+
+    auto const clipLevel = static_cast<SampleType> (mClipLevel.load (std::memory_order_relaxed));
+
+    // Most blocks don't clip at all, which the peak level already tells.
+    if (run.length == 0 && peakLevel < clipLevel)
+        return;
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        // Outside of a run, skip ahead over unclipped samples a vector at a time.
+        if (run.length == 0)
+        {
+            while (i + kNumLanes <= numSamples && !isAnyClipped (samples + i, clipLevel))
+                i += kNumLanes;
+
+            if (i >= numSamples)
+                break;
+        }
+
+        if (std::abs (samples[i]) >= clipLevel)
+        {
+            if (run.length++ == 0)
+                run.samplePosition = samplePosition + i;
+        }
+        else if (run.length > 0)
+        {
+            finishRun (channelIndex, run);
+        }
+    }
+}
+
+// Trigger symbol generation.
+template void ClipDetector::process (
+    int channelIndex,
+    const float* samples,
+    int numSamples,
+    float peakLevel,
+    int64_t samplePosition);
+template void ClipDetector::process (
+    int channelIndex,
+    const double* samples,
+    int numSamples,
+    double peakLevel,
+    int64_t samplePosition);
+
+bool ClipDetector::popEvent (Event& event)
+{
+    return mEvents.try_dequeue (event);
+}
+
+uint64_t ClipDetector::getNumLostEvents() const
+{
+    return mNumLostEvents.load (std::memory_order_relaxed);
+}
+
+void ClipDetector::finishRun (int const channelIndex, Run& run)
+{
+    if (run.length >= mMinRunLength.load (std::memory_order_relaxed))
+    {
+        // Never lets the queue grow, which would allocate.
+        if (!mEvents.try_enqueue ({ channelIndex, run.samplePosition, run.length }))
+            mNumLostEvents.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    run.length = 0;
+}
+
+template <typename SampleType>
+bool ClipDetector::isAnyClipped (const SampleType* const samples, SampleType const clipLevel)
+{
+    bool isClipped = false;
+    for (int lane = 0; lane < kNumLanes; lane++)
+        isClipped |= std::abs (samples[lane]) >= clipLevel;
+    return isClipped;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <juce_core/juce_core.h>
+#include <readerwriterqueue/readerwriterqueue.h>
+#include <vector>
+
+/**
+ * Finds runs of consecutive clipped samples on the audio thread, sample accurately, and hands every run which is at
+ * least a configured number of samples long (like the "N consecutive samples at full scale" rules used in
+ * broadcasting) to another thread as a clip event.
+ *
+ * Events go through a bounded queue which never allocates on the audio thread: when it's full, events get lost and
+ * counted (see getNumLostEvents()). A run gets reported once it ends, which is at the first unclipped sample or at a
+ * gap in the positions of the processed blocks.
+ *
+ * Processing is done by a single (audio) thread, events are read by a single other thread. The options can be
+ * changed from any thread.
+ */
+class ClipDetector
+{
+public:
+    /**
+     * A run of clipped samples in a single channel.
+     */
+    struct Event
+    {
+        int channelIndex = 0;
+        int64_t samplePosition = 0; ///< The position of the first clipped sample.
+        int64_t length = 0;         ///< The number of consecutive clipped samples.
+    };
+
+    struct Options
+    {
+        float clipLevel = 0.999f; ///< Samples with an absolute value at or above this level count as clipped.
+        int minRunLength = 3;     ///< The minimum length of a run to count as clip event.
+        int queueCapacity = 256;  ///< The max number of events waiting to be read.
+
+        /**
+         * @returns The default options.
+         */
+        static Options getDefault();
+    };
+
+    /**
+     * Constructor.
+     * @param options The options.
+     * @param numChannels The number of channels to prepare for.
+     */
+    ClipDetector (const Options& options, int numChannels);
+
+    JUCE_DECLARE_NON_COPYABLE (ClipDetector)
+    JUCE_DECLARE_NON_MOVEABLE (ClipDetector)
+
+    /**
+     * Prepares for given number of channels, dropping any run in progress. Must not be called while processing.
+     * @param numChannels The number of channels.
+     */
+    void prepareToPlay (int numChannels);
+
+    /**
+     * Changes the clip level and minimum run length. The queue capacity can't be changed. Can be called from any
+     * thread, runs in progress are judged by the new options.
+     * @param options The options.
+     */
+    void setOptions (const Options& options);
+
+    /**
+     * Finds the runs of clipped samples in a block of a channel. Realtime safe.
+     * @tparam SampleType The type of the audio sample.
+     * @param channelIndex The index of the channel. Channels beyond the prepared number of channels are ignored.
+     * @param samples The samples of the channel.
+     * @param numSamples The number of samples.
+     * @param peakLevel The peak level of the samples, which lets blocks without clipping get skipped at once.
+     * @param samplePosition The position of the first sample in the stream. A run which doesn't continue at this
+     * position ends.
+     */
+    template <typename SampleType>
+    void process (
+        int channelIndex,
+        const SampleType* samples,
+        int numSamples,
+        SampleType peakLevel,
+        int64_t samplePosition);
+
+    /**
+     * Takes the oldest clip event.
+     * @param event Receives the event.
+     * @return True if an event was taken, false if there are none.
+     */
+    bool popEvent (Event& event);
+
+    /**
+     * @return The number of clip events which were lost because the queue was full. Can be called from any thread.
+     */
+    [[nodiscard]] uint64_t getNumLostEvents() const;
+
+private:
+    /// The number of samples checked at once for clipping, which the compiler turns into SIMD instructions.
+    static constexpr int kNumLanes = 8;
+
+    /**
+     * The run in progress of a single channel, only accessed by the audio thread.
+     */
+    struct Run
+    {
+        int64_t samplePosition = 0;
+        int64_t length = 0;
+    };
+
+    std::atomic<float> mClipLevel;
+    std::atomic<int> mMinRunLength;
+    std::vector<Run> mRuns;
+    moodycamel::ReaderWriterQueue<Event> mEvents;
+    std::atomic<uint64_t> mNumLostEvents { 0 };
+
+    /**
+     * Ends the run in progress of a channel, reporting it if long enough.
+     */
+    void finishRun (int channelIndex, Run& run);
+
+    /**
+     * @return True if any of the kNumLanes samples starting at given samples is clipped.
+     */
+    template <typename SampleType>
+    static bool isAnyClipped (const SampleType* samples, SampleType clipLevel);
+};
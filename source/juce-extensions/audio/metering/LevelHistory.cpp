@@ -0,0 +1,154 @@
+#include "LevelHistory.h"
+
+LevelHistory::LevelHistory (int const capacity, int const numLevels, int const maxChannels) :
+    Subscriber (LevelMeter::Scale::getDefaultScale(), maxChannels),
+    mCapacity (std::max (2, capacity)),
+    mNumLevels (juce::jlimit (1, 32, numLevels))
+{
+}
+
+rdk::Subscription LevelHistory::addListener (Listener* listener)
+{
+    if (listener == nullptr)
+        return {};
+    return mListeners.add (listener);
+}
+
+int64_t LevelHistory::getNumTicksRecorded() const
+{
+    return mNumTicks;
+}
+
+int64_t LevelHistory::getOldestAvailableTick() const
+{
+    auto const topLevel = mNumLevels - 1;
+    auto const numCompleteEntries = mNumTicks >> topLevel;
+    return std::max (int64_t { 0 }, numCompleteEntries - mCapacity) << topLevel;
+}
+
+void LevelHistory::getMinMaxForPixels (
+    int const channelIndex,
+    int64_t const startTick,
+    int64_t const endTick,
+    MinMax* dest,
+    int const numPixels) const
+{
+    if (dest == nullptr || numPixels <= 0)
+        return;
+
+    std::fill (dest, dest + numPixels, MinMax {});
+
+    if (!juce::isPositiveAndBelow (channelIndex, getNumChannels()) || endTick <= startTick)
+        return;
+
+    auto const ticksPerPixel = static_cast<double> (endTick - startTick) / static_cast<double> (numPixels);
+
+    // Find the coarsest level which still has at least one entry per pixel.
+    int baseLevel = 0;
+    while (baseLevel + 1 < mNumLevels && static_cast<double> (int64_t { 1 } << (baseLevel + 1)) <= ticksPerPixel)
+        ++baseLevel;
+
+    for (int pixel = 0; pixel < numPixels; pixel++)
+    {
+        auto const pixelStart = startTick + static_cast<int64_t> (pixel * ticksPerPixel);
+        auto const pixelEnd = std::max (pixelStart + 1, startTick + static_cast<int64_t> ((pixel + 1) * ticksPerPixel));
+
+        // Older history is only available on coarser levels.
+        auto level = baseLevel;
+        while (level + 1 < mNumLevels &&
+               pixelStart < (std::max (int64_t { 0 }, (mNumTicks >> level) - mCapacity) << level))
+            ++level;
+
+        for (auto entry = pixelStart >> level; entry <= (pixelEnd - 1) >> level; ++entry)
+            dest[pixel].combine (findEntry (level, channelIndex, entry));
+    }
+}
+
+void LevelHistory::clearHistory()
+{
+    std::fill (mHistory.begin(), mHistory.end(), MinMax {});
+    std::fill (mCurrentTick.begin(), mCurrentTick.end(), MinMax {});
+    mNumTicks = 0;
+}
+
+size_t LevelHistory::getEntryIndex (int const level, int const channelIndex, int64_t const entryIndex) const
+{
+    auto const row = static_cast<size_t> (level * getNumChannels() + channelIndex);
+    return row * static_cast<size_t> (mCapacity) + static_cast<size_t> (entryIndex % mCapacity);
+}
+
+LevelHistory::MinMax LevelHistory::findEntry (int const level, int const channelIndex, int64_t const entryIndex) const
+{
+    if (entryIndex < 0 || (entryIndex << level) >= mNumTicks)
+        return {}; // Not recorded (yet).
+
+    auto const numCompleteEntries = mNumTicks >> level;
+
+    if (entryIndex < numCompleteEntries)
+    {
+        if (entryIndex < numCompleteEntries - mCapacity)
+            return {}; // No longer available at this level.
+
+        return mHistory[getEntryIndex (level, channelIndex, entryIndex)];
+    }
+
+    // The entry is still being filled, combine the finer levels which make up the entry so far.
+    MinMax result;
+    result.combine (findEntry (level - 1, channelIndex, entryIndex * 2));
+    result.combine (findEntry (level - 1, channelIndex, entryIndex * 2 + 1));
+    return result;
+}
+
+void LevelHistory::updateWithMeasurement (const LevelMeter::Measurement& measurement)
+{
+    auto const channelIndex = getChannelIndexForMeasurement (measurement);
+    if (channelIndex < 0)
+        return;
+
+    auto const peakLevel = static_cast<float> (measurement.peakLevel);
+    mCurrentTick[static_cast<size_t> (channelIndex)].combine ({ peakLevel, peakLevel, true });
+}
+
+void LevelHistory::measurementUpdatesFinished()
+{
+    // A reset isn't a tick, it would add a stretch of silence which never happened.
+    if (isResetting())
+        return;
+
+    auto const numChannels = getNumChannels();
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        // A tick without any measurements is recorded as silence.
+        auto& current = mCurrentTick[static_cast<size_t> (ch)];
+        mHistory[getEntryIndex (0, ch, mNumTicks)] = current.isValid ? current : MinMax { 0.0f, 0.0f, true };
+        current = {};
+    }
+
+    ++mNumTicks;
+
+    // Every time an entry of a level completes, combine it with its sibling into the level above.
+    for (int level = 1; level < mNumLevels && mNumTicks % (int64_t { 1 } << level) == 0; level++)
+    {
+        auto const entryIndex = (mNumTicks >> level) - 1;
+
+        for (int ch = 0; ch < numChannels; ch++)
+        {
+            MinMax entry;
+            entry.combine (mHistory[getEntryIndex (level - 1, ch, entryIndex * 2)]);
+            entry.combine (mHistory[getEntryIndex (level - 1, ch, entryIndex * 2 + 1)]);
+            mHistory[getEntryIndex (level, ch, entryIndex)] = entry;
+        }
+    }
+
+    mListeners.call ([] (Listener& l) {
+        l.levelHistoryUpdated();
+    });
+}
+
+void LevelHistory::levelMeterPrepared (int const numChannels)
+{
+    mHistory.assign (static_cast<size_t> (mCapacity) * static_cast<size_t> (mNumLevels * numChannels), MinMax {});
+    mCurrentTick.assign (static_cast<size_t> (numChannels), MinMax {});
+    mNumTicks = 0;
+}
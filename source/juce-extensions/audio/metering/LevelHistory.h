@@ -0,0 +1,150 @@
+#pragma once
+
+#include "LevelMeter.h"
+
+#include <vector>
+
+/**
+ * Subscriber which records the peak level of every channel for every timer tick of the level meter, allowing a
+ * scrolling level history or an overview to be drawn afterwards.
+ *
+ * The history is stored as a min/max pyramid: level 0 holds an entry per tick, and every next level holds entries which
+ * combine two entries of the level below. Each level is a ring buffer with the same capacity, so the coarser levels
+ * reach further back in time while memory stays bounded. Reading a range for a number of pixels picks the level which
+ * matches the zoom level, which makes the cost proportional to the number of pixels and not to the length of the range.
+ *
+ * All methods must be called from the message thread.
+ */
+class LevelHistory : public LevelMeter::Subscriber
+{
+public:
+    static constexpr int kDefaultCapacity = 4096;
+    static constexpr int kDefaultNumLevels = 8;
+
+    /**
+     * The lowest and highest peak level within a period of time.
+     */
+    struct MinMax
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+        bool isValid = false;
+
+        /**
+         * Combines this value with given value.
+         * @param other The value to combine with.
+         */
+        void combine (const MinMax& other)
+        {
+            if (!other.isValid)
+                return;
+
+            min = isValid ? std::min (min, other.min) : other.min;
+            max = isValid ? std::max (max, other.max) : other.max;
+            isValid = true;
+        }
+    };
+
+    /**
+     * Baseclass for classes which want to get notified when new data was recorded.
+     */
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        /**
+         * Called after a new tick has been recorded.
+         */
+        virtual void levelHistoryUpdated() = 0;
+    };
+
+    /// Expose as public members
+    using LevelMeter::Subscriber::subscribeToLevelMeter;
+    using LevelMeter::Subscriber::unsubscribeFromLevelMeter;
+
+    /**
+     * Constructor. The memory used equals capacity * numLevels * numChannels * sizeof (MinMax).
+     * @param capacity The number of entries each level of the pyramid holds. Level 0 holds capacity ticks of history.
+     * @param numLevels The number of levels of the pyramid. The top level holds capacity * 2^(numLevels - 1) ticks.
+     * @param maxChannels The max number of channels to record. If a meter has more channels then all channels will be
+     * folded into a single mono channel.
+     */
+    explicit LevelHistory (
+        int capacity = kDefaultCapacity,
+        int numLevels = kDefaultNumLevels,
+        int maxChannels = kDefaultMaxChannels);
+
+    /**
+     * Adds a listener which gets notified when new data was recorded.
+     * @param listener The listener to add.
+     * @return A subscription which will keep the listener registered until it is destroyed.
+     */
+    rdk::Subscription addListener (Listener* listener);
+
+    /**
+     * @return The number of ticks recorded since the level meter was prepared.
+     */
+    [[nodiscard]] int64_t getNumTicksRecorded() const;
+
+    /**
+     * @return The number of ticks which are recorded per second.
+     */
+    [[nodiscard]] static constexpr int getTicksPerSecond()
+    {
+        return LevelMeterConstants::kRefreshRateHz;
+    }
+
+    /**
+     * @return The oldest tick which is still available in the history.
+     */
+    [[nodiscard]] int64_t getOldestAvailableTick() const;
+
+    /**
+     * Fills dest with the min/max peak levels of given channel for the ticks in range [startTick, endTick), divided
+     * over numPixels. Pixels for which no history is available will be marked invalid.
+     * @param channelIndex The channel to read.
+     * @param startTick The first tick (inclusive).
+     * @param endTick The last tick (exclusive).
+     * @param dest The destination, which must hold at least numPixels values.
+     * @param numPixels The number of pixels to divide the range over.
+     */
+    void getMinMaxForPixels (int channelIndex, int64_t startTick, int64_t endTick, MinMax* dest, int numPixels) const;
+
+    /**
+     * Clears the recorded history.
+     */
+    void clearHistory();
+
+    using LevelMeter::Subscriber::getNumChannels;
+    using LevelMeter::Subscriber::getScale;
+
+private:
+    int mCapacity = kDefaultCapacity;
+    int mNumLevels = kDefaultNumLevels;
+    int64_t mNumTicks = 0;
+
+    /// The pyramid, stored per level, per channel.
+    std::vector<MinMax> mHistory;
+
+    /// Aggregates the measurements of the current tick.
+    std::vector<MinMax> mCurrentTick;
+
+    rdk::SubscriberList<Listener> mListeners;
+
+    /**
+     * @return The index into mHistory for given level, channel and entry index.
+     */
+    [[nodiscard]] size_t getEntryIndex (int level, int channelIndex, int64_t entryIndex) const;
+
+    /**
+     * Finds the min/max value of a single entry, combining finer levels for entries which are not complete yet.
+     * @return The min/max value, which is invalid if the entry is not available.
+     */
+    [[nodiscard]] MinMax findEntry (int level, int channelIndex, int64_t entryIndex) const;
+
+    // MARK: LevelMeter::Subscriber overrides -
+    void updateWithMeasurement (const LevelMeter::Measurement& measurement) override;
+    void measurementUpdatesFinished() override;
+    void levelMeterPrepared (int numChannels) override;
+};
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <juce_core/juce_core.h>
+
+/**
+ * The layout of level log files, as written by LevelLogWriter and read by LevelLogReader.
+ *
+ * A file starts with a header of kFileHeaderSize bytes, followed by blocks of equal size which each hold
+ * recordsPerBlock records (a multiple of 8). A block starts with the time of its first and last record and its number
+ * of records, followed by a column with the time of every record (as an offset in milliseconds from the first record),
+ * followed by one column of quantised levels per channel, followed by one column of overload bits per channel. Since
+ * all blocks have the same size, a block can be found by its index without an index table, and the block times allow
+ * finding a time by binary search. The times of the records never decrease, also when the system clock gets adjusted.
+ *
+ * Levels are quantised to a single byte in steps of kStepDb, starting at kMinimumDb (which stands for anything at or
+ * below it). All values are stored little endian.
+ */
+class LevelLogFormat
+{
+public:
+    /// "JXLL", identifies level log files.
+    static constexpr uint32_t kMagic = 0x4c4c584a;
+    static constexpr uint32_t kVersion = 2;
+
+    static constexpr int kFileHeaderSize = 64;
+    static constexpr int kBlockHeaderSize = 24;
+    static constexpr int kRecordTimeSize = 4;
+
+    static constexpr double kMinimumDb = -120.0;
+    static constexpr double kStepDb = 0.5;
+
+    /**
+     * The fields of the file header.
+     */
+    struct FileHeader
+    {
+        uint32_t magic = kMagic;
+        uint32_t version = kVersion;
+        uint32_t numChannels = 0;
+        uint32_t recordsPerBlock = 0;
+        double recordsPerSecond = 0.0; ///< The nominal record rate, the block times are leading.
+    };
+
+    /**
+     * The fields of a block header.
+     */
+    struct BlockHeader
+    {
+        int64_t firstTimeMs = 0; ///< The time of the first record, in milliseconds since the epoch.
+        int64_t lastTimeMs = 0;  ///< The time of the last record, in milliseconds since the epoch.
+        uint32_t numRecords = 0; ///< The number of records, 0 for an unused block.
+    };
+
+    /**
+     * @return The size of a block in bytes.
+     */
+    static size_t getBlockSize (int numChannels, int recordsPerBlock)
+    {
+        return getLevelColumnOffset (0, recordsPerBlock)
+               + static_cast<size_t> (numChannels) * getColumnsSizePerChannel (recordsPerBlock);
+    }
+
+    /**
+     * @return The offset within a file of given block.
+     */
+    static int64_t getBlockOffset (int64_t blockIndex, int numChannels, int recordsPerBlock)
+    {
+        return kFileHeaderSize + blockIndex * static_cast<int64_t> (getBlockSize (numChannels, recordsPerBlock));
+    }
+
+    /**
+     * @return The offset within a block of the time of given record.
+     */
+    static size_t getRecordTimeOffset (int record)
+    {
+        return kBlockHeaderSize + static_cast<size_t> (record) * kRecordTimeSize;
+    }
+
+    /**
+     * @return The offset within a block of the level column of given channel.
+     */
+    static size_t getLevelColumnOffset (int channelIndex, int recordsPerBlock)
+    {
+        return getRecordTimeOffset (recordsPerBlock)
+               + static_cast<size_t> (channelIndex) * static_cast<size_t> (recordsPerBlock);
+    }
+
+    /**
+     * @return The offset within a block of the overload column of given channel.
+     */
+    static size_t getOverloadColumnOffset (int channelIndex, int numChannels, int recordsPerBlock)
+    {
+        return getLevelColumnOffset (numChannels, recordsPerBlock)
+               + static_cast<size_t> (channelIndex) * static_cast<size_t> (recordsPerBlock / 8);
+    }
+
+    /**
+     * @param level The level as gain.
+     * @return The quantised level.
+     */
+    static uint8_t encodeLevel (double level)
+    {
+        if (level <= 0.0)
+            return 0;
+
+        auto const steps = std::round ((20.0 * std::log10 (level) - kMinimumDb) / kStepDb);
+        return static_cast<uint8_t> (juce::jlimit (0.0, 255.0, steps));
+    }
+
+    /**
+     * @param quantisedLevel The quantised level.
+     * @return The level in decibels.
+     */
+    static double decodeLevelDb (uint8_t quantisedLevel)
+    {
+        return kMinimumDb + kStepDb * quantisedLevel;
+    }
+
+    /**
+     * Writes a file header to dest, which must hold kFileHeaderSize bytes.
+     */
+    static void writeFileHeader (uint8_t* dest, const FileHeader& header)
+    {
+        std::memset (dest, 0, kFileHeaderSize);
+        writeValue (dest, header.magic);
+        writeValue (dest + 4, header.version);
+        writeValue (dest + 8, header.numChannels);
+        writeValue (dest + 12, header.recordsPerBlock);
+        writeValue (dest + 16, header.recordsPerSecond);
+    }
+
+    /**
+     * Reads a file header from source, which must hold kFileHeaderSize bytes.
+     */
+    static FileHeader readFileHeader (const uint8_t* source)
+    {
+        FileHeader header;
+        header.magic = readValue<uint32_t> (source);
+        header.version = readValue<uint32_t> (source + 4);
+        header.numChannels = readValue<uint32_t> (source + 8);
+        header.recordsPerBlock = readValue<uint32_t> (source + 12);
+        header.recordsPerSecond = readValue<double> (source + 16);
+        return header;
+    }
+
+    /**
+     * Writes a block header to dest, which must hold kBlockHeaderSize bytes.
+     */
+    static void writeBlockHeader (uint8_t* dest, const BlockHeader& header)
+    {
+        writeValue (dest, header.firstTimeMs);
+        writeValue (dest + 8, header.lastTimeMs);
+        writeValue (dest + 16, header.numRecords);
+        writeValue (dest + 20, uint32_t { 0 });
+    }
+
+    /**
+     * Writes the time of a record into a block.
+     * @param block The block.
+     * @param record The index of the record within the block.
+     * @param offsetMs The time of the record, in milliseconds since the first record of the block.
+     */
+    static void writeRecordTime (uint8_t* block, int record, uint32_t offsetMs)
+    {
+        writeValue (block + getRecordTimeOffset (record), offsetMs);
+    }
+
+    /**
+     * Reads the time of a record from a block.
+     * @param block The block.
+     * @param record The index of the record within the block.
+     * @return The time of the record, in milliseconds since the first record of the block.
+     */
+    static uint32_t readRecordTime (const uint8_t* block, int record)
+    {
+        return readValue<uint32_t> (block + getRecordTimeOffset (record));
+    }
+
+    /**
+     * Reads a block header from source, which must hold kBlockHeaderSize bytes.
+     */
+    static BlockHeader readBlockHeader (const uint8_t* source)
+    {
+        BlockHeader header;
+        header.firstTimeMs = readValue<int64_t> (source);
+        header.lastTimeMs = readValue<int64_t> (source + 8);
+        header.numRecords = readValue<uint32_t> (source + 16);
+        return header;
+    }
+
+private:
+    static size_t getColumnsSizePerChannel (int recordsPerBlock)
+    {
+        return static_cast<size_t> (recordsPerBlock + recordsPerBlock / 8);
+    }
+
+    template <typename T>
+    static void writeValue (uint8_t* dest, T value)
+    {
+        value = juce::ByteOrder::swapIfBigEndian (value);
+        std::memcpy (dest, &value, sizeof (T));
+    }
+
+    template <typename T>
+    static T readValue (const uint8_t* source)
+    {
+        T value;
+        std::memcpy (&value, source, sizeof (T));
+        return juce::ByteOrder::swapIfBigEndian (value);
+    }
+};
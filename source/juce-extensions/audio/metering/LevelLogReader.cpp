@@ -0,0 +1,195 @@
+#include "LevelLogReader.h"
+
+LevelLogReader::LevelLogReader (const juce::File& file) : mFile (file)
+{
+    reload();
+}
+
+bool LevelLogReader::reload()
+{
+    mHeader = {};
+    mBlockSize = 0;
+    mNumBlocks = 0;
+    mNumRecords = 0;
+    mMappedFile = std::make_unique<juce::MemoryMappedFile> (mFile, juce::MemoryMappedFile::readOnly);
+
+    auto const size = static_cast<int64_t> (mMappedFile->getSize());
+    if (mMappedFile->getData() == nullptr || size < LevelLogFormat::kFileHeaderSize)
+    {
+        mMappedFile.reset();
+        return false;
+    }
+
+    auto const header = LevelLogFormat::readFileHeader (static_cast<const uint8_t*> (mMappedFile->getData()));
+
+    if (header.magic != LevelLogFormat::kMagic || header.version != LevelLogFormat::kVersion
+        || header.numChannels == 0 || header.recordsPerBlock == 0 || header.recordsPerBlock % 8 != 0)
+    {
+        mMappedFile.reset();
+        return false;
+    }
+
+    mHeader = header;
+    mBlockSize = LevelLogFormat::getBlockSize (
+        static_cast<int> (header.numChannels),
+        static_cast<int> (header.recordsPerBlock));
+
+    // The used blocks come first, followed by the blocks the writer allocated in advance.
+    int64_t low = 0;
+    int64_t high = (size - LevelLogFormat::kFileHeaderSize) / static_cast<int64_t> (mBlockSize);
+
+    while (low < high)
+    {
+        auto const mid = low + (high - low) / 2;
+
+        if (LevelLogFormat::readBlockHeader (getBlock (mid)).numRecords > 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    mNumBlocks = low;
+
+    if (mNumBlocks > 0)
+    {
+        auto const lastBlockHeader = LevelLogFormat::readBlockHeader (getBlock (mNumBlocks - 1));
+        mNumRecords = (mNumBlocks - 1) * header.recordsPerBlock + lastBlockHeader.numRecords;
+    }
+
+    return true;
+}
+
+bool LevelLogReader::isValid() const
+{
+    return mMappedFile != nullptr;
+}
+
+int LevelLogReader::getNumChannels() const
+{
+    return static_cast<int> (mHeader.numChannels);
+}
+
+double LevelLogReader::getRecordsPerSecond() const
+{
+    return mHeader.recordsPerSecond;
+}
+
+int64_t LevelLogReader::getNumRecords() const
+{
+    return mNumRecords;
+}
+
+int64_t LevelLogReader::getStartTimeMs() const
+{
+    if (mNumBlocks == 0)
+        return 0;
+    return LevelLogFormat::readBlockHeader (getBlock (0)).firstTimeMs;
+}
+
+int64_t LevelLogReader::getEndTimeMs() const
+{
+    if (mNumBlocks == 0)
+        return 0;
+    return LevelLogFormat::readBlockHeader (getBlock (mNumBlocks - 1)).lastTimeMs;
+}
+
+int64_t LevelLogReader::findRecord (int64_t const timeMs) const
+{
+    // Find the first block which ends at or after given time.
+    int64_t low = 0;
+    int64_t high = mNumBlocks;
+
+    while (low < high)
+    {
+        auto const mid = low + (high - low) / 2;
+
+        if (LevelLogFormat::readBlockHeader (getBlock (mid)).lastTimeMs < timeMs)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low == mNumBlocks)
+        return mNumRecords;
+
+    auto const* block = getBlock (low);
+    auto const blockHeader = LevelLogFormat::readBlockHeader (block);
+    int recordLow = 0;
+    auto recordHigh = static_cast<int> (blockHeader.numRecords);
+
+    while (recordLow < recordHigh)
+    {
+        auto const mid = recordLow + (recordHigh - recordLow) / 2;
+
+        if (getRecordTime (block, blockHeader, mid) < timeMs)
+            recordLow = mid + 1;
+        else
+            recordHigh = mid;
+    }
+
+    return low * mHeader.recordsPerBlock + recordLow;
+}
+
+LevelLogReader::Entry LevelLogReader::getEntry (int const channelIndex, int64_t const recordIndex) const
+{
+    if (!juce::isPositiveAndBelow (channelIndex, getNumChannels()))
+        return {};
+    if (!juce::isPositiveAndBelow (recordIndex, mNumRecords))
+        return {};
+
+    auto const recordsPerBlock = static_cast<int> (mHeader.recordsPerBlock);
+    auto const* block = getBlock (recordIndex / recordsPerBlock);
+    auto const blockHeader = LevelLogFormat::readBlockHeader (block);
+    auto const record = static_cast<int> (recordIndex % recordsPerBlock);
+
+    auto const levelOffset = LevelLogFormat::getLevelColumnOffset (channelIndex, recordsPerBlock);
+    auto const overloadOffset =
+        LevelLogFormat::getOverloadColumnOffset (channelIndex, getNumChannels(), recordsPerBlock);
+
+    auto const level = block[levelOffset + static_cast<size_t> (record)];
+    auto const overloads = block[overloadOffset + static_cast<size_t> (record / 8)];
+
+    return {
+        getRecordTime (block, blockHeader, record),
+        LevelLogFormat::decodeLevelDb (level),
+        (overloads & (1 << (record % 8))) != 0,
+    };
+}
+
+void LevelLogReader::read (
+    int const channelIndex,
+    int64_t const startTimeMs,
+    int64_t const endTimeMs,
+    std::vector<Entry>& dest) const
+{
+    dest.clear();
+
+    if (!juce::isPositiveAndBelow (channelIndex, getNumChannels()))
+        return;
+
+    for (auto recordIndex = findRecord (startTimeMs); recordIndex < mNumRecords; recordIndex++)
+    {
+        auto const entry = getEntry (channelIndex, recordIndex);
+        if (entry.timeMs >= endTimeMs)
+            break;
+
+        dest.push_back (entry);
+    }
+}
+
+const uint8_t* LevelLogReader::getBlock (int64_t const blockIndex) const
+{
+    auto const offset = LevelLogFormat::getBlockOffset (
+        blockIndex,
+        static_cast<int> (mHeader.numChannels),
+        static_cast<int> (mHeader.recordsPerBlock));
+    return static_cast<const uint8_t*> (mMappedFile->getData()) + offset;
+}
+
+int64_t LevelLogReader::getRecordTime (
+    const uint8_t* const block,
+    const LevelLogFormat::BlockHeader& blockHeader,
+    int const record)
+{
+    return blockHeader.firstTimeMs + static_cast<int64_t> (LevelLogFormat::readRecordTime (block, record));
+}
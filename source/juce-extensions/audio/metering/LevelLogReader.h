@@ -0,0 +1,116 @@
+#pragma once
+
+#include "LevelLogFormat.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * Reads level log files written by LevelLogWriter. The file is memory-mapped, and finding a time takes a binary search
+ * over the block headers, so reading a time range doesn't depend on the length of the log.
+ *
+ * The reader reflects the file as it was when opened. A log which is still being written can be read, use reload() to
+ * pick up the records written since.
+ */
+class LevelLogReader
+{
+public:
+    /**
+     * A logged value of a single channel.
+     */
+    struct Entry
+    {
+        int64_t timeMs = 0;       ///< The time of the record, in milliseconds since the epoch.
+        double peakLevelDb = 0.0; ///< The highest peak level during the record (see LevelLogFormat::kMinimumDb).
+        bool overloaded = false;  ///< True if the signal overloaded during the record.
+    };
+
+    /**
+     * Constructor.
+     * @param file The log file to read.
+     */
+    explicit LevelLogReader (const juce::File& file);
+
+    JUCE_DECLARE_NON_COPYABLE (LevelLogReader)
+    JUCE_DECLARE_NON_MOVEABLE (LevelLogReader)
+
+    /**
+     * Maps the file again, to pick up the records written since opening it.
+     * @return True if the file is a valid level log.
+     */
+    bool reload();
+
+    /**
+     * @return True if the file is a valid level log.
+     */
+    [[nodiscard]] bool isValid() const;
+
+    /**
+     * @return The number of channels logged.
+     */
+    [[nodiscard]] int getNumChannels() const;
+
+    /**
+     * @return The nominal number of records per second.
+     */
+    [[nodiscard]] double getRecordsPerSecond() const;
+
+    /**
+     * @return The number of records in the log.
+     */
+    [[nodiscard]] int64_t getNumRecords() const;
+
+    /**
+     * @return The time of the first record, in milliseconds since the epoch.
+     */
+    [[nodiscard]] int64_t getStartTimeMs() const;
+
+    /**
+     * @return The time of the last record, in milliseconds since the epoch.
+     */
+    [[nodiscard]] int64_t getEndTimeMs() const;
+
+    /**
+     * Finds the first record at or after given time.
+     * @param timeMs The time in milliseconds since the epoch.
+     * @return The index of the record, which equals getNumRecords() if all records are before given time.
+     */
+    [[nodiscard]] int64_t findRecord (int64_t timeMs) const;
+
+    /**
+     * @param channelIndex The index of the channel.
+     * @param recordIndex The index of the record.
+     * @return The entry of given channel and record, or a default entry if either doesn't exist.
+     */
+    [[nodiscard]] Entry getEntry (int channelIndex, int64_t recordIndex) const;
+
+    /**
+     * Reads the entries of a channel within a time range.
+     * @param channelIndex The index of the channel.
+     * @param startTimeMs The start of the range (inclusive).
+     * @param endTimeMs The end of the range (exclusive).
+     * @param dest Receives the entries, replacing its contents.
+     */
+    void read (int channelIndex, int64_t startTimeMs, int64_t endTimeMs, std::vector<Entry>& dest) const;
+
+private:
+    juce::File mFile;
+    std::unique_ptr<juce::MemoryMappedFile> mMappedFile;
+    LevelLogFormat::FileHeader mHeader;
+    size_t mBlockSize = 0;
+    int64_t mNumBlocks = 0;
+    int64_t mNumRecords = 0;
+
+    /**
+     * @return A pointer to the start of given block.
+     */
+    [[nodiscard]] const uint8_t* getBlock (int64_t blockIndex) const;
+
+    /**
+     * @return The time of given record within given block, in milliseconds since the epoch.
+     */
+    [[nodiscard]] static int64_t getRecordTime (
+        const uint8_t* block,
+        const LevelLogFormat::BlockHeader& blockHeader,
+        int record);
+};
@@ -0,0 +1,324 @@
+#include "LevelLogWriter.h"
+
+/**
+ * Writes blocks into the log file, through a memory mapping which grows with the file.
+ */
+class LevelLogWriter::WriterThread : public juce::Thread
+{
+public:
+    /**
+     * A block to write, which replaces any earlier version of the same block.
+     */
+    struct PendingBlock
+    {
+        int64_t blockIndex = 0;
+        std::vector<uint8_t> data;
+    };
+
+    WriterThread (const juce::File& file, const LevelLogFormat::FileHeader& header, int const blocksPerAllocation) :
+        Thread ("LevelLogWriter"),
+        mFile (file),
+        mHeader (header),
+        mBlockSize (LevelLogFormat::getBlockSize (
+            static_cast<int> (header.numChannels),
+            static_cast<int> (header.recordsPerBlock))),
+        mBlocksPerAllocation (std::max (1, blocksPerAllocation))
+    {
+        startThread (Priority::background);
+    }
+
+    ~WriterThread() override
+    {
+        // Finishes writing the pending blocks before exiting.
+        signalThreadShouldExit();
+        notify();
+        stopThread (10000);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (WriterThread)
+    JUCE_DECLARE_NON_MOVEABLE (WriterThread)
+
+    /**
+     * Queues a block for writing. Only to be called from the message thread.
+     */
+    void write (PendingBlock&& block)
+    {
+        mPendingBlocks.enqueue (std::move (block));
+        notify();
+    }
+
+    [[nodiscard]] bool hasFailed() const
+    {
+        return mFailed.load (std::memory_order_relaxed);
+    }
+
+private:
+    juce::File mFile;
+    LevelLogFormat::FileHeader mHeader;
+    size_t mBlockSize = 0;
+    int mBlocksPerAllocation = 1;
+
+    moodycamel::ReaderWriterQueue<PendingBlock> mPendingBlocks { 16 };
+    std::atomic<bool> mFailed { false };
+
+    std::unique_ptr<juce::FileOutputStream> mStream;
+    std::unique_ptr<juce::MemoryMappedFile> mMappedFile;
+
+    /// The end of the part of the file which is allocated (and mapped).
+    int64_t mAllocatedEnd = 0;
+
+    /// The end of the part of the file which holds blocks.
+    int64_t mUsedEnd = 0;
+
+    void run() override
+    {
+        open();
+
+        while (!threadShouldExit())
+        {
+            writePendingBlocks();
+            wait (-1);
+        }
+
+        writePendingBlocks();
+        close();
+    }
+
+    void open()
+    {
+        // Output streams append to existing files.
+        mFile.deleteFile();
+        mStream = mFile.createOutputStream();
+
+        if (mStream == nullptr || !mStream->openedOk())
+        {
+            fail();
+            return;
+        }
+
+        uint8_t header[LevelLogFormat::kFileHeaderSize];
+        LevelLogFormat::writeFileHeader (header, mHeader);
+
+        if (!mStream->write (header, sizeof (header)))
+        {
+            fail();
+            return;
+        }
+
+        mStream->flush();
+        mAllocatedEnd = mUsedEnd = LevelLogFormat::kFileHeaderSize;
+    }
+
+    void close()
+    {
+        mMappedFile.reset();
+
+        // Remove the allocated blocks which never got used.
+        if (mStream != nullptr && mStream->setPosition (mUsedEnd))
+            mStream->truncate();
+
+        mStream.reset();
+    }
+
+    void fail()
+    {
+        mFailed.store (true, std::memory_order_relaxed);
+        mMappedFile.reset();
+        mStream.reset();
+    }
+
+    void writePendingBlocks()
+    {
+        PendingBlock block;
+
+        while (mPendingBlocks.try_dequeue (block))
+        {
+            if (hasFailed() || block.data.size() != mBlockSize)
+                continue;
+
+            auto const offset = LevelLogFormat::getBlockOffset (
+                block.blockIndex,
+                static_cast<int> (mHeader.numChannels),
+                static_cast<int> (mHeader.recordsPerBlock));
+            auto const end = offset + static_cast<int64_t> (mBlockSize);
+
+            if (end > mAllocatedEnd && !allocate (end))
+            {
+                fail();
+                continue;
+            }
+
+            auto* mappedData = static_cast<uint8_t*> (mMappedFile->getData());
+            std::memcpy (mappedData + (offset - mMappedFile->getRange().getStart()), block.data.data(), mBlockSize);
+            mUsedEnd = std::max (mUsedEnd, end);
+        }
+    }
+
+    /**
+     * Grows the file to at least given size and maps it.
+     */
+    bool allocate (int64_t const minimumEnd)
+    {
+        auto const newEnd =
+            std::max (minimumEnd, mAllocatedEnd + mBlocksPerAllocation * static_cast<int64_t> (mBlockSize));
+
+        // The file can't grow while mapped.
+        mMappedFile.reset();
+
+        if (!mStream->setPosition (mAllocatedEnd))
+            return false;
+        if (!mStream->writeRepeatedByte (0, static_cast<size_t> (newEnd - mAllocatedEnd)))
+            return false;
+
+        mStream->flush();
+        mAllocatedEnd = newEnd;
+
+        mMappedFile = std::make_unique<juce::MemoryMappedFile> (
+            mFile,
+            juce::Range<juce::int64> (0, newEnd),
+            juce::MemoryMappedFile::readWrite);
+
+        return mMappedFile->getData() != nullptr && mMappedFile->getRange().getEnd() >= newEnd;
+    }
+};
+
+LevelLogWriter::Options LevelLogWriter::Options::getDefault()
+{
+    return {};
+}
+
+LevelLogWriter::LevelLogWriter (const juce::File& file, const Options& options, int const maxChannels) :
+    Subscriber (LevelMeter::Scale::getDefaultScale(), maxChannels),
+    mFile (file),
+    mOptions (options)
+{
+    mOptions.ticksPerRecord = std::max (1, mOptions.ticksPerRecord);
+    mOptions.recordsPerBlock = (std::max (8, mOptions.recordsPerBlock) + 7) / 8 * 8;
+    mOptions.flushIntervalRecords = std::max (1, mOptions.flushIntervalRecords);
+}
+
+LevelLogWriter::~LevelLogWriter()
+{
+    if (mWriterThread == nullptr)
+        return;
+
+    if (mNumTicksInRecord > 0)
+        appendRecord();
+
+    if (mBlockHeader.numRecords > 0)
+        flushBlock();
+
+    mWriterThread.reset();
+}
+
+int64_t LevelLogWriter::getNumRecords() const
+{
+    return mBlockIndex * mOptions.recordsPerBlock + mBlockHeader.numRecords;
+}
+
+bool LevelLogWriter::hasFailed() const
+{
+    return mWriterThread != nullptr && mWriterThread->hasFailed();
+}
+
+void LevelLogWriter::appendRecord()
+{
+    auto const record = static_cast<int> (mBlockHeader.numRecords);
+    auto const now = mStartTimeMs
+                     + static_cast<int64_t> (juce::Time::getMillisecondCounterHiRes() - mStartCounterMs);
+
+    // Every record has a time of its own, since ticks get delayed when the message thread stalls.
+    if (record == 0)
+        mBlockHeader.firstTimeMs = now;
+    mBlockHeader.lastTimeMs = now;
+
+    auto const offsetMs = std::min<int64_t> (now - mBlockHeader.firstTimeMs, std::numeric_limits<uint32_t>::max());
+    LevelLogFormat::writeRecordTime (mBlock.data(), record, static_cast<uint32_t> (offsetMs));
+
+    for (int ch = 0; ch < mNumFileChannels; ch++)
+    {
+        // Channels the level meter doesn't have (anymore) are logged as silence.
+        auto const index = static_cast<size_t> (ch);
+        auto const hasChannel = index < mRecordPeakLevels.size();
+
+        mBlock[LevelLogFormat::getLevelColumnOffset (ch, mOptions.recordsPerBlock) + static_cast<size_t> (record)] =
+            LevelLogFormat::encodeLevel (hasChannel ? mRecordPeakLevels[index] : 0.0);
+
+        if (hasChannel && mRecordOverloads[index])
+        {
+            auto const columnOffset =
+                LevelLogFormat::getOverloadColumnOffset (ch, mNumFileChannels, mOptions.recordsPerBlock);
+            mBlock[columnOffset + static_cast<size_t> (record / 8)] |= static_cast<uint8_t> (1 << (record % 8));
+        }
+    }
+
+    std::fill (mRecordPeakLevels.begin(), mRecordPeakLevels.end(), 0.0);
+    std::fill (mRecordOverloads.begin(), mRecordOverloads.end(), false);
+    mNumTicksInRecord = 0;
+
+    mBlockHeader.numRecords++;
+    LevelLogFormat::writeBlockHeader (mBlock.data(), mBlockHeader);
+
+    if (static_cast<int> (mBlockHeader.numRecords) == mOptions.recordsPerBlock)
+    {
+        flushBlock();
+
+        mBlockIndex++;
+        mBlockHeader = {};
+        std::fill (mBlock.begin(), mBlock.end(), uint8_t { 0 });
+    }
+    else if (++mNumRecordsSinceFlush >= mOptions.flushIntervalRecords)
+    {
+        flushBlock();
+    }
+}
+
+void LevelLogWriter::flushBlock()
+{
+    mWriterThread->write ({ mBlockIndex, mBlock });
+    mNumRecordsSinceFlush = 0;
+}
+
+void LevelLogWriter::updateWithMeasurement (const LevelMeter::Measurement& measurement)
+{
+    auto const channelIndex = static_cast<size_t> (getChannelIndexForMeasurement (measurement));
+    if (channelIndex >= mRecordPeakLevels.size())
+        return;
+
+    mRecordPeakLevels[channelIndex] = std::max (mRecordPeakLevels[channelIndex], measurement.peakLevel);
+
+    if (measurement.peakLevel >= LevelMeterConstants::kOverloadTriggerLevel)
+        mRecordOverloads[channelIndex] = true;
+}
+
+void LevelLogWriter::measurementUpdatesFinished()
+{
+    // A reset isn't a tick, so it doesn't count towards the ticks of a record.
+    if (mWriterThread == nullptr || isResetting())
+        return;
+
+    if (++mNumTicksInRecord >= mOptions.ticksPerRecord)
+        appendRecord();
+}
+
+void LevelLogWriter::levelMeterPrepared (int const numChannels)
+{
+    mRecordPeakLevels.assign (static_cast<size_t> (numChannels), 0.0);
+    mRecordOverloads.assign (static_cast<size_t> (numChannels), false);
+    mNumTicksInRecord = 0;
+
+    // The layout of the file is fixed once created.
+    if (mWriterThread != nullptr || numChannels <= 0)
+        return;
+
+    LevelLogFormat::FileHeader header;
+    header.numChannels = static_cast<uint32_t> (numChannels);
+    header.recordsPerBlock = static_cast<uint32_t> (mOptions.recordsPerBlock);
+    header.recordsPerSecond = LevelMeterConstants::kRefreshRateHz / static_cast<double> (mOptions.ticksPerRecord);
+
+    mNumFileChannels = numChannels;
+    mStartTimeMs = juce::Time::currentTimeMillis();
+    mStartCounterMs = juce::Time::getMillisecondCounterHiRes();
+    mBlock.assign (LevelLogFormat::getBlockSize (numChannels, mOptions.recordsPerBlock), 0);
+    mWriterThread = std::make_unique<WriterThread> (mFile, header, mOptions.blocksPerAllocation);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "LevelLogFormat.h"
+#include "LevelMeter.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * Subscriber which logs the peak level and overload state of every channel to a file, for keeping level logs over
+ * long periods of time (see LevelLogFormat for the layout and LevelLogReader for reading it back).
+ *
+ * Every record holds the highest peak level and whether any overload occurred during a number of ticks. Records are
+ * collected into blocks on the message thread, which is cheap; a background thread writes the blocks into the file
+ * through a memory mapping, so file IO never stalls the message thread. The block being filled is written periodically
+ * as well, so a crash loses at most the last flush interval.
+ *
+ * Every record gets the time it was appended. The times count from the wall clock time when the file was created, but
+ * follow a monotonic clock from there, so they never jump when the system clock gets adjusted.
+ *
+ * The channel layout of the file is fixed by the first time the level meter gets prepared. When the level meter gets
+ * prepared for another number of channels later on, extra channels are dropped and missing channels are logged as
+ * silence. An existing file gets replaced.
+ */
+class LevelLogWriter : public LevelMeter::Subscriber
+{
+public:
+    /**
+     * Options to configure the writer.
+     */
+    struct Options
+    {
+        /// The number of level meter ticks combined into a single record.
+        int ticksPerRecord = 3;
+
+        /// The number of records per block, which gets rounded up to a multiple of 8.
+        int recordsPerBlock = 1024;
+
+        /// The number of records after which the block being filled gets written.
+        int flushIntervalRecords = 10;
+
+        /// The number of blocks the file grows by at once, to avoid remapping it for every block.
+        int blocksPerAllocation = 64;
+
+        /**
+         * @returns The default options.
+         */
+        static Options getDefault();
+    };
+
+    /// Expose as public members
+    using LevelMeter::Subscriber::subscribeToLevelMeter;
+    using LevelMeter::Subscriber::unsubscribeFromLevelMeter;
+
+    /**
+     * Constructor.
+     * @param file The file to write the log to.
+     * @param options The options for writing.
+     * @param maxChannels The max number of channels to log. If a meter has more channels then all channels will be
+     * folded into a single mono channel.
+     */
+    explicit LevelLogWriter (
+        const juce::File& file,
+        const Options& options = Options::getDefault(),
+        int maxChannels = kDefaultMaxChannels);
+
+    /**
+     * Destructor. Writes the pending records and waits for the background thread to finish.
+     */
+    ~LevelLogWriter() override;
+
+    /**
+     * @return The number of records logged so far.
+     */
+    [[nodiscard]] int64_t getNumRecords() const;
+
+    /**
+     * @return True if the background thread failed to write to the file, in which case logging stopped.
+     */
+    [[nodiscard]] bool hasFailed() const;
+
+private:
+    class WriterThread;
+
+    juce::File mFile;
+    Options mOptions;
+    std::unique_ptr<WriterThread> mWriterThread;
+
+    /// The number of channels of the file, 0 until the level meter got prepared.
+    int mNumFileChannels = 0;
+
+    /// The wall clock time and the monotonic clock time when the file was created, which the record times count from.
+    int64_t mStartTimeMs = 0;
+    double mStartCounterMs = 0.0;
+
+    /// The record being collected, per channel.
+    std::vector<double> mRecordPeakLevels;
+    std::vector<bool> mRecordOverloads;
+    int mNumTicksInRecord = 0;
+
+    /// The block being filled.
+    std::vector<uint8_t> mBlock;
+    LevelLogFormat::BlockHeader mBlockHeader;
+    int64_t mBlockIndex = 0;
+    int mNumRecordsSinceFlush = 0;
+
+    /**
+     * Appends the record being collected to the block, and hands the block to the writer thread when due.
+     */
+    void appendRecord();
+
+    /**
+     * Hands a copy of the block being filled to the writer thread.
+     */
+    void flushBlock();
+
+    // MARK: LevelMeter::Subscriber overrides -
+    void updateWithMeasurement (const LevelMeter::Measurement& measurement) override;
+    void measurementUpdatesFinished() override;
+    void levelMeterPrepared (int numChannels) override;
+};
@@ -1,96 +1,1181 @@
 #include "LevelMeter.h"
+#include "juce-extensions/audio/conversion/ChannelConversion.h"
 
-LevelMeter::LevelMeter()
+LevelMeter::LevelMeter() : LevelMeter (LevelMeterRegistry::DispatchKind::regular) {}
+
+LevelMeter::LevelMeter (LevelMeterRegistry::DispatchKind const dispatchKind) :
+    mDispatchKind (dispatchKind)
+{
+    mRegistry->add (*this, mDispatchKind);
+}
+
+LevelMeter::~LevelMeter()
+{
+    mRegistry->remove (*this);
+
+    if (mChannelSlotsStorage != nullptr)
+        mRegistry->freeChannelSlots (mChannelSlotsStorage->slots, mChannelSlotsStorage->numChannels);
+
+    releaseRetiredStorage();
+
+    mSubscribers.call ([this] (Subscriber& s) {
+        if (s.mSubscribedLevelMeter == this)
+            s.mSubscribedLevelMeter = nullptr;
+        s.reset();
+    });
+}
+
+void LevelMeter::prepareToPlay (int numChannels)
+{
+    prepareToPlay (numChannels, mSampleRate.load (std::memory_order_relaxed));
+}
+
+void LevelMeter::prepareToPlay (int numChannels, double sampleRate)
+{
+    // The positions of new measurements start over, the subscribers notice when they jump back.
+    mSamplePosition = 0;
+    mLatestSamplePosition.store (-1, std::memory_order_relaxed);
+
+    auto const sampleRateChanged = mSampleRate.exchange (sampleRate, std::memory_order_relaxed) != sampleRate;
+
+    // Only growing the storage replaces state which the message thread reads while dispatching.
+    if (numChannels > mMaxNumChannels.load (std::memory_order_relaxed))
+    {
+        allocateChannelStorage (numChannels);
+    }
+    else
+    {
+        const juce::ScopedLock lock (mStorageLock);
+
+        // Starts the runs over, without reallocating since the number of channels stays the same.
+        if (auto* clipDetector = mClipDetectorForReading.load (std::memory_order_acquire))
+            clipDetector->prepareToPlay (mMaxNumChannels.load (std::memory_order_relaxed));
+
+        auto* changedChannels = mChangedChannels.load (std::memory_order_relaxed);
+        if (changedChannels != nullptr && sampleRateChanged)
+            changedChannels->setSampleRate (sampleRate);
+    }
+
+    // Measurements which are still queued belong to the previous epoch, the message thread discards them.
+    if (numChannels != static_cast<int> (mConfiguration.load (std::memory_order_relaxed) & 0xffffffff) ||
+        sampleRateChanged)
+        setNumChannels (numChannels);
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+    {
+        updateConfiguration();
+        updateChannelMap();
+    }
+
+    preparedToPlay (mMaxNumChannels.load (std::memory_order_relaxed), sampleRate);
+}
+
+void LevelMeter::setMaxNumChannels (int const maxNumChannels)
+{
+    auto const numChannels = std::max (1, maxNumChannels);
+    allocateChannelStorage (numChannels);
+
+    if (static_cast<int> (mConfiguration.load (std::memory_order_relaxed) & 0xffffffff) > numChannels)
+        setNumChannels (numChannels);
+
+    preparedToPlay (numChannels, mSampleRate.load (std::memory_order_relaxed));
+}
+
+void LevelMeter::allocateChannelStorage (int const maxNumChannels)
+{
+    // Hosts prepare off the message thread, which might be dispatching meanwhile. The channel slots and the changed
+    // channels publisher get published as a whole and the replaced ones are only freed by the message thread.
+    const juce::ScopedLock lock (mStorageLock);
+
+    mMaxNumChannels.store (maxNumChannels, std::memory_order_relaxed);
+
+    // The runs are only accessed by the audio thread, which isn't measuring.
+    if (auto* clipDetector = mClipDetectorForReading.load (std::memory_order_acquire))
+        clipDetector->prepareToPlay (maxNumChannels);
+
+    updateChannelSlots();
+    updateChangedChannelsPublisher();
+}
+
+void LevelMeter::setNumChannels (int const numChannels)
+{
+    auto const maxNumChannels = mMaxNumChannels.load (std::memory_order_relaxed);
+    auto const channels = static_cast<uint64_t> (juce::jlimit (0, maxNumChannels, numChannels));
+    auto configuration = mConfiguration.load (std::memory_order_relaxed);
+    uint64_t newConfiguration = 0;
+
+    // A new epoch for every change, also when setting the same number of channels from multiple threads at once.
+    do
+    {
+        auto const epoch = static_cast<uint32_t> (configuration >> 32) + 1;
+        newConfiguration = (static_cast<uint64_t> (epoch) << 32) | channels;
+    } while (!mConfiguration.compare_exchange_weak (
+        configuration,
+        newConfiguration,
+        std::memory_order_release,
+        std::memory_order_relaxed));
+}
+
+void LevelMeter::updateConfiguration()
+{
+    auto const configuration = mConfiguration.load (std::memory_order_acquire);
+    auto const epoch = static_cast<uint32_t> (configuration >> 32);
+
+    if (epoch == mPreparedToPlayInfo.epoch)
+        return;
+
+    auto const numChannels = static_cast<int> (configuration & 0xffffffff);
+    auto const sampleRate = mSampleRate.load (std::memory_order_relaxed);
+    mPreparedToPlayInfo = { numChannels, sampleRate, epoch };
+
+    mSubscribers.call ([numChannels, sampleRate] (Subscriber& s) {
+        s.prepareToPlay (numChannels, sampleRate);
+    });
+
+    // The channel map gets compiled for a number of channels, and the subscribers might fold differently now.
+    mIsChannelMapDirty = true;
+
+    // The peaks in the channel slots might have been taken with the previous configuration.
+    if (auto* channelSlots = mChannelSlots.load (std::memory_order_acquire))
+    {
+        Measurement discarded;
+        for (int ch = 0; ch < channelSlots->numChannels; ch++)
+            channelSlots->slots[ch].take (discarded.peakLevel, discarded.blockInterval, discarded.sampleStride);
+    }
+}
+
+bool LevelMeter::isCurrentEpoch (uint32_t const epoch)
+{
+    // A measurement can be newer than the configuration picked up at the start of the dispatch.
+    if (epoch != mPreparedToPlayInfo.epoch)
+        updateConfiguration();
+
+    return epoch == mPreparedToPlayInfo.epoch;
+}
+
+int LevelMeter::getNumChannels() const
+{
+    return mPreparedToPlayInfo.numChannels;
+}
+
+int LevelMeter::getMaxNumChannels() const
+{
+    return mMaxNumChannels.load (std::memory_order_relaxed);
+}
+
+double LevelMeter::getSampleRate() const
+{
+    return mPreparedToPlayInfo.sampleRate;
+}
+
+void LevelMeter::setDispatchMode (DispatchMode const dispatchMode)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    {
+        const juce::ScopedLock lock (mStorageLock);
+        mDispatchMode = dispatchMode;
+        updateChannelSlots();
+        updateChangedChannelsPublisher();
+    }
+
+    mIsChannelMapDirty = true;
+    updateChannelMap();
+}
+
+void LevelMeter::updateChannelSlots()
+{
+    auto const numChannels =
+        mDispatchMode == DispatchMode::peakPerTick ? mMaxNumChannels.load (std::memory_order_relaxed) : 0;
+    if (numChannels == (mChannelSlotsStorage != nullptr ? mChannelSlotsStorage->numChannels : 0))
+        return;
+
+    // The audio thread isn't measuring (see setMaxNumChannels()), but the message thread might be sweeping the
+    // previous slots, so they get retired instead of freed.
+    std::unique_ptr<ChannelSlots> channelSlots;
+    // The registry sweeps the slots of regular level meters, the others sweep their own.
+    auto* const owner = mDispatchKind == LevelMeterRegistry::DispatchKind::regular ? this : nullptr;
+    if (auto* slots = mRegistry->allocateChannelSlots (numChannels, owner))
+        channelSlots = std::make_unique<ChannelSlots> (ChannelSlots { slots, numChannels });
+
+    mChannelSlots.store (channelSlots.get(), std::memory_order_release);
+
+    if (mChannelSlotsStorage != nullptr)
+    {
+        mRetiredChannelSlots.push_back (std::move (mChannelSlotsStorage));
+        mHasRetiredStorage.store (true, std::memory_order_release);
+    }
+
+    mChannelSlotsStorage = std::move (channelSlots);
+}
+
+void LevelMeter::updateChangedChannelsPublisher()
+{
+    std::unique_ptr<ChangedChannelsPublisher> changedChannels;
+
+    if (mDispatchMode == DispatchMode::changedChannels)
+    {
+        auto const maxNumChannels = mMaxNumChannels.load (std::memory_order_relaxed);
+        if (mChangedChannelsStorage != nullptr &&
+            mChangedChannelsStorage->getNumChannels() == std::max (1, maxNumChannels))
+            return;
+
+        changedChannels = std::make_unique<ChangedChannelsPublisher> (
+            ChangedChannelsPublisher::Options::getDefault(),
+            maxNumChannels,
+            mSampleRate.load (std::memory_order_relaxed));
+    }
+    else if (mChangedChannelsStorage == nullptr)
+    {
+        return;
+    }
+
+    // The message thread might be reading frames from the previous publisher.
+    mChangedChannels.store (changedChannels.get(), std::memory_order_release);
+
+    if (mChangedChannelsStorage != nullptr)
+    {
+        mRetiredChangedChannels.push_back (std::move (mChangedChannelsStorage));
+        mHasRetiredStorage.store (true, std::memory_order_release);
+    }
+
+    mChangedChannelsStorage = std::move (changedChannels);
+}
+
+void LevelMeter::releaseRetiredStorage()
+{
+    const juce::ScopedLock lock (mStorageLock);
+
+    for (auto const& channelSlots : mRetiredChannelSlots)
+        mRegistry->freeChannelSlots (channelSlots->slots, channelSlots->numChannels);
+
+    mRetiredChannelSlots.clear();
+    mRetiredChangedChannels.clear();
+    mHasRetiredStorage.store (false, std::memory_order_relaxed);
+}
+
+void LevelMeter::updateChannelMap()
+{
+    // Nothing which could change the common channel map happened, only the retired maps might need attention.
+    if (!std::exchange (mIsChannelMapDirty, false))
+    {
+        releaseRetiredChannelMaps();
+        return;
+    }
+
+    // Folding on the audio thread is only worth it (and only correct) when every subscriber folds the same way.
+    const ChannelMap* commonChannelMap = nullptr;
+    bool isCommon = true;
+
+    mSubscribers.call ([&commonChannelMap, &isCommon] (Subscriber& s) {
+        if (commonChannelMap == nullptr)
+            commonChannelMap = &s.mEffectiveChannelMap;
+        else if (*commonChannelMap != s.mEffectiveChannelMap)
+            isCommon = false;
+    });
+
+    // The channel slots hold a peak per channel of the level meter.
+    if (!isCommon || commonChannelMap == nullptr || commonChannelMap->isIdentity() ||
+        mChannelSlots.load (std::memory_order_acquire) != nullptr)
+        commonChannelMap = nullptr;
+
+    auto* current = mChannelMap.load (std::memory_order_relaxed);
+    auto const numChannels = mPreparedToPlayInfo.numChannels;
+    auto const isUpToDate = commonChannelMap == nullptr
+                                ? current == nullptr
+                                : current != nullptr && current->numInputChannels == numChannels &&
+                                      current->channelMap == *commonChannelMap;
+
+    if (!isUpToDate)
+    {
+        CompiledChannelMap* compiled = nullptr;
+
+        if (commonChannelMap != nullptr)
+        {
+            auto channelMap = std::make_unique<CompiledChannelMap>();
+            channelMap->id = mNextChannelMapId++;
+            channelMap->channelMap = *commonChannelMap;
+            channelMap->numInputChannels = numChannels;
+            channelMap->outputPeaks.resize (static_cast<size_t> (commonChannelMap->getNumOutputChannels (numChannels)));
+
+            for (int ch = 0; ch < numChannels; ch++)
+                channelMap->outputChannels.push_back (commonChannelMap->getOutputChannel (ch, numChannels));
+
+            compiled = channelMap.get();
+            mChannelMapStorage.push_back (std::move (channelMap));
+        }
+
+        // Sequentially consistent, to pair with the way ScopedChannelMap announces the map it uses.
+        mChannelMap.store (compiled);
+        current = compiled;
+    }
+
+    // Also tells subscribers which joined (or got prepared again) since the map was compiled.
+    auto const id = current != nullptr ? current->id : 0;
+    mSubscribers.call ([id] (Subscriber& s) {
+        s.mCompiledChannelMapId = id;
+    });
+
+    releaseRetiredChannelMaps();
+}
+
+void LevelMeter::releaseRetiredChannelMaps()
+{
+    if (mChannelMapStorage.empty())
+        return;
+
+    // Destroy the retired maps which the audio thread no longer uses, it never picks them up again.
+    auto* current = mChannelMap.load (std::memory_order_relaxed);
+    auto* inUse = mChannelMapInUse.load();
+    mChannelMapStorage.erase (
+        std::remove_if (
+            mChannelMapStorage.begin(),
+            mChannelMapStorage.end(),
+            [current, inUse] (const std::unique_ptr<CompiledChannelMap>& channelMap) {
+                return channelMap.get() != current && channelMap.get() != inUse;
+            }),
+        mChannelMapStorage.end());
+}
+
+rdk::Subscription LevelMeter::subscribe (Subscriber* subscriber)
+{
+    if (subscriber == nullptr)
+        return {};
+    subscriber->prepareToPlay (mPreparedToPlayInfo.numChannels, mPreparedToPlayInfo.sampleRate);
+    subscriber->mSubscribedLevelMeter = this;
+    auto subscription = mSubscribers.add (subscriber);
+    mIsChannelMapDirty = true;
+    updateChannelMap();
+    return subscription;
+}
+
+AudioTap& LevelMeter::getAudioTap()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    if (mAudioTapStorage == nullptr)
+    {
+        mAudioTapStorage = std::make_unique<AudioTap>();
+        mAudioTap.store (mAudioTapStorage.get(), std::memory_order_release);
+    }
+
+    return *mAudioTapStorage;
+}
+
+void LevelMeter::setStereoAnalysisEnabled (bool const shouldBeEnabled)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    if (mStereoAnalysisStorage == nullptr)
+    {
+        if (!shouldBeEnabled)
+            return;
+
+        mStereoAnalysisStorage = std::make_unique<StereoAnalysis>();
+        mStereoAnalysis.store (mStereoAnalysisStorage.get(), std::memory_order_release);
+    }
+
+    mStereoAnalysisStorage->isEnabled.store (shouldBeEnabled, std::memory_order_relaxed);
+}
+
+uint64_t LevelMeter::getNumLostStereoMeasurements() const
+{
+    if (auto* stereoAnalysis = mStereoAnalysis.load (std::memory_order_acquire))
+        return stereoAnalysis->numLostMeasurements.load (std::memory_order_relaxed);
+    return 0;
+}
+
+void LevelMeter::setClipDetectionEnabled (bool const shouldBeEnabled, const ClipDetector::Options& options)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    if (mClipDetectorStorage == nullptr)
+    {
+        if (!shouldBeEnabled)
+            return;
+
+        // The max number of channels might be growing on another thread (see prepareToPlay()).
+        const juce::ScopedLock lock (mStorageLock);
+        mClipDetectorStorage =
+            std::make_unique<ClipDetector> (options, mMaxNumChannels.load (std::memory_order_relaxed));
+        mClipDetectorForReading.store (mClipDetectorStorage.get(), std::memory_order_release);
+    }
+
+    mClipDetectorStorage->setOptions (options);
+    mClipDetector.store (shouldBeEnabled ? mClipDetectorStorage.get() : nullptr, std::memory_order_release);
+}
+
+uint64_t LevelMeter::getNumLostClipEvents() const
+{
+    if (auto* clipDetector = mClipDetectorForReading.load (std::memory_order_acquire))
+        return clipDetector->getNumLostEvents();
+    return 0;
+}
+
+void LevelMeter::setLoadSheddingPolicy (const LoadSheddingPolicy& policy)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    // Both get reported as uint16_t in the measurements.
+    constexpr int kMaxInterval = std::numeric_limits<uint16_t>::max();
+
+    mLoadShedding.blockInterval.store (juce::jlimit (1, kMaxInterval, policy.blockInterval), std::memory_order_relaxed);
+    mLoadShedding.sampleStride.store (juce::jlimit (1, kMaxInterval, policy.sampleStride), std::memory_order_relaxed);
+    mLoadShedding.skipWhenHidden.store (policy.skipWhenHidden, std::memory_order_relaxed);
+    mLoadShedding.loadThreshold.store (policy.loadThreshold, std::memory_order_relaxed);
+}
+
+void LevelMeter::setLoad (float const load)
+{
+    mLoadShedding.load.store (load, std::memory_order_relaxed);
+}
+
+void LevelMeter::setInstrumentationEnabled (bool const shouldBeEnabled)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    if (mInstrumentationStorage == nullptr)
+    {
+        if (!shouldBeEnabled)
+            return;
+
+        mInstrumentationStorage = std::make_unique<LevelMeterInstrumentation>();
+        mInstrumentationForReading.store (mInstrumentationStorage.get(), std::memory_order_release);
+    }
+
+    mInstrumentation.store (shouldBeEnabled ? mInstrumentationStorage.get() : nullptr, std::memory_order_release);
+}
+
+LevelMeterInstrumentation::Statistics LevelMeter::getInstrumentationStatistics() const
+{
+    if (auto* instrumentation = mInstrumentationForReading.load (std::memory_order_acquire))
+        return instrumentation->getStatistics();
+    return {};
+}
+
+template <typename SampleType>
+void LevelMeter::measureBlock (const juce::AudioBuffer<SampleType>& audioBuffer)
+{
+    measureBlock (audioBuffer.getArrayOfReadPointers(), audioBuffer.getNumChannels(), audioBuffer.getNumSamples());
+}
+
+// Trigger symbol generation.
+template void LevelMeter::measureBlock (const juce::AudioBuffer<float>& audioBuffer);
+template void LevelMeter::measureBlock (const juce::AudioBuffer<double>& audioBuffer);
+
+template <typename SampleType>
+void LevelMeter::measureBlock (const SampleType* const* inputChannelData, int numChannels, int numSamples)
+{
+    jassert (numChannels >= 0);
+    jassert (numSamples >= 0);
+
+    auto* instrumentation = mInstrumentation.load (std::memory_order_acquire);
+    LevelMeterInstrumentation::ScopedCallTimer callTimer (instrumentation);
+    ChangedChannelsPublisher::ScopedFrame changedChannelsFrame (mChangedChannels.load (std::memory_order_acquire));
+
+    auto const samplePosition = advanceSamplePosition (numSamples);
+    auto const blockPosition = samplePosition - numSamples;
+    auto* clipDetector = mClipDetector.load (std::memory_order_acquire);
+
+    if (isIntegrating())
+    {
+        integrateBlock (inputChannelData, numChannels, numSamples, samplePosition, instrumentation);
+        return;
+    }
+
+    if (auto* audioTap = mAudioTap.load (std::memory_order_acquire))
+        audioTap->push (inputChannelData, numChannels, numSamples);
+
+    // Channels beyond the configuration of this block don't get measured.
+    numChannels = std::min (numChannels, mMeasuringNumChannels);
+
+    ScopedChannelMap scopedChannelMap (*this);
+    auto* channelMap = scopedChannelMap.get();
+
+    // A map compiled for another number of channels doesn't fit the configuration yet, the message thread recompiles
+    // it once it picks up the configuration. Until then the subscribers fold the channels themselves.
+    if (channelMap != nullptr && channelMap->numInputChannels != mMeasuringNumChannels)
+        channelMap = nullptr;
+
+    if (channelMap != nullptr)
+        std::fill (channelMap->outputPeaks.begin(), channelMap->outputPeaks.end(), 0.0);
+
+    // Folds a peak level into the channel map, or pushes it when measuring every channel as is.
+    auto const addPeakLevel = [this, channelMap, instrumentation, samplePosition] (
+                                  int const ch,
+                                  double const peakLevel,
+                                  uint16_t const blockInterval,
+                                  uint16_t const sampleStride) {
+        if (channelMap == nullptr)
+        {
+            pushMeasurement ({ ch, peakLevel, blockInterval, sampleStride, samplePosition }, instrumentation);
+            return;
+        }
+
+        auto const outputChannel = channelMap->getOutputChannel (ch);
+        if (outputChannel >= 0)
+        {
+            auto& outputPeak = channelMap->outputPeaks[static_cast<size_t> (outputChannel)];
+            outputPeak = std::max (outputPeak, peakLevel);
+        }
+    };
+
+    int firstChannel = 0;
+
+    // Measure the peak levels of the first two channels and their correlation in the same pass.
+    auto* stereoAnalysis = mStereoAnalysis.load (std::memory_order_acquire);
+    if (stereoAnalysis != nullptr && stereoAnalysis->isEnabled.load (std::memory_order_relaxed) && numChannels >= 2)
+    {
+        StereoMeasurement stereoMeasurement;
+        auto [leftPeak, rightPeak] =
+            measureStereoBlock (inputChannelData[0], inputChannelData[1], numSamples, stereoMeasurement);
+
+        addPeakLevel (0, leftPeak, 1, 1);
+        addPeakLevel (1, rightPeak, 1, 1);
+
+        // Never lets the queue grow, which would allocate.
+        if (!stereoAnalysis->measurements.try_enqueue (stereoMeasurement))
+            stereoAnalysis->numLostMeasurements.fetch_add (1, std::memory_order_relaxed);
+
+        stereoAnalysis->addGoniometerPoints (inputChannelData[0], inputChannelData[1], numSamples);
+
+        if (clipDetector != nullptr)
+        {
+            clipDetector->process (0, inputChannelData[0], numSamples, leftPeak, blockPosition);
+            clipDetector->process (1, inputChannelData[1], numSamples, rightPeak, blockPosition);
+        }
+
+        firstChannel = 2;
+    }
+
+    // A skipped block publishes no levels at all, also not the folded levels of the first two channels.
+    auto const shedding = decideLoadShedding();
+    if (shedding.skipBlock)
+    {
+        // Clip detection doesn't shed load, a missed clip is worse than a less accurate meter.
+        if (clipDetector != nullptr)
+        {
+            for (int ch = firstChannel; ch < numChannels; ch++)
+            {
+                auto const peakLevel = findPeakLevel (inputChannelData[ch], numSamples);
+                clipDetector->process (ch, inputChannelData[ch], numSamples, peakLevel, blockPosition);
+            }
+        }
+
+        return;
+    }
+
+    // Measure levels
+    for (int ch = firstChannel; ch < numChannels; ch++)
+    {
+        // Channels which the channel map leaves out only get measured for the clip detection.
+        auto const isShown = channelMap == nullptr || channelMap->getOutputChannel (ch) >= 0;
+        if (!isShown && clipDetector == nullptr)
+            continue;
+
+        auto const peakLevel =
+            shedding.sampleStride > 1 && isShown
+                ? findPeakLevelStrided (inputChannelData[ch], numSamples, shedding.sampleStride, shedding.strideOffset)
+                : findPeakLevel (inputChannelData[ch], numSamples);
+
+        if (isShown)
+            addPeakLevel (ch, peakLevel, shedding.blockInterval, shedding.sampleStride);
+
+        if (clipDetector != nullptr)
+        {
+            // A strided peak level might miss the clipped samples.
+            auto const exactPeakLevel =
+                shedding.sampleStride > 1 && isShown ? findPeakLevel (inputChannelData[ch], numSamples) : peakLevel;
+            clipDetector->process (ch, inputChannelData[ch], numSamples, exactPeakLevel, blockPosition);
+        }
+    }
+
+    if (channelMap == nullptr)
+        return;
+
+    // Only the folded levels get published.
+    for (size_t out = 0; out < channelMap->outputPeaks.size(); out++)
+    {
+        pushMeasurement (
+            { static_cast<int> (out),
+              channelMap->outputPeaks[out],
+              shedding.blockInterval,
+              shedding.sampleStride,
+              samplePosition,
+              false,
+              channelMap->id },
+            instrumentation);
+    }
+}
+
+// Trigger symbol generation.
+template void LevelMeter::measureBlock (const float* const* inputChannelData, int numChannels, int numSamples);
+template void LevelMeter::measureBlock (const double* const* inputChannelData, int numChannels, int numSamples);
+
+template <typename SrcType, typename SampleType>
+bool LevelMeter::addConvertChannelsAndMeasureBlock (
+    const juce::AudioBuffer<SrcType>& src,
+    juce::AudioBuffer<SampleType>& dst)
+{
+    auto* instrumentation = mInstrumentation.load (std::memory_order_acquire);
+    LevelMeterInstrumentation::ScopedCallTimer callTimer (instrumentation);
+    ChangedChannelsPublisher::ScopedFrame changedChannelsFrame (mChangedChannels.load (std::memory_order_acquire));
+
+    auto numOutputChannels = dst.getNumChannels();
+    auto numSamples = std::min (src.getNumSamples(), dst.getNumSamples());
+    auto const samplePosition = advanceSamplePosition (dst.getNumSamples());
+    auto const blockPosition = samplePosition - dst.getNumSamples();
+    auto* clipDetector = mClipDetector.load (std::memory_order_acquire);
+
+    // The integration runs over the converted samples, so the conversion can't be fused with measuring.
+    if (isIntegrating())
+    {
+        auto const isLossless = addConvertChannels (src, dst);
+        integrateBlock (
+            dst.getArrayOfReadPointers(),
+            numOutputChannels,
+            dst.getNumSamples(),
+            samplePosition,
+            instrumentation);
+        return isLossless;
+    }
+
+    // The conversion touches every sample anyway, so shedding only skips blocks and never strides.
+    auto const shedding = decideLoadShedding();
+
+    for (int ch = 0; ch < numOutputChannels; ch++)
+    {
+        // A skipped block still gets converted, and only gets measured for the clip detection.
+        if (shedding.skipBlock && clipDetector == nullptr)
+        {
+            addConvertChannel (src, dst, ch, numSamples);
+            continue;
+        }
+
+        // Converting and measuring in a single pass, so the output channel only gets read once.
+        auto peakLevel = addConvertChannelAndFindPeak (
+            src.getArrayOfReadPointers(),
+            src.getNumChannels(),
+            dst.getArrayOfWritePointers(),
+            numOutputChannels,
+            ch,
+            numSamples);
+
+        // The part of dst beyond the end of src is left as is, but still belongs to the block.
+        if (dst.getNumSamples() > numSamples)
+            peakLevel = std::max (
+                peakLevel,
+                findPeakLevel (dst.getReadPointer (ch, numSamples), dst.getNumSamples() - numSamples));
+
+        if (!shedding.skipBlock)
+            pushMeasurement ({ ch, peakLevel, shedding.blockInterval, 1, samplePosition }, instrumentation);
+
+        if (clipDetector != nullptr)
+            clipDetector->process (ch, dst.getReadPointer (ch), dst.getNumSamples(), peakLevel, blockPosition);
+    }
+
+    if (auto* audioTap = mAudioTap.load (std::memory_order_acquire))
+        audioTap->push (dst.getArrayOfReadPointers(), numOutputChannels, dst.getNumSamples());
+
+    return isLosslessChannelConversion (src.getNumChannels(), numOutputChannels);
+}
+
+// Trigger symbol generation.
+template bool LevelMeter::addConvertChannelsAndMeasureBlock (
+    const juce::AudioBuffer<float>& src,
+    juce::AudioBuffer<float>& dst);
+template bool LevelMeter::addConvertChannelsAndMeasureBlock (
+    const juce::AudioBuffer<double>& src,
+    juce::AudioBuffer<double>& dst);
+template bool LevelMeter::addConvertChannelsAndMeasureBlock (
+    const juce::AudioBuffer<double>& src,
+    juce::AudioBuffer<float>& dst);
+template bool LevelMeter::addConvertChannelsAndMeasureBlock (
+    const juce::AudioBuffer<float>& src,
+    juce::AudioBuffer<double>& dst);
+
+template <typename SampleType>
+void LevelMeter::measureDownmix (const juce::AudioBuffer<SampleType>& audioBuffer, const DownmixMatrix& downmix)
+{
+    auto* instrumentation = mInstrumentation.load (std::memory_order_acquire);
+    LevelMeterInstrumentation::ScopedCallTimer callTimer (instrumentation);
+    ChangedChannelsPublisher::ScopedFrame changedChannelsFrame (mChangedChannels.load (std::memory_order_acquire));
+
+    auto const numInputChannels = std::min (audioBuffer.getNumChannels(), downmix.getNumInputChannels());
+    auto const numSamples = audioBuffer.getNumSamples();
+    auto const samplePosition = advanceSamplePosition (numSamples);
+    auto const blockPosition = samplePosition - numSamples;
+
+    // The integration needs every sample of every channel, so integrating doesn't shed load nor detect clips.
+    auto const integrating = isIntegrating();
+    auto* clipDetector = integrating ? nullptr : mClipDetector.load (std::memory_order_acquire);
+
+    // Calculating the downmix is what costs, so shedding only skips blocks and never strides. Clip detection doesn't
+    // shed load, so a skipped block still gets downmixed while clip detection is enabled.
+    auto const shedding = integrating ? SheddingDecision {} : decideLoadShedding();
+    if (shedding.skipBlock && clipDetector == nullptr)
+        return;
+
+    // The downmix gets calculated in small chunks on the stack, so it never needs a buffer of its own.
+    SampleType chunk[kDownmixChunkSize];
+
+    for (int out = 0; out < downmix.getNumOutputChannels(); out++)
+    {
+        SampleType peak {};
+        double reading = 0.0;
+
+        for (int offset = 0; offset < numSamples; offset += kDownmixChunkSize)
+        {
+            auto const numChunkSamples = std::min (kDownmixChunkSize, numSamples - offset);
+            bool isEmpty = true;
+
+            for (int in = 0; in < numInputChannels; in++)
+            {
+                auto const gain = static_cast<SampleType> (downmix.getGain (out, in));
+                if (gain == SampleType {})
+                    continue;
+
+                auto* inputData = audioBuffer.getReadPointer (in, offset);
+
+                if (std::exchange (isEmpty, false))
+                    juce::FloatVectorOperations::copyWithMultiply (chunk, inputData, gain, numChunkSamples);
+                else
+                    juce::FloatVectorOperations::addWithMultiply (chunk, inputData, gain, numChunkSamples);
+            }
+
+            if (isEmpty)
+            {
+                // Nothing routes to this output channel, which an integrator still needs to see as silence.
+                if (!integrating)
+                    break;
+
+                juce::FloatVectorOperations::clear (chunk, numChunkSamples);
+            }
+
+            if (integrating)
+            {
+                reading = std::max (reading, integrateChannel (out, chunk, numChunkSamples));
+                continue;
+            }
+
+            auto const chunkPeak = findPeakLevel (chunk, numChunkSamples);
+            peak = std::max (peak, chunkPeak);
+
+            if (clipDetector != nullptr)
+                clipDetector->process (out, chunk, numChunkSamples, chunkPeak, blockPosition + offset);
+        }
+
+        if (integrating)
+            pushMeasurement ({ out, reading, 1, 1, samplePosition, true }, instrumentation);
+        else if (!shedding.skipBlock)
+            pushMeasurement ({ out, peak, shedding.blockInterval, 1, samplePosition }, instrumentation);
+    }
+}
+
+// Trigger symbol generation.
+template void LevelMeter::measureDownmix (const juce::AudioBuffer<float>& audioBuffer, const DownmixMatrix& downmix);
+template void LevelMeter::measureDownmix (const juce::AudioBuffer<double>& audioBuffer, const DownmixMatrix& downmix);
+
+template <typename SampleType>
+SampleType LevelMeter::findPeakLevel (const SampleType* channelData, int numSamples)
+{
+    auto range = juce::FloatVectorOperations::findMinAndMax (channelData, numSamples);
+    return juce::jmax (range.getStart(), -range.getStart(), range.getEnd(), -range.getEnd());
+}
+
+template <typename SampleType>
+SampleType LevelMeter::findPeakLevelStrided (
+    const SampleType* channelData,
+    int const numSamples,
+    int const stride,
+    int const offset)
+{
+    SampleType peak {};
+    for (int i = offset; i < numSamples; i += stride)
+        peak = std::max (peak, std::abs (channelData[i]));
+    return peak;
+}
+
+template <typename SampleType>
+void LevelMeter::integrateBlock (
+    const SampleType* const* channelData,
+    int numChannels,
+    int const numSamples,
+    int64_t const samplePosition,
+    LevelMeterInstrumentation* const instrumentation)
+{
+    // Channels beyond the configuration of this block don't get integrated.
+    numChannels = std::min (numChannels, mMeasuringNumChannels);
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        auto const reading = integrateChannel (ch, channelData[ch], numSamples);
+        pushMeasurement ({ ch, reading, 1, 1, samplePosition, true }, instrumentation);
+    }
+}
+
+// Trigger symbol generation.
+template void LevelMeter::integrateBlock (
+    const float* const* channelData,
+    int numChannels,
+    int numSamples,
+    int64_t samplePosition,
+    LevelMeterInstrumentation* instrumentation);
+template void LevelMeter::integrateBlock (
+    const double* const* channelData,
+    int numChannels,
+    int numSamples,
+    int64_t samplePosition,
+    LevelMeterInstrumentation* instrumentation);
+
+LevelMeter::SheddingDecision LevelMeter::decideLoadShedding()
+{
+    auto& state = mLoadShedding;
+
+    if (state.load.load (std::memory_order_relaxed) < state.loadThreshold.load (std::memory_order_relaxed))
+    {
+        state.blockCounter = 0;
+        return {};
+    }
+
+    if (state.skipWhenHidden.load (std::memory_order_relaxed) &&
+        !state.hasVisibleSubscribers.load (std::memory_order_relaxed))
+        return { true };
+
+    SheddingDecision decision;
+    decision.blockInterval = static_cast<uint16_t> (state.blockInterval.load (std::memory_order_relaxed));
+    decision.sampleStride = static_cast<uint16_t> (state.sampleStride.load (std::memory_order_relaxed));
+
+    // Measure the first block of every interval.
+    decision.skipBlock = state.blockCounter != 0;
+    if (++state.blockCounter >= decision.blockInterval)
+        state.blockCounter = 0;
+
+    if (!decision.skipBlock)
+    {
+        state.strideOffset = (state.strideOffset + 1) % decision.sampleStride;
+        decision.strideOffset = state.strideOffset;
+    }
+
+    return decision;
+}
+
+template <typename SampleType>
+std::pair<SampleType, SampleType> LevelMeter::measureStereoBlock (
+    const SampleType* left,
+    const SampleType* right,
+    int const numSamples,
+    StereoMeasurement& stereoMeasurement)
+{
+    // Accumulate in independent lanes, which lets the compiler keep every lane in a SIMD register without having to
+    // reorder the floating point additions.
+    constexpr int kNumLanes = 8;
+
+    SampleType leftPeak[kNumLanes] {}, rightPeak[kNumLanes] {};
+    SampleType product[kNumLanes] {}, leftSquare[kNumLanes] {}, rightSquare[kNumLanes] {};
+
+    int i = 0;
+    for (; i + kNumLanes <= numSamples; i += kNumLanes)
+    {
+        for (int lane = 0; lane < kNumLanes; lane++)
+        {
+            auto const l = left[i + lane];
+            auto const r = right[i + lane];
+            leftPeak[lane] = std::max (leftPeak[lane], std::abs (l));
+            rightPeak[lane] = std::max (rightPeak[lane], std::abs (r));
+            product[lane] += l * r;
+            leftSquare[lane] += l * l;
+            rightSquare[lane] += r * r;
+        }
+    }
+
+    for (int lane = 0; i < numSamples; i++, lane++)
+    {
+        auto const l = left[i];
+        auto const r = right[i];
+        leftPeak[lane] = std::max (leftPeak[lane], std::abs (l));
+        rightPeak[lane] = std::max (rightPeak[lane], std::abs (r));
+        product[lane] += l * r;
+        leftSquare[lane] += l * l;
+        rightSquare[lane] += r * r;
+    }
+
+    SampleType peaks[2] {};
+    stereoMeasurement = {};
+
+    for (int lane = 0; lane < kNumLanes; lane++)
+    {
+        peaks[0] = std::max (peaks[0], leftPeak[lane]);
+        peaks[1] = std::max (peaks[1], rightPeak[lane]);
+        stereoMeasurement.productSum += static_cast<double> (product[lane]);
+        stereoMeasurement.leftSquareSum += static_cast<double> (leftSquare[lane]);
+        stereoMeasurement.rightSquareSum += static_cast<double> (rightSquare[lane]);
+    }
+
+    return { peaks[0], peaks[1] };
+}
+
+template <typename SampleType>
+void LevelMeter::StereoAnalysis::addGoniometerPoints (
+    const SampleType* left,
+    const SampleType* right,
+    int const numSamples)
 {
-    mSharedTimer->subscribe (*this);
+    for (; goniometerSampleOffset < numSamples; goniometerSampleOffset += kGoniometerDecimation)
+    {
+        auto& frame = goniometerPoints.getWriteBuffer();
+        frame.left[static_cast<size_t> (goniometerWriteIndex)] = static_cast<float> (left[goniometerSampleOffset]);
+        frame.right[static_cast<size_t> (goniometerWriteIndex)] = static_cast<float> (right[goniometerSampleOffset]);
+
+        if (++goniometerWriteIndex >= kNumGoniometerPoints)
+        {
+            goniometerPoints.publish();
+            goniometerWriteIndex = 0;
+        }
+    }
+
+    // Carry the decimation over into the next block.
+    goniometerSampleOffset -= numSamples;
 }
 
-LevelMeter::~LevelMeter()
+int LevelMeter::CompiledChannelMap::getOutputChannel (int const inputChannel) const
 {
-    mSubscribers.call ([] (Subscriber& s) {
-        s.reset();
-    });
+    return inputChannel < numInputChannels ? outputChannels[static_cast<size_t> (inputChannel)] : -1;
 }
 
-void LevelMeter::prepareToPlay (int numChannels)
+LevelMeter::ScopedChannelMap::ScopedChannelMap (LevelMeter& levelMeter) :
+    mLevelMeter (levelMeter)
 {
-    if (std::exchange (mPreparedToPlayInfo.numChannels, numChannels) != numChannels)
+    // Announce the map before using it, then make sure it wasn't retired in the meantime. All sequentially
+    // consistent: either the message thread sees the announcement, or this thread sees the newer map and retries.
+    auto* channelMap = mLevelMeter.mChannelMap.load();
+
+    for (;;)
     {
-        mSubscribers.call ([numChannels] (Subscriber& s) {
-            s.prepareToPlay (numChannels);
-        });
+        mLevelMeter.mChannelMapInUse.store (channelMap);
 
-        // Since measurments gets read from the queue on the juce::MessageThread (in response to the timer callback), it
-        // is safe to clear the queue here.
-        while (mMeasurements.pop())
-        {
-        };
+        auto* latest = mLevelMeter.mChannelMap.load();
+        if (latest == channelMap)
+            break;
+
+        channelMap = latest;
     }
+
+    mChannelMap = channelMap;
 }
 
-rdk::Subscription LevelMeter::subscribe (Subscriber* subscriber)
+LevelMeter::ScopedChannelMap::~ScopedChannelMap()
 {
-    if (subscriber == nullptr)
-        return {};
-    subscriber->prepareToPlay (mPreparedToPlayInfo.numChannels);
-    return mSubscribers.add (subscriber);
+    mLevelMeter.mChannelMapInUse.store (nullptr, std::memory_order_release);
 }
 
-template <typename SampleType>
-void LevelMeter::measureBlock (const juce::AudioBuffer<SampleType>& audioBuffer)
+LevelMeter::CompiledChannelMap* LevelMeter::ScopedChannelMap::get() const
 {
-    measureBlock (audioBuffer.getArrayOfReadPointers(), audioBuffer.getNumChannels(), audioBuffer.getNumSamples());
+    return mChannelMap;
 }
 
-// Trigger symbol generation.
-template void LevelMeter::measureBlock (const juce::AudioBuffer<float>& audioBuffer);
-template void LevelMeter::measureBlock (const juce::AudioBuffer<double>& audioBuffer);
+LevelMeterInstrumentation* LevelMeter::getActiveInstrumentation() const
+{
+    return mInstrumentation.load (std::memory_order_acquire);
+}
 
-template <typename SampleType>
-void LevelMeter::measureBlock (const SampleType* const* inputChannelData, int numChannels, int numSamples)
+int64_t LevelMeter::advanceSamplePosition (int const numSamples)
 {
-    jassert (numChannels >= 0);
-    jassert (numSamples >= 0);
+    mSamplePosition += numSamples;
 
-    // Measure levels
-    for (int ch = 0; ch < numChannels; ch++)
+    // Switching to a new configuration is a single load per block, which gives both the epoch and the number of
+    // channels, so every measurement of the block describes the same configuration.
+    auto const configuration = mConfiguration.load (std::memory_order_acquire);
+    mMeasuringEpoch = static_cast<uint32_t> (configuration >> 32);
+    mMeasuringNumChannels = static_cast<int> (configuration & 0xffffffff);
+
+    // Only read back while dispatching a peak per tick, the other measurements carry their own position.
+    if (mChannelSlots.load (std::memory_order_relaxed) != nullptr)
+        mLatestSamplePosition.store (mSamplePosition, std::memory_order_release);
+
+    return mSamplePosition;
+}
+
+void LevelMeter::pushMeasurement (Measurement&& measurement, LevelMeterInstrumentation* instrumentation)
+{
+    measurement.epoch = mMeasuringEpoch;
+
+    // Channels of the level meter beyond the configuration would be taken for channels of the subscribers.
+    if (measurement.channelMapId == 0 && measurement.channelIndex >= mMeasuringNumChannels)
+        return;
+
+    if (auto* channelSlots = mChannelSlots.load (std::memory_order_acquire))
+    {
+        if (juce::isPositiveAndBelow (measurement.channelIndex, channelSlots->numChannels))
+        {
+            channelSlots->slots[measurement.channelIndex].accumulate (
+                measurement.peakLevel,
+                measurement.blockInterval,
+                measurement.sampleStride);
+        }
+        return;
+    }
+
+    auto* changedChannels = mChangedChannels.load (std::memory_order_relaxed);
+    if (changedChannels != nullptr && !measurement.isIntegrated)
     {
-        // Peak level
-        auto range = juce::FloatVectorOperations::findMinAndMax (inputChannelData[ch], numSamples);
-        auto peak = juce::jmax (range.getStart(), -range.getStart(), range.getEnd(), -range.getEnd());
+        changedChannels->addLevel (
+            measurement.channelIndex,
+            measurement.peakLevel,
+            { measurement.samplePosition,
+              measurement.blockInterval,
+              measurement.sampleStride,
+              measurement.channelMapId,
+              measurement.epoch });
+        return;
+    }
 
-        pushMeasurement ({ ch, peak });
+    if (instrumentation == nullptr)
+    {
+        mMeasurements.enqueue (measurement);
+        return;
     }
+
+    // Same as enqueue(), which grows the queue when it is full, but tells apart the measurements which fit in the
+    // preallocated queue from the ones which made the queue grow (or got lost when that failed). Instrumentation
+    // only observes the meter, so it keeps the growing behaviour and counts every allocation it causes.
+    if (mMeasurements.try_enqueue (measurement))
+        instrumentation->recordQueueDepth (mMeasurements.size_approx());
+    else
+        instrumentation->recordQueueGrowth (!mMeasurements.enqueue (measurement));
 }
 
-// Trigger symbol generation.
-template void LevelMeter::measureBlock (const float* const* inputChannelData, int numChannels, int numSamples);
-template void LevelMeter::measureBlock (const double* const* inputChannelData, int numChannels, int numSamples);
+void LevelMeter::dispatchMeasurements()
+{
+    beginDispatch();
+
+    if (auto* channelSlots = mChannelSlots.load (std::memory_order_acquire))
+        dispatchChannelSlots (channelSlots->slots);
+
+    finishDispatch();
+}
 
-void LevelMeter::pushMeasurement (Measurement&& measurement)
+void LevelMeter::dispatchChannelSlots (LevelMeterRegistry::ChannelSlot* const slots)
 {
-    mMeasurements.enqueue (measurement);
+    // Slots which were replaced since the registry started its sweep.
+    auto* channelSlots = mChannelSlots.load (std::memory_order_acquire);
+    if (channelSlots == nullptr || channelSlots->slots != slots)
+        return;
+
+    // The peaks were taken somewhere since the previous tick, which the latest position is the best estimate for.
+    Measurement measurement;
+    measurement.samplePosition = mLatestSamplePosition.load (std::memory_order_acquire);
+
+    for (int ch = 0; ch < std::min (channelSlots->numChannels, mPreparedToPlayInfo.numChannels); ch++)
+    {
+        measurement.channelIndex = ch;
+        if (slots[ch].take (measurement.peakLevel, measurement.blockInterval, measurement.sampleStride))
+            dispatchToSubscribers (measurement);
+    }
 }
 
-void LevelMeter::timerCallback()
+void LevelMeter::beginDispatch()
 {
+    // Nothing of the storage is held on to in between dispatches.
+    if (mHasRetiredStorage.load (std::memory_order_acquire))
+        releaseRetiredStorage();
+
+    updateConfiguration();
+    updateChannelMap();
+
     Measurement measurement;
+
+    // Measurements taken with an older configuration don't fit the subscribers anymore.
     while (mMeasurements.try_dequeue (measurement))
+        if (isCurrentEpoch (measurement.epoch))
+            dispatchToSubscribers (measurement);
+
+    if (auto* changedChannels = mChangedChannels.load (std::memory_order_acquire))
+    {
+        changedChannels->readFrames (
+            [this, &measurement] (
+                const ChangedChannelsPublisher::FrameInfo& frameInfo,
+                int const channelIndex,
+                float const peakLevel) {
+                if (!isCurrentEpoch (frameInfo.epoch))
+                    return;
+
+                measurement = { channelIndex,
+                                static_cast<double> (peakLevel),
+                                frameInfo.blockInterval,
+                                frameInfo.sampleStride,
+                                frameInfo.samplePosition,
+                                false,
+                                frameInfo.channelMapId,
+                                frameInfo.epoch };
+                dispatchToSubscribers (measurement);
+            });
+    }
+
+    if (auto* clipDetector = mClipDetectorStorage.get())
+    {
+        ClipEvent clipEvent;
+        while (clipDetector->popEvent (clipEvent))
+        {
+            mSubscribers.call ([&clipEvent] (Subscriber& s) {
+                s.updateWithClipEvent (clipEvent);
+            });
+        }
+    }
+
+    if (auto* stereoAnalysis = mStereoAnalysisStorage.get())
     {
-        mSubscribers.call ([&measurement] (Subscriber& s) {
-            s.updateWithMeasurement (measurement);
-        });
+        StereoMeasurement stereoMeasurement;
+        while (stereoAnalysis->measurements.try_dequeue (stereoMeasurement))
+        {
+            mSubscribers.call ([&stereoMeasurement] (Subscriber& s) {
+                s.updateWithStereoMeasurement (stereoMeasurement);
+            });
+        }
+
+        if (stereoAnalysis->goniometerPoints.update())
+        {
+            mSubscribers.call ([&stereoAnalysis] (Subscriber& s) {
+                s.updateWithGoniometerPoints (stereoAnalysis->goniometerPoints.getReadBuffer());
+            });
+        }
     }
+}
+
+void LevelMeter::finishDispatch()
+{
+    bool hasVisibleSubscribers = false;
 
-    mSubscribers.call ([] (Subscriber& s) {
+    mSubscribers.call ([&hasVisibleSubscribers] (Subscriber& s) {
         s.measurementUpdatesFinished();
+        hasVisibleSubscribers = hasVisibleSubscribers || s.isShowingMeasurements();
     });
+
+    mLoadShedding.hasVisibleSubscribers.store (hasVisibleSubscribers, std::memory_order_relaxed);
+}
+
+void LevelMeter::dispatchToSubscribers (const Measurement& measurement)
+{
+    mSubscribers.call ([&measurement] (Subscriber& s) {
+        s.updateWithMeasurement (measurement);
+    });
+}
+
+LevelMeterRegistry& LevelMeter::getRegistry()
+{
+    return *mRegistry;
 }
 
-void LevelMeter::Subscriber::prepareToPlay (int numChannels)
+void LevelMeter::Subscriber::prepareToPlay (int numChannels, double const sampleRate)
 {
-    if (numChannels > mMaxChannels)
-        numChannels = 1; // Make updateWithMeasurement() fold all channels into a single mono channel.
+    mNumLevelMeterChannels = numChannels;
+    mEffectiveChannelMap = mChannelMap;
+
+    // Fold all channels into a single mono channel.
+    if (mChannelMap.isIdentity() && numChannels > mMaxChannels)
+        mEffectiveChannelMap = ChannelMap::createMonoFold();
+
+    numChannels = mEffectiveChannelMap.getNumOutputChannels (numChannels);
 
     mChannelData.resize (numChannels);
 
@@ -99,24 +1184,154 @@ void LevelMeter::Subscriber::prepareToPlay (int numChannels)
         ch.peakLevel.setMinusInfinityDb (mScale.getMinusInfinityDb());
         ch.peakLevel.setPeakHoldTime (1000 / LevelMeterConstants::kRefreshRateHz);
         ch.peakLevel.setReturnRate (mReturnRateDbPerSecond);
+        ch.peakLevel.setClock (*mMeterClock);
         ch.peakHoldLevel.setMinusInfinityDb (mScale.getMinusInfinityDb());
         ch.peakHoldLevel.setPeakHoldTime (LevelMeterConstants::kPeakHoldDefaultValueTimeMs);
         ch.peakHoldLevel.setReturnRate (mReturnRateDbPerSecond);
+        ch.peakHoldLevel.setClock (*mMeterClock);
     }
 
+    mSampleRate = sampleRate;
+    mClock.prepare (sampleRate);
+    mPendingMeasurements.resize (kMaxPendingMeasurements);
+    mPendingHead = 0;
+    mNumPending = 0;
+    mNewestSamplePosition = -1;
+    mHasNewSamplePosition = false;
+    mDisplayPosition = -1.0;
+    mDisplayedLevels.assign (static_cast<size_t> (numChannels), {});
+    mActiveChannels.clear();
+    mIsActiveChannel.assign (static_cast<size_t> (numChannels), false);
+
     levelMeterPrepared (numChannels);
 }
 
 void LevelMeter::Subscriber::updateWithMeasurement (const Measurement& measurement)
 {
-    if (measurement.channelIndex < 0)
+    if (mSampleRate <= 0.0 || measurement.samplePosition < 0)
     {
-        jassertfalse; // Negative channel index.
+        applyMeasurement (measurement);
+        return;
+    }
+
+    if (measurement.samplePosition < mNewestSamplePosition)
+    {
+        // The level meter was prepared again and the positions start over.
+        flushPendingMeasurements();
+        mClock.reset();
+        mDisplayPosition = -1.0;
+        mNewestSamplePosition = -1;
+    }
+
+    if (measurement.samplePosition > mNewestSamplePosition)
+    {
+        mNewestSamplePosition = measurement.samplePosition;
+        mNewestSamplePositionTimeMs = mMeterClock->getTimeMs();
+        mHasNewSamplePosition = true;
+    }
+
+    if (mNumPending == mPendingMeasurements.size())
+        applyOldestPendingMeasurement();
+
+    mPendingMeasurements[(mPendingHead + mNumPending) % mPendingMeasurements.size()] = measurement;
+    ++mNumPending;
+}
+
+void LevelMeter::Subscriber::applyMeasurement (const Measurement& measurement)
+{
+    auto const channelIndex = getChannelIndexForMeasurement (measurement);
+    if (channelIndex < 0)
+        return;
+
+    auto& channelData = mChannelData.getReference (channelIndex);
+    channelData.peakHoldLevel.updateLevel (measurement.peakLevel);
+    channelData.isIntegrated = measurement.isIntegrated;
+
+    if (measurement.isIntegrated)
+    {
+        // Shown as is, but the highest reading since the previous frame so that short peaks can't be missed.
+        if (!channelData.hasNewIntegratedLevel || measurement.peakLevel > channelData.integratedLevel)
+            channelData.integratedLevel = measurement.peakLevel;
+        channelData.hasNewIntegratedLevel = true;
+    }
+    else
+    {
+        channelData.peakLevel.updateLevel (measurement.peakLevel);
+    }
+
+    if (measurement.peakLevel >= LevelMeterConstants::kOverloadTriggerLevel)
+        channelData.overloaded = true;
+    channelData.reducedAccuracy = measurement.isReducedAccuracy();
+
+    auto&& isActive = mIsActiveChannel[static_cast<size_t> (channelIndex)];
+    if (!isActive && mScale.calculateProportionForLevel (measurement.peakLevel) > kSilenceProportion)
+    {
+        isActive = true;
+        mActiveChannels.push_back (channelIndex);
+    }
+}
+
+bool LevelMeter::Subscriber::isSilent()
+{
+    // Applies the held back measurements which are due, which might make channels active.
+    if (mSampleRate > 0.0)
+        advanceDisplay();
+
+    for (size_t i = 0; i < mActiveChannels.size();)
+    {
+        auto const ch = mActiveChannels[i];
+        auto const level = std::max (getPeakValue (ch), getPeakHoldValue (ch));
+
+        if (mScale.calculateProportionForLevel (level) > kSilenceProportion)
+        {
+            i++;
+            continue;
+        }
+
+        mIsActiveChannel[static_cast<size_t> (ch)] = false;
+        mActiveChannels[i] = mActiveChannels.back();
+        mActiveChannels.pop_back();
+    }
+
+    return mActiveChannels.empty();
+}
+
+void LevelMeter::Subscriber::updateWithClipEvent (const ClipEvent& clipEvent)
+{
+    auto const channelIndex = getChannelIndexForLevelMeterChannel (clipEvent.channelIndex);
+    if (channelIndex < 0)
         return;
+
+    auto& channelData = mChannelData.getReference (channelIndex);
+    channelData.numClipEvents++;
+    channelData.numClippedSamples += clipEvent.length;
+}
+
+int LevelMeter::Subscriber::getChannelIndexForMeasurement (const Measurement& measurement) const
+{
+    if (measurement.channelMapId == 0)
+        return getChannelIndexForLevelMeterChannel (measurement.channelIndex);
+
+    // Already folded by the level meter. Measurements folded with a map which was replaced since are dropped.
+    if (measurement.channelMapId != mCompiledChannelMapId)
+        return -1;
+
+    return juce::isPositiveAndBelow (measurement.channelIndex, getNumChannels()) ? measurement.channelIndex : -1;
+}
+
+int LevelMeter::Subscriber::getChannelIndexForLevelMeterChannel (int const levelMeterChannelIndex) const
+{
+    if (levelMeterChannelIndex < 0)
+    {
+        jassertfalse; // Negative channel index.
+        return -1;
     }
 
+    if (!mEffectiveChannelMap.isIdentity())
+        return mEffectiveChannelMap.getOutputChannel (levelMeterChannelIndex, mNumLevelMeterChannels);
+
     auto const numChannels = getNumChannels();
-    auto channelIndex = measurement.channelIndex;
+    auto channelIndex = levelMeterChannelIndex;
     if (channelIndex >= numChannels)
     {
         if (numChannels == 1)
@@ -128,15 +1343,34 @@ void LevelMeter::Subscriber::updateWithMeasurement (const Measurement& measureme
             // The channel index is out of range and there is no mono channel to fold into which suggests that
             // prepareToPlay was not called with the correct number of channels.
             jassertfalse;
-            return;
+            return -1;
         }
     }
 
-    auto& [peakLevel, peakHoldLevel, overloaded] = mChannelData.getReference (channelIndex);
-    peakLevel.updateLevel (measurement.peakLevel);
-    peakHoldLevel.updateLevel (measurement.peakLevel);
-    if (measurement.peakLevel >= LevelMeterConstants::kOverloadTriggerLevel)
-        overloaded = true;
+    return channelIndex;
+}
+
+void LevelMeter::Subscriber::updateWithStereoMeasurement (const StereoMeasurement& stereoMeasurement)
+{
+    mStereoSums.productSum += stereoMeasurement.productSum;
+    mStereoSums.leftSquareSum += stereoMeasurement.leftSquareSum;
+    mStereoSums.rightSquareSum += stereoMeasurement.rightSquareSum;
+}
+
+double LevelMeter::Subscriber::getCorrelation()
+{
+    // Below this amount of energy the signal is considered silent.
+    constexpr double kMinEnergy = 1.0e-10;
+
+    // The amount the correlation moves towards the new value each call.
+    constexpr double kSmoothing = 0.3;
+
+    auto const energy = std::sqrt (mStereoSums.leftSquareSum * mStereoSums.rightSquareSum);
+    auto const correlation = energy > kMinEnergy ? juce::jlimit (-1.0, 1.0, mStereoSums.productSum / energy) : 0.0;
+
+    mStereoSums = {};
+    mCorrelation += (correlation - mCorrelation) * kSmoothing;
+    return mCorrelation;
 }
 
 void LevelMeter::Subscriber::subscribeToLevelMeter (LevelMeter& levelMeter)
@@ -146,16 +1380,156 @@ void LevelMeter::Subscriber::subscribeToLevelMeter (LevelMeter& levelMeter)
 
 double LevelMeter::Subscriber::getPeakValue (int const channelIndex)
 {
-    if (juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
-        return mChannelData.getReference (channelIndex).peakLevel.getNextLevel();
-    return 0.0;
+    if (!juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
+        return 0.0;
+
+    if (mSampleRate > 0.0)
+    {
+        advanceDisplay();
+        return mDisplayedLevels[static_cast<size_t> (channelIndex)].peakLevel;
+    }
+
+    auto& channelData = mChannelData.getReference (channelIndex);
+    if (channelData.isIntegrated)
+        return getNextPeakLevel (channelData, 0.0);
+    return channelData.peakLevel.getNextLevel();
 }
 
 double LevelMeter::Subscriber::getPeakHoldValue (int const channelIndex)
 {
-    if (juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
-        return mChannelData.getReference (channelIndex).peakHoldLevel.getNextLevel();
-    return 0.0;
+    if (!juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
+        return 0.0;
+
+    if (mSampleRate > 0.0)
+    {
+        advanceDisplay();
+        return mDisplayedLevels[static_cast<size_t> (channelIndex)].peakHoldLevel;
+    }
+
+    return mChannelData.getReference (channelIndex).peakHoldLevel.getNextLevel();
+}
+
+void LevelMeter::Subscriber::setOutputLatency (double const latencySeconds)
+{
+    mOutputLatencySeconds = std::max (0.0, latencySeconds);
+}
+
+void LevelMeter::Subscriber::setChannelMap (const ChannelMap& channelMap)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    if (channelMap == mChannelMap)
+        return;
+
+    // The level meter recompiles on its next dispatch, until then its folded measurements get dropped.
+    mChannelMap = channelMap;
+    mCompiledChannelMapId = 0;
+    prepareToPlay (mNumLevelMeterChannels, mSampleRate);
+
+    if (mSubscribedLevelMeter != nullptr)
+        mSubscribedLevelMeter->mIsChannelMapDirty = true;
+}
+
+const ChannelMap& LevelMeter::Subscriber::getChannelMap() const
+{
+    return mChannelMap;
+}
+
+void LevelMeter::Subscriber::setClock (const MeterClock& clock)
+{
+    mMeterClock = &clock;
+
+    for (auto& ch : mChannelData)
+    {
+        ch.peakLevel.setClock (clock);
+        ch.peakHoldLevel.setClock (clock);
+    }
+
+    // The moments of the previous clock don't compare to the moments of this one, so observe the newest position
+    // again as if it arrived now.
+    mClock.reset();
+    mNewestSamplePositionTimeMs = clock.getTimeMs();
+    mHasNewSamplePosition = mNewestSamplePosition >= 0;
+    mLastAdvanceTimeMs = mNewestSamplePositionTimeMs - kMinAdvanceIntervalMs;
+}
+
+const MeterClock& LevelMeter::Subscriber::getClock() const
+{
+    return *mMeterClock;
+}
+
+void LevelMeter::Subscriber::advanceDisplay()
+{
+    auto const nowMs = mMeterClock->getTimeMs();
+
+    // All channels get advanced at once, so don't do it again for every channel being painted.
+    if (!mHasNewSamplePosition && nowMs - mLastAdvanceTimeMs < kMinAdvanceIntervalMs)
+        return;
+
+    mLastAdvanceTimeMs = nowMs;
+
+    if (std::exchange (mHasNewSamplePosition, false))
+        mClock.observe (mNewestSamplePosition, mNewestSamplePositionTimeMs);
+
+    if (!mClock.hasObservations())
+        return;
+
+    auto const displayPosition = mClock.getPosition (nowMs) - mOutputLatencySeconds * mSampleRate;
+
+    // Show the measurements which are due, letting the peak values decay by the distance between them.
+    while (mNumPending > 0)
+    {
+        auto const samplePosition = static_cast<double> (mPendingMeasurements[mPendingHead].samplePosition);
+
+        if (samplePosition > displayPosition)
+            break;
+
+        advanceDisplayTo (samplePosition);
+        applyOldestPendingMeasurement();
+    }
+
+    advanceDisplayTo (displayPosition);
+}
+
+void LevelMeter::Subscriber::advanceDisplayTo (double const samplePosition)
+{
+    auto const deltaTimeMs =
+        mDisplayPosition >= 0.0 ? std::max (0.0, samplePosition - mDisplayPosition) / mSampleRate * 1000.0 : 0.0;
+
+    for (size_t ch = 0; ch < mDisplayedLevels.size(); ch++)
+    {
+        auto& channelData = mChannelData.getReference (static_cast<int> (ch));
+        mDisplayedLevels[ch].peakLevel = getNextPeakLevel (channelData, deltaTimeMs);
+        mDisplayedLevels[ch].peakHoldLevel = channelData.peakHoldLevel.getNextLevel (deltaTimeMs);
+    }
+
+    mDisplayPosition = std::max (mDisplayPosition, samplePosition);
+}
+
+double LevelMeter::Subscriber::getNextPeakLevel (ChannelData& channelData, double const deltaTimeMs)
+{
+    if (!channelData.isIntegrated)
+        return channelData.peakLevel.getNextLevel (deltaTimeMs);
+
+    channelData.hasNewIntegratedLevel = false;
+    return channelData.integratedLevel;
+}
+
+void LevelMeter::Subscriber::flushPendingMeasurements()
+{
+    while (mNumPending > 0)
+        applyOldestPendingMeasurement();
+}
+
+void LevelMeter::Subscriber::applyOldestPendingMeasurement()
+{
+    jassert (mNumPending > 0);
+
+    auto const& measurement = mPendingMeasurements[mPendingHead];
+    mPendingHead = (mPendingHead + 1) % mPendingMeasurements.size();
+    --mNumPending;
+
+    applyMeasurement (measurement);
 }
 
 bool LevelMeter::Subscriber::isOverloaded (int const channelIndex) const
@@ -165,10 +1539,35 @@ bool LevelMeter::Subscriber::isOverloaded (int const channelIndex) const
     return false;
 }
 
+bool LevelMeter::Subscriber::isReducedAccuracy (int const channelIndex) const
+{
+    if (juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
+        return mChannelData.getReference (channelIndex).reducedAccuracy;
+    return false;
+}
+
+int64_t LevelMeter::Subscriber::getNumClipEvents (int const channelIndex) const
+{
+    if (juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
+        return mChannelData.getReference (channelIndex).numClipEvents;
+    return 0;
+}
+
+int64_t LevelMeter::Subscriber::getNumClippedSamples (int const channelIndex) const
+{
+    if (juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
+        return mChannelData.getReference (channelIndex).numClippedSamples;
+    return 0;
+}
+
 void LevelMeter::Subscriber::resetOverloaded()
 {
     for (auto& ch : mChannelData)
+    {
         ch.overloaded = false;
+        ch.numClipEvents = 0;
+        ch.numClippedSamples = 0;
+    }
 }
 
 const LevelMeter::Scale& LevelMeter::Subscriber::getScale() const
@@ -189,21 +1588,25 @@ int LevelMeter::Subscriber::getNumChannels() const
 
 void LevelMeter::Subscriber::setReturnRate (double const returnRateDbPerSecond)
 {
-    for (auto& [peakLevel, peakHoldLevel, overloaded] : mChannelData)
+    for (auto& ch : mChannelData)
     {
-        peakLevel.setReturnRate (returnRateDbPerSecond);
-        peakHoldLevel.setReturnRate (returnRateDbPerSecond);
+        ch.peakLevel.setReturnRate (returnRateDbPerSecond);
+        ch.peakHoldLevel.setReturnRate (returnRateDbPerSecond);
     }
 }
 
 void LevelMeter::Subscriber::setPeakHoldTimeMs (uint32_t const peakHoldTimeMs)
 {
-    for (auto& [peakLevel, peakHoldLevel, overloaded] : mChannelData)
-        peakHoldLevel.setPeakHoldTime (peakHoldTimeMs);
+    for (auto& ch : mChannelData)
+        ch.peakHoldLevel.setPeakHoldTime (peakHoldTimeMs);
 }
 
 void LevelMeter::Subscriber::unsubscribeFromLevelMeter()
 {
+    // The remaining subscribers might have a channel map in common now.
+    if (auto* levelMeter = std::exchange (mSubscribedLevelMeter, nullptr))
+        levelMeter->mIsChannelMapDirty = true;
+
     mSubscription.reset();
     reset();
 }
@@ -221,9 +1624,35 @@ void LevelMeter::Subscriber::reset()
         ch.peakLevel.reset();
         ch.peakHoldLevel.reset();
         ch.overloaded = false;
+        ch.reducedAccuracy = false;
+        ch.numClipEvents = 0;
+        ch.numClippedSamples = 0;
+        ch.integratedLevel = 0.0;
+        ch.hasNewIntegratedLevel = false;
+        ch.isIntegrated = false;
     }
 
+    mStereoSums = {};
+    mCorrelation = 0.0;
+
+    mClock.reset();
+    mPendingHead = 0;
+    mNumPending = 0;
+    mNewestSamplePosition = -1;
+    mHasNewSamplePosition = false;
+    mDisplayPosition = -1.0;
+    std::fill (mDisplayedLevels.begin(), mDisplayedLevels.end(), DisplayedLevels {});
+    mActiveChannels.clear();
+    std::fill (mIsActiveChannel.begin(), mIsActiveChannel.end(), false);
+
+    mIsResetting = true;
     measurementUpdatesFinished();
+    mIsResetting = false;
+}
+
+bool LevelMeter::Subscriber::isResetting() const
+{
+    return mIsResetting;
 }
 
 LevelMeter::Scale::Scale (double minusInfinityDb, std::initializer_list<double> divisions) :
@@ -1,8 +1,21 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <limits>
+#include <vector>
 
+#include "ChangedChannelsPublisher.h"
+#include "ChannelMap.h"
+#include "ClipDetector.h"
+#include "LevelMeterInstrumentation.h"
+#include "LevelMeterRegistry.h"
 #include "LevelPeakValue.h"
+#include "MeterClock.h"
+#include "SamplePositionClock.h"
+#include "juce-extensions/audio/analysis/AudioTap.h"
+#include "juce-extensions/audio/conversion/DownmixMatrix.h"
+#include "juce-extensions/core/TripleBuffer.h"
 #include "rdk/util/SubscriberList.h"
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_events/juce_events.h>
@@ -22,6 +35,95 @@ public:
     {
         int channelIndex = 0;
         double peakLevel = 0.0;
+        uint16_t blockInterval = 1; ///< Only every Nth block got measured, see LoadSheddingPolicy.
+        uint16_t sampleStride = 1;  ///< Only every Nth sample got inspected, see LoadSheddingPolicy.
+
+        /// The position (in samples since prepareToPlay()) of the end of the measured block, or -1 if unknown.
+        int64_t samplePosition = -1;
+
+        /// True if peakLevel is the reading of a ballistics integrator which ran on the audio thread (see
+        /// BallisticLevelMeter), which subscribers show as is instead of applying a return rate of their own.
+        bool isIntegrated = false;
+
+        /// Non-zero if channelIndex is a channel of the subscribers, because the level meter folded the channels on
+        /// the audio thread (see Subscriber::setChannelMap()). Identifies the compiled channel map.
+        uint32_t channelMapId = 0;
+
+        /// The epoch of the configuration of the level meter the measurement was taken with, see setNumChannels().
+        uint32_t epoch = 0;
+
+        /**
+         * @return True if this measurement was taken with reduced accuracy, because the level meter was shedding load.
+         */
+        [[nodiscard]] bool isReducedAccuracy() const
+        {
+            return blockInterval > 1 || sampleStride > 1;
+        }
+    };
+
+    /**
+     * Determines how measurements get from the audio thread to the subscribers.
+     */
+    enum class DispatchMode
+    {
+        /// Every measurement goes through a queue and gets handed to the subscribers. This is the default.
+        everyMeasurement,
+
+        /**
+         * The audio thread only keeps the highest peak per channel, in channel state owned by the LevelMeterRegistry.
+         * Every tick, subscribers get a single measurement per channel which measured anything since the previous
+         * tick. This keeps the cost per tick low and constant, which matters in sessions with many meters.
+         */
+        peakPerTick,
+
+        /**
+         * The audio thread only publishes the channels whose level changed meaningfully or crossed the floor of the
+         * scale (see ChangedChannelsPublisher), as a bitmask plus the packed levels per block. Channels which stay
+         * silent cost nothing after measuring, so the cost per tick depends on the number of active channels instead
+         * of the total number of channels. Integrated measurements (see BallisticLevelMeter) are all published.
+         */
+        changedChannels,
+    };
+
+    /**
+     * Describes how a level meter reduces its work on the audio thread once the load (see setLoad()) gets too high.
+     * The stereo analysis and the audio tap are not affected.
+     */
+    struct LoadSheddingPolicy
+    {
+        float loadThreshold = 0.8f; ///< The load at which shedding starts.
+        int blockInterval = 2;      ///< While shedding, only every Nth block gets measured.
+        int sampleStride = 4;       ///< While shedding, only every Nth sample gets inspected for its level.
+        bool skipWhenHidden = true; ///< While shedding, skip measuring while no subscriber is visible.
+    };
+
+    /**
+     * The sums needed to calculate the correlation between the left and right channel (the first two channels) over a
+     * block of audio.
+     */
+    struct StereoMeasurement
+    {
+        double productSum = 0.0;     ///< Sum of L * R.
+        double leftSquareSum = 0.0;  ///< Sum of L * L.
+        double rightSquareSum = 0.0; ///< Sum of R * R.
+    };
+
+    /// A run of clipped samples, see setClipDetectionEnabled().
+    using ClipEvent = ClipDetector::Event;
+
+    /// The number of points in a goniometer frame.
+    static constexpr int kNumGoniometerPoints = 512;
+
+    /// Only every Nth sample becomes a goniometer point.
+    static constexpr int kGoniometerDecimation = 4;
+
+    /**
+     * A fixed size set of (decimated) left and right sample values, for display on a goniometer (vectorscope).
+     */
+    struct GoniometerPoints
+    {
+        std::array<float, kNumGoniometerPoints> left {};
+        std::array<float, kNumGoniometerPoints> right {};
     };
 
     /**
@@ -98,6 +200,14 @@ public:
             LevelPeakValue<double> peakLevel;
             LevelPeakValue<double> peakHoldLevel;
             bool overloaded = false;
+            bool reducedAccuracy = false;
+            int64_t numClipEvents = 0;
+            int64_t numClippedSamples = 0;
+
+            /// The highest integrated reading since the peak value was last read, while measurements are integrated.
+            double integratedLevel = 0.0;
+            bool hasNewIntegratedLevel = false;
+            bool isIntegrated = false;
         };
 
         Subscriber() = delete;
@@ -107,8 +217,8 @@ public:
          * Constructor
          * @param scale The scale to use.
          * @param maxChannels Defines the max number of channels to display. If a meter has more channels then all
-         * channels will be folded into a single mono channel. The ensures that the meter will not display more channels
-         * then it can visually handle.
+         * channels will be folded into a single mono channel (unless a channel map was set, see setChannelMap()). The
+         * ensures that the meter will not display more channels then it can visually handle.
          */
         explicit Subscriber (const Scale& scale, int maxChannels = kDefaultMaxChannels);
 
@@ -118,8 +228,10 @@ public:
         /**
          * Prepared this subscriber for the amount of given channels.
          * @param numChannels Number of channels to prepare for.
+         * @param sampleRate The sample rate of the measured audio, or 0.0 if unknown. When known, the measurements
+         * are shown at the moment their audio is heard (see setOutputLatency()) instead of when they arrive.
          */
-        void prepareToPlay (int numChannels);
+        void prepareToPlay (int numChannels, double sampleRate = 0.0);
 
         /**
          * Adds a measurement which will update the channel data.
@@ -130,9 +242,42 @@ public:
         /**
          * Called when all measurements have been processed inside the timer callback.
          * Use this method to schedule any updates of UI.
+         * Also called by reset(), which isn't a tick of the level meter (see isResetting()).
          */
         virtual void measurementUpdatesFinished() {}
 
+        /**
+         * Adds a stereo measurement which will update the correlation. Only called when stereo analysis is enabled on
+         * the level meter.
+         * @param stereoMeasurement The measurement to add.
+         */
+        virtual void updateWithStereoMeasurement (const StereoMeasurement& stereoMeasurement);
+
+        /**
+         * Called when a new frame of goniometer points is available. Only called when stereo analysis is enabled on
+         * the level meter.
+         * @param goniometerPoints The points.
+         */
+        virtual void updateWithGoniometerPoints ([[maybe_unused]] const GoniometerPoints& goniometerPoints) {}
+
+        /**
+         * Adds a clip event which will update the clip counts of its channel. Only called when clip detection is
+         * enabled on the level meter.
+         * @param clipEvent The clip event to add.
+         */
+        virtual void updateWithClipEvent (const ClipEvent& clipEvent);
+
+        /**
+         * Tells the level meter whether this subscriber currently shows its measurements (for example because it's a
+         * component on screen). While shedding load, a level meter may stop measuring when none of its subscribers
+         * are visible.
+         * @return True if showing its measurements, which is the default.
+         */
+        [[nodiscard]] virtual bool isShowingMeasurements() const
+        {
+            return true;
+        }
+
         /**
          * Resets the current data to zero (or -inf) and calls measurementUpdatesFinished() to allow the subscriber to
          * update itself.
@@ -164,6 +309,12 @@ public:
          */
         virtual void levelMeterPrepared (int numChannels) = 0;
 
+        /**
+         * @return True while reset() calls measurementUpdatesFinished(), as opposed to a dispatch of the level meter.
+         * Subscribers which count ticks (like LevelHistory) don't count these calls.
+         */
+        [[nodiscard]] bool isResetting() const;
+
         /**
          * @param channelIndex The index of the channel to get the value for.
          * @return The current peak value for given channel index.
@@ -184,10 +335,54 @@ public:
         [[nodiscard]] bool isOverloaded (int channelIndex) const;
 
         /**
-         * Turns off the overloaded flag.
+         * @param channelIndex The index of the channel.
+         * @return True if the last measurement for given channel was taken with reduced accuracy, because the level
+         * meter was shedding load.
+         */
+        [[nodiscard]] bool isReducedAccuracy (int channelIndex) const;
+
+        /**
+         * @param channelIndex The index of the channel.
+         * @return The number of clip events for given channel since the last reset, see
+         * LevelMeter::setClipDetectionEnabled().
+         */
+        [[nodiscard]] int64_t getNumClipEvents (int channelIndex) const;
+
+        /**
+         * @param channelIndex The index of the channel.
+         * @return The total length of the clip events for given channel since the last reset.
+         */
+        [[nodiscard]] int64_t getNumClippedSamples (int channelIndex) const;
+
+        /**
+         * Turns off the overloaded flag and resets the clip counts.
          */
         void resetOverloaded();
 
+        /**
+         * Finds out whether all channels show silence, meaning their peak and peak hold values are at the bottom of
+         * the scale. Only looks at the channels which received a level above the bottom since they were last found
+         * silent, so the cost depends on the number of active channels instead of the total number of channels.
+         * @return True if all channels show silence.
+         */
+        bool isSilent();
+
+        /**
+         * Finds the channel of this subscriber which given measurement belongs to, taking into account that channels
+         * might be folded into a single mono channel.
+         * @param measurement The measurement.
+         * @return The channel index, or -1 if the measurement doesn't belong to any channel.
+         */
+        [[nodiscard]] int getChannelIndexForMeasurement (const Measurement& measurement) const;
+
+        /**
+         * Finds the channel of this subscriber which given channel of the level meter belongs to, taking into account
+         * that channels might be folded into a single mono channel.
+         * @param levelMeterChannelIndex The index of the channel of the level meter.
+         * @return The channel index, or -1 if the channel doesn't belong to any channel.
+         */
+        [[nodiscard]] int getChannelIndexForLevelMeterChannel (int levelMeterChannelIndex) const;
+
         /**
          * @return The current scale for this subscriber.
          */
@@ -209,30 +404,228 @@ public:
          */
         void setPeakHoldTimeMs (uint32_t peakHoldTimeMs);
 
+        /**
+         * Calculates the correlation between the left and right channel over the stereo measurements received since
+         * the previous call, smoothed over time.
+         * @return The correlation [-1.0, 1.0], or 0.0 when there was no signal.
+         */
+        double getCorrelation();
+
+        /**
+         * Sets the time between measuring a block and hearing it, for example the latency of the audio device. Each
+         * measurement gets held back until the stream has played up to its position plus this latency, and the peak
+         * values decay by the distance in samples between measurements. This makes the meter follow the audio
+         * instead of the timing of the audio callbacks, whatever the buffer size. Only has effect when the level
+         * meter was prepared with a sample rate.
+         * @param latencySeconds The latency in seconds.
+         */
+        void setOutputLatency (double latencySeconds);
+
+        /**
+         * Sets which channels of the level meter to show and how to fold them into the channels of this subscriber,
+         * after which the subscriber gets prepared again. While all subscribers of a level meter use the same map, the
+         * level meter folds the channels on the audio thread, so that only the folded levels go through the queue and
+         * get handed to the subscribers. Otherwise the folding is done here, as measurements arrive.
+         * Must be called from the message thread.
+         * @param channelMap The map. The identity map restores folding into a single mono channel when the level meter
+         * has more than the max number of channels.
+         */
+        void setChannelMap (const ChannelMap& channelMap);
+
+        /**
+         * @return The channel map set with setChannelMap().
+         */
+        [[nodiscard]] const ChannelMap& getChannelMap() const;
+
+        /**
+         * Sets the clock which drives the ballistics of this subscriber: the decay and hold of the peak values, and
+         * the moments measurements get shown when the level meter was prepared with a sample rate. The system clock is
+         * used by default, a VirtualMeterClock lets the subscriber run faster (or slower) than realtime.
+         * Must be called from the thread which reads this subscriber, which is the message thread when it's subscribed
+         * to a level meter.
+         * @param clock The clock. Must outlive this subscriber.
+         */
+        void setClock (const MeterClock& clock);
+
+        /**
+         * @return The clock set with setClock().
+         */
+        [[nodiscard]] const MeterClock& getClock() const;
+
     private:
+        /// Compiles the channel maps of its subscribers.
+        friend class LevelMeter;
+
+        /// Channels whose proportion of the scale is at or below this value show silence.
+        static constexpr double kSilenceProportion = 0.001;
+
+        /// The max number of measurements to hold back, after which the oldest get shown early.
+        static constexpr size_t kMaxPendingMeasurements = 4096;
+
+        /// Showing the measurements is done at most once per this interval, since all channels get advanced at once.
+        static constexpr double kMinAdvanceIntervalMs = 1.0;
+
+        /**
+         * The values currently shown for a channel, when showing measurements by their sample position.
+         */
+        struct DisplayedLevels
+        {
+            double peakLevel = 0.0;
+            double peakHoldLevel = 0.0;
+        };
+
         const Scale& mScale;
         rdk::Subscription mSubscription;
         juce::Array<ChannelData> mChannelData;
         double mReturnRateDbPerSecond = LevelMeterConstants::kDefaultReturnRate;
+        StereoMeasurement mStereoSums;
+        double mCorrelation = 0.0;
         int mMaxChannels = kDefaultMaxChannels;
+
+        /// The map set by the user, and the map in effect for the current number of channels of the level meter.
+        ChannelMap mChannelMap;
+        ChannelMap mEffectiveChannelMap;
+
+        /// The number of channels of the level meter, as opposed to the number of channels of this subscriber.
+        int mNumLevelMeterChannels = 0;
+
+        /// The id of the channel map which the level meter currently folds with for this subscriber, 0 if none.
+        uint32_t mCompiledChannelMapId = 0;
+
+        /// The level meter this subscriber was most recently subscribed to, to tell it when the channel map changes.
+        LevelMeter* mSubscribedLevelMeter = nullptr;
+
+        /// True while reset() calls measurementUpdatesFinished().
+        bool mIsResetting = false;
+
+        /// The sample rate of the measured audio, 0.0 when the measurements get shown as they arrive.
+        double mSampleRate = 0.0;
+        double mOutputLatencySeconds = 0.0;
+        SamplePositionClock mClock;
+
+        /// The clock which measurements arrive and get shown by.
+        const MeterClock* mMeterClock = &MeterClock::getSystemClock();
+
+        /// The measurements being held back, as a ring of kMaxPendingMeasurements allocated by prepareToPlay().
+        std::vector<Measurement> mPendingMeasurements;
+        size_t mPendingHead = 0;
+        size_t mNumPending = 0;
+
+        /// The position of the newest measurement, and when it arrived, not yet observed by the clock.
+        int64_t mNewestSamplePosition = -1;
+        double mNewestSamplePositionTimeMs = 0.0;
+        bool mHasNewSamplePosition = false;
+
+        /// The position up to which the measurements are shown, -1.0 if none yet.
+        double mDisplayPosition = -1.0;
+        double mLastAdvanceTimeMs = 0.0;
+        std::vector<DisplayedLevels> mDisplayedLevels;
+
+        /// The channels which might not show silence, and a flag per channel telling whether it's one of them.
+        std::vector<int> mActiveChannels;
+        std::vector<bool> mIsActiveChannel;
+
+        /**
+         * Applies a measurement to the channel data.
+         */
+        void applyMeasurement (const Measurement& measurement);
+
+        /**
+         * Shows the measurements up to the current position of the stream, minus the output latency.
+         */
+        void advanceDisplay();
+
+        /**
+         * Lets the peak values decay up to given position.
+         */
+        void advanceDisplayTo (double samplePosition);
+
+        /**
+         * Applies all held back measurements at once.
+         */
+        void flushPendingMeasurements();
+
+        /**
+         * Removes the oldest held back measurement and applies it.
+         */
+        void applyOldestPendingMeasurement();
+
+        /**
+         * @return The next peak value to show for a channel, after given amount of time.
+         */
+        static double getNextPeakLevel (ChannelData& channelData, double deltaTimeMs);
     };
 
     LevelMeter();
-    ~LevelMeter();
+    virtual ~LevelMeter();
 
     JUCE_DECLARE_NON_COPYABLE (LevelMeter)
     JUCE_DECLARE_NON_MOVEABLE (LevelMeter)
 
+    /// Measures on behalf of level meters, sharing their sample position and subscribers.
+    friend class LevelMeterBatch;
+
+    /// Dispatches regular level meters in passes (see LevelMeterRegistry::DispatchKind).
+    friend class LevelMeterRegistry;
+
     /**
-     * Prepares the meter for the amount of channels given.
+     * Prepares the meter for the amount of channels given, keeping the sample rate of a previous call.
      * @param numChannels Number of channels to prepare for.
      */
     void prepareToPlay (int numChannels);
 
+    /**
+     * Prepares the meter for the amount of channels and sample rate given. Every measurement carries the position of
+     * the measured audio in samples since this call, which lets subscribers show it in step with what's heard (see
+     * Subscriber::setOutputLatency()). Grows the storage for channels when needed (see setMaxNumChannels()).
+     * Must not be called while audio is being measured, but can be called from any thread. When called from the
+     * message thread the subscribers get prepared right away, otherwise on the next dispatch.
+     * @param numChannels Number of channels to prepare for.
+     * @param sampleRate The sample rate of the audio to measure.
+     */
+    void prepareToPlay (int numChannels, double sampleRate);
+
+    /**
+     * Allocates the storage of the audio thread for given number of channels, so that setNumChannels() can switch to
+     * any number of channels up to it without allocating. The storage gets replaced while the message thread might be
+     * dispatching, which frees the previous storage on its next dispatch.
+     * Can be called from any thread, but not while audio is being measured.
+     * @param maxNumChannels The max number of channels.
+     */
+    void setMaxNumChannels (int maxNumChannels);
+
+    /**
+     * Switches to another number of channels while audio is being measured. This publishes a new configuration,
+     * tagged with a new epoch, which the audio thread picks up at its next block. Measurements taken with an older
+     * configuration are discarded when dispatching, after the subscribers got prepared for the new number of channels
+     * on the message thread. Nothing gets drained, resized or waited for by the calling thread.
+     * Calling this method is realtime safe and can be done from any thread, including the audio thread.
+     * @param numChannels The number of channels, limited to the max number of channels (see setMaxNumChannels()).
+     */
+    void setNumChannels (int numChannels);
+
+    /**
+     * @return The sample rate this level meter was prepared for, or 0.0 if unknown. Must be called from the message
+     * thread.
+     */
+    [[nodiscard]] double getSampleRate() const;
+
+    /**
+     * @return The number of channels the subscribers of this level meter are currently prepared for. Must be called
+     * from the message thread.
+     */
+    [[nodiscard]] int getNumChannels() const;
+
+    /**
+     * @return The number of channels the storage of the audio thread is allocated for.
+     */
+    [[nodiscard]] int getMaxNumChannels() const;
+
     /**
      * Measures a block of audio and sends the measurement to a queue.
      * Calling this method is realtime safe as long as being called from a single thread.
      * When the queue is full the measurement will be lost.
+     * While shedding load (see setLoadSheddingPolicy()), blocks may be skipped or measured with reduced accuracy.
      * @tparam SampleType The type of the audio sample.
      * @param audioBuffer The audio buffer to take the measurement from.
      */
@@ -243,12 +636,46 @@ public:
      * Measures a block of audio and sends the measurement to a queue.
      * Calling this method is realtime safe as long as being called from a single thread.
      * When the queue is full the measurement will be lost.
+     * While shedding load (see setLoadSheddingPolicy()), blocks may be skipped or measured with reduced accuracy.
      * @tparam SampleType The type of the audio sample.
      * @param inputChannelData The audio data to take the measurement from.
      */
     template <typename SampleType>
     void measureBlock (const SampleType* const* inputChannelData, int numChannels, int numSamples);
 
+    /**
+     * Converts and adds the channels from src to dst (see addConvertChannels()) and measures dst, in a single pass.
+     * Each output channel gets measured directly after it has been written, while its samples are still in cache. The
+     * result is the same as calling addConvertChannels() followed by measureBlock (dst).
+     * Calling this method is realtime safe as long as being called from a single thread.
+     * While shedding load (see setLoadSheddingPolicy()), blocks may be converted without being measured. Measured
+     * blocks are always inspected sample by sample, because the conversion has to touch every sample anyway.
+     * @tparam SrcType The type of the source samples (float or double).
+     * @tparam SampleType The type of the audio sample.
+     * @param src The source channels.
+     * @param dst The destination channels, which are also the channels being measured.
+     * @return True if all input channels were converted to one or more output channels, or false if at least one input
+     * channel got lost.
+     */
+    template <typename SrcType, typename SampleType>
+    bool addConvertChannelsAndMeasureBlock (const juce::AudioBuffer<SrcType>& src, juce::AudioBuffer<SampleType>& dst);
+
+    /**
+     * Measures a downmix of given audio, without writing the downmix to a buffer. The meter should be prepared for the
+     * number of output channels of the downmix.
+     * Calling this method is realtime safe as long as being called from a single thread.
+     * While shedding load (see setLoadSheddingPolicy()), blocks may be skipped. Measured blocks are always inspected
+     * sample by sample, because calculating the downmix costs more than inspecting its samples.
+     * The downmix only exists a chunk of a single channel at a time, so it doesn't get pushed into the audio tap (see
+     * getAudioTap()) and doesn't feed the stereo analysis (see setStereoAnalysisEnabled()). Clip detection does run on
+     * the downmix. Write the downmix into a buffer and use measureBlock() when those are needed.
+     * @tparam SampleType The type of the audio sample.
+     * @param audioBuffer The audio buffer to take the measurement from.
+     * @param downmix The downmix to measure. Input channels which are not part of audioBuffer are ignored.
+     */
+    template <typename SampleType>
+    void measureDownmix (const juce::AudioBuffer<SampleType>& audioBuffer, const DownmixMatrix& downmix);
+
     /**
      * Subscribes given subscriber to this LevelMeter.
      * @param subscriber The subscriber to add.
@@ -256,76 +683,546 @@ public:
      */
     rdk::Subscription subscribe (Subscriber* subscriber);
 
+    /**
+     * Returns the audio tap of this level meter, creating it if it doesn't exist yet. Once the tap is activated, every
+     * measured block gets pushed into it, which allows a consumer on another thread (like SpectrumAnalyser) to get to
+     * the audio itself. Blocks measured with measureDownmix() are the exception. The tap lives as long as this level
+     * meter.
+     * Must be called from the message thread.
+     * @return The audio tap.
+     */
+    AudioTap& getAudioTap();
+
+    /**
+     * Enables or disables stereo analysis. While enabled, every block with at least two channels measured with
+     * measureBlock() also produces a StereoMeasurement for the first two channels (computed in the same pass as their
+     * peak levels) and a decimated stream of goniometer points, which are handed to the subscribers. The other ways of
+     * measuring (addConvertChannelsAndMeasureBlock(), measureDownmix()) don't feed the stereo analysis.
+     * Must be called from the message thread.
+     * @param shouldBeEnabled True to enable stereo analysis.
+     */
+    void setStereoAnalysisEnabled (bool shouldBeEnabled);
+
+    /**
+     * @return The number of stereo measurements which were lost because the subscribers didn't keep up, which is 0 if
+     * stereo analysis was never enabled. Can be called from any thread.
+     */
+    [[nodiscard]] uint64_t getNumLostStereoMeasurements() const;
+
+    /**
+     * Enables or disables sample accurate clip detection. While enabled, every measured channel gets scanned for runs
+     * of consecutive clipped samples (see ClipDetector), which are handed to the subscribers as clip events.
+     * Scanning skips blocks whose peak level is below the clip level, so its cost is low while nothing clips.
+     * Must be called from the message thread.
+     * @param shouldBeEnabled True to enable clip detection.
+     * @param options The clip level and minimum run length. The queue capacity only applies when first enabled.
+     */
+    void setClipDetectionEnabled (
+        bool shouldBeEnabled,
+        const ClipDetector::Options& options = ClipDetector::Options::getDefault());
+
+    /**
+     * @return The number of clip events which were lost because the subscribers didn't keep up, which is 0 if clip
+     * detection was never enabled. Can be called from any thread.
+     */
+    [[nodiscard]] uint64_t getNumLostClipEvents() const;
+
+    /**
+     * Sets how measurements get from the audio thread to the subscribers. Must be called from the message thread,
+     * while no audio is being measured (like prepareToPlay()).
+     * @param dispatchMode The mode.
+     */
+    void setDispatchMode (DispatchMode dispatchMode);
+
+    /**
+     * Sets the policy to use for shedding load. Load shedding is off until a policy is set.
+     * Must be called from the message thread.
+     * @param policy The policy.
+     */
+    void setLoadSheddingPolicy (const LoadSheddingPolicy& policy);
+
+    /**
+     * Sets the current load of the audio thread, as estimated by the caller (for example the fraction of the time
+     * available for the audio callback which was used by the previous callback). Which amount of work measureBlock()
+     * sheds depends on this value and the policy (see setLoadSheddingPolicy()).
+     * Calling this method is realtime safe and can be done from any thread.
+     * @param load The load [0.0, 1.0].
+     */
+    void setLoad (float load);
+
+    /**
+     * Enables or disables the instrumentation of this level meter, which records the cost of the measure calls on the
+     * audio thread and the state of the measurement queue (see LevelMeterInstrumentation). While disabled, the only
+     * cost on the audio thread is a single branch per call. The recorded statistics are kept when disabling.
+     * Must be called from the message thread.
+     * @param shouldBeEnabled True to enable the instrumentation.
+     */
+    void setInstrumentationEnabled (bool shouldBeEnabled);
+
+    /**
+     * Returns the statistics recorded by the instrumentation. Can be called from any thread.
+     * @return The statistics, which are all zero if the instrumentation was never enabled.
+     */
+    [[nodiscard]] LevelMeterInstrumentation::Statistics getInstrumentationStatistics() const;
+
+    /**
+     * Hands all pending measurements to the subscribers. It can be called manually to drive the meter without a
+     * running message loop (for example when benchmarking). The LevelMeterRegistry only calls it for subclasses which
+     * were constructed with another than the regular LevelMeterRegistry::DispatchKind, so subclasses which override
+     * it must pass one to the constructor.
+     * Must be called from the message thread.
+     */
+    virtual void dispatchMeasurements();
+
+protected:
+    /**
+     * Constructor.
+     * @param dispatchKind How the registry dispatches this level meter, which must not be regular for subclasses
+     * which override dispatchMeasurements().
+     */
+    explicit LevelMeter (LevelMeterRegistry::DispatchKind dispatchKind);
+
+    /**
+     * Hands a single measurement to the subscribers. Must be called from the message thread.
+     * @param measurement The measurement.
+     */
+    void dispatchToSubscribers (const Measurement& measurement);
+
+    /**
+     * @return The registry this level meter is registered with.
+     */
+    LevelMeterRegistry& getRegistry();
+
+    /**
+     * Called at the end of every call to prepareToPlay() and setMaxNumChannels(), for subclasses which keep audio
+     * thread state of their own.
+     * @param numChannels The number of channels to allocate for, which is the max number of channels.
+     * @param sampleRate The sample rate, or 0.0 if unknown.
+     */
+    virtual void preparedToPlay ([[maybe_unused]] int numChannels, [[maybe_unused]] double sampleRate) {}
+
+    /**
+     * @return The instrumentation while enabled, or nullptr. For use on the audio thread.
+     */
+    [[nodiscard]] LevelMeterInstrumentation* getActiveInstrumentation() const;
+
+    /**
+     * Advances the sample position by a measured block and picks up the latest configuration (see setNumChannels()).
+     * Called by the audio thread once per block, also for blocks which get skipped. Measurements of channels beyond
+     * the number of channels of that configuration are dropped by pushMeasurement().
+     * @param numSamples The number of samples in the block.
+     * @return The position of the end of the block.
+     */
+    int64_t advanceSamplePosition (int numSamples);
+
+    /**
+     * Customisation point for subclasses which integrate the audio instead of measuring block peaks (like
+     * BallisticLevelMeter). While this returns true, every measuring method (including
+     * addConvertChannelsAndMeasureBlock(), measureDownmix() and LevelMeterBatch) hands the samples of every channel to
+     * integrateChannel() and pushes the highest reading as an integrated measurement. Integrating doesn't shed load,
+     * push into the audio tap, feed the stereo analysis or detect clips. Called by the audio thread.
+     * @return True if this level meter integrates.
+     */
+    [[nodiscard]] virtual bool isIntegrating() const { return false; }
+
+    /**
+     * Integrates the next samples of a channel, only called while isIntegrating() returns true. Called by the audio
+     * thread.
+     * @param channelIndex The index of the channel.
+     * @param samples The samples, which follow the samples of the previous call for this channel.
+     * @param numSamples The number of samples.
+     * @return The highest reading while integrating the samples.
+     */
+    virtual double integrateChannel (
+        [[maybe_unused]] int channelIndex,
+        [[maybe_unused]] const float* samples,
+        [[maybe_unused]] int numSamples)
+    {
+        return 0.0;
+    }
+
+    /**
+     * Integrates the next samples of a channel, only called while isIntegrating() returns true. Called by the audio
+     * thread.
+     * @param channelIndex The index of the channel.
+     * @param samples The samples, which follow the samples of the previous call for this channel.
+     * @param numSamples The number of samples.
+     * @return The highest reading while integrating the samples.
+     */
+    virtual double integrateChannel (
+        [[maybe_unused]] int channelIndex,
+        [[maybe_unused]] const double* samples,
+        [[maybe_unused]] int numSamples)
+    {
+        return 0.0;
+    }
+
+    /**
+     * Pushes a single measurement into the queue.
+     * @param measurement The measurement to push.
+     * @param instrumentation The instrumentation to record the state of the queue in, or nullptr if disabled.
+     */
+    void pushMeasurement (Measurement&& measurement, LevelMeterInstrumentation* instrumentation);
+
 private:
+    /// The number of samples of a downmix which get calculated at once, on the stack.
+    static constexpr int kDownmixChunkSize = 256;
+
     /**
-     * A timer which is used by all instances of LevelMeter to synchronize all repaints. This keeps the meters steady.
+     * The state of the load shedding. The policy is written by the message thread, the load by any thread and the
+     * rest is only accessed by the audio thread, unless noted otherwise.
      */
-    class SharedTimer : private juce::Timer
+    struct LoadShedding
     {
-    public:
-        SharedTimer() = default;
-        ~SharedTimer() override
-        {
-            stopTimer(); // Paranoia.
-        }
+        std::atomic<float> load { 0.0f };
+        std::atomic<float> loadThreshold { std::numeric_limits<float>::infinity() };
+        std::atomic<int> blockInterval { 1 };
+        std::atomic<int> sampleStride { 1 };
+        std::atomic<bool> skipWhenHidden { false };
+
+        /// Set by the message thread, true if at least one subscriber is visible.
+        std::atomic<bool> hasVisibleSubscribers { true };
+
+        /// Counts the blocks up to the next block to measure.
+        int blockCounter = 0;
+
+        /// The first sample to inspect when striding, which moves every block so that all samples get their turn.
+        int strideOffset = 0;
+    };
+
+    /**
+     * The amount of work to shed for a single block.
+     */
+    struct SheddingDecision
+    {
+        bool skipBlock = false;
+        uint16_t blockInterval = 1;
+        uint16_t sampleStride = 1;
+        int strideOffset = 0;
+    };
+
+    /**
+     * State for the stereo analysis, which only gets allocated once stereo analysis gets enabled.
+     */
+    struct StereoAnalysis
+    {
+        std::atomic<bool> isEnabled { false };
+
+        /// Holds the available stereo measurements.
+        moodycamel::ReaderWriterQueue<StereoMeasurement> measurements { 100 }; // Arbitrary amount.
+
+        /// The number of stereo measurements which didn't fit in the queue.
+        std::atomic<uint64_t> numLostMeasurements { 0 };
+
+        /// Hands complete frames of goniometer points to the message thread.
+        TripleBuffer<GoniometerPoints> goniometerPoints;
+
+        /// The next point to write in the current frame, only accessed by the audio thread.
+        int goniometerWriteIndex = 0;
 
-        JUCE_DECLARE_NON_COPYABLE (SharedTimer)
-        JUCE_DECLARE_NON_MOVEABLE (SharedTimer)
+        /// The offset of the next sample to take a point from, only accessed by the audio thread.
+        int goniometerSampleOffset = 0;
 
         /**
-         * Subscribes given level meter to this timer.
-         * @param levelMeter The level meter to subscribe.
+         * Adds decimated points to the current goniometer frame, publishing every frame which completes.
          */
-        void subscribe (LevelMeter& levelMeter)
-        {
-            // Set the timer going if we're about to subscribe the first subscriber.
-            if (mSubscribers.get_num_subscribers() == 0)
-                startTimerHz (LevelMeterConstants::kRefreshRateHz);
+        template <typename SampleType>
+        void addGoniometerPoints (const SampleType* left, const SampleType* right, int numSamples);
+    };
 
-            levelMeter.mSharedTimerSubscription = mSubscribers.add (&levelMeter);
-        }
+    /**
+     * A run of channel slots allocated from the registry, which gets published to the audio thread as a whole so that
+     * the slots and their number always match.
+     */
+    struct ChannelSlots
+    {
+        LevelMeterRegistry::ChannelSlot* slots = nullptr;
+        int numChannels = 0;
+    };
 
-    private:
-        rdk::SubscriberList<LevelMeter> mSubscribers;
+    /**
+     * A channel map compiled for the audio thread, which gets shared by all subscribers of the level meter.
+     */
+    struct CompiledChannelMap
+    {
+        uint32_t id = 0;
+        ChannelMap channelMap;
+        int numInputChannels = 0;
 
-        void timerCallback() override
-        {
-            // Stop timer if there are no subscribers.
-            if (mSubscribers.get_num_subscribers() == 0)
-                stopTimer();
+        /// The output channel for every input channel, -1 for channels which aren't measured.
+        std::vector<int> outputChannels;
 
-            mSubscribers.call ([] (LevelMeter& s) {
-                s.timerCallback();
-            });
-        }
+        /// The peak level of every output channel while measuring a block, only accessed by the audio thread.
+        std::vector<double> outputPeaks;
+
+        /**
+         * @return The output channel of given input channel, or -1 if it isn't measured.
+         */
+        [[nodiscard]] int getOutputChannel (int inputChannel) const;
     };
 
-    /// Data cached from the call to prepareToPlay
+    /**
+     * Gives the audio thread access to the published channel map for the duration of a block. The message thread only
+     * destroys a retired map once the audio thread isn't using it.
+     */
+    class ScopedChannelMap
+    {
+    public:
+        explicit ScopedChannelMap (LevelMeter& levelMeter);
+        ~ScopedChannelMap();
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedChannelMap)
+        JUCE_DECLARE_NON_MOVEABLE (ScopedChannelMap)
+
+        [[nodiscard]] CompiledChannelMap* get() const;
+
+    private:
+        LevelMeter& mLevelMeter;
+        CompiledChannelMap* mChannelMap = nullptr;
+    };
+
+    /// The configuration the subscribers are prepared for, only accessed by the message thread.
     struct PreparedToPlayInfo
     {
         int numChannels = 2;
+        double sampleRate = 0.0;
+        uint32_t epoch = 0;
     } mPreparedToPlayInfo;
 
+    /// The latest configuration: the epoch in the upper 32 bits and the number of channels in the lower 32 bits.
+    /// Every change gets a new epoch.
+    std::atomic<uint64_t> mConfiguration { 2 };
+
+    /// The sample rate of the latest configuration.
+    std::atomic<double> mSampleRate { 0.0 };
+
+    /// The number of channels the storage of the audio thread is allocated for. Only written by the message thread,
+    /// but read by setNumChannels() on any thread.
+    std::atomic<int> mMaxNumChannels { 2 };
+
+    /// The epoch and number of channels of the configuration the audio thread measures with, only accessed by the
+    /// audio thread.
+    uint32_t mMeasuringEpoch = 0;
+    int mMeasuringNumChannels = 2;
+
+    /// The position of the next sample to measure, only accessed by the audio thread.
+    int64_t mSamplePosition = 0;
+
+    /// The position of the end of the latest measured block, for stamping the measurements taken from channel slots.
+    std::atomic<int64_t> mLatestSamplePosition { -1 };
+
     /// Holds subscribers to this level meter.
     rdk::SubscriberList<Subscriber> mSubscribers;
 
     /// Holds the available measurements.
     moodycamel::ReaderWriterQueue<Measurement> mMeasurements { 100 }; // Arbitrary amount.
 
-    /// Holds the globally shared timer.
-    juce::SharedResourcePointer<SharedTimer> mSharedTimer;
+    /// Owns the audio tap, once created.
+    std::unique_ptr<AudioTap> mAudioTapStorage;
+
+    /// Points to the audio tap once created, for use on the audio thread.
+    std::atomic<AudioTap*> mAudioTap { nullptr };
+
+    /// Owns the stereo analysis state, once created.
+    std::unique_ptr<StereoAnalysis> mStereoAnalysisStorage;
+
+    /// Points to the stereo analysis state once created, for use on the audio thread.
+    std::atomic<StereoAnalysis*> mStereoAnalysis { nullptr };
+
+    /// Owns the clip detector, once created.
+    std::unique_ptr<ClipDetector> mClipDetectorStorage;
+
+    /// Points to the clip detector while enabled, for use on the audio thread.
+    std::atomic<ClipDetector*> mClipDetector { nullptr };
+
+    /// Points to the clip detector once created, for reading the statistics from any thread.
+    std::atomic<ClipDetector*> mClipDetectorForReading { nullptr };
+
+    /// Owns the published channel map and the retired ones which might still be in use by the audio thread.
+    std::vector<std::unique_ptr<CompiledChannelMap>> mChannelMapStorage;
 
-    /// Holds the subscription to the shared timer.
-    rdk::Subscription mSharedTimerSubscription;
+    /// Points to the channel map to fold with, or nullptr to measure every channel as is.
+    std::atomic<CompiledChannelMap*> mChannelMap { nullptr };
+
+    /// Points to the channel map the audio thread is using, or nullptr while not measuring.
+    std::atomic<CompiledChannelMap*> mChannelMapInUse { nullptr };
+
+    /// The id of the next channel map to compile.
+    uint32_t mNextChannelMapId = 1;
+
+    /// True when something happened which might change the common channel map of the subscribers: a subscriber
+    /// joined, left or changed its channel map, or the configuration or dispatch mode changed.
+    bool mIsChannelMapDirty = true;
+
+    /// Holds the load shedding policy and state.
+    LoadShedding mLoadShedding;
+
+    /// Owns the instrumentation, once created.
+    std::unique_ptr<LevelMeterInstrumentation> mInstrumentationStorage;
+
+    /// Points to the instrumentation while enabled, for use on the audio thread.
+    std::atomic<LevelMeterInstrumentation*> mInstrumentation { nullptr };
+
+    /// Points to the instrumentation once created, for reading the statistics from any thread.
+    std::atomic<LevelMeterInstrumentation*> mInstrumentationForReading { nullptr };
+
+    /// How the registry dispatches this level meter.
+    LevelMeterRegistry::DispatchKind mDispatchKind = LevelMeterRegistry::DispatchKind::regular;
+
+    /// The current dispatch mode.
+    DispatchMode mDispatchMode = DispatchMode::everyMeasurement;
+
+    /// Guards replacing the storage of the audio thread, which prepareToPlay() might do from another thread than the
+    /// message thread.
+    juce::CriticalSection mStorageLock;
+
+    /// Owns the channel state allocated from the registry, only when dispatching a peak per tick.
+    std::unique_ptr<ChannelSlots> mChannelSlotsStorage;
+
+    /// Points to the channel state (together with its size) for use on the audio and message thread, or nullptr.
+    std::atomic<ChannelSlots*> mChannelSlots { nullptr };
+
+    /// Owns the changed channels publisher, only when dispatching changed channels.
+    std::unique_ptr<ChangedChannelsPublisher> mChangedChannelsStorage;
+
+    /// Points to the changed channels publisher for use on the audio and message thread, or nullptr.
+    std::atomic<ChangedChannelsPublisher*> mChangedChannels { nullptr };
+
+    /// The replaced storage, which the message thread might still be dispatching from. Guarded by mStorageLock.
+    std::vector<std::unique_ptr<ChannelSlots>> mRetiredChannelSlots;
+    std::vector<std::unique_ptr<ChangedChannelsPublisher>> mRetiredChangedChannels;
+
+    /// True when there is retired storage, so that dispatching doesn't need to take the lock to find out.
+    std::atomic<bool> mHasRetiredStorage { false };
+
+    /// Holds the registry, which is shared by all level meters to synchronize all repaints (this keeps the meters
+    /// steady).
+    juce::SharedResourcePointer<LevelMeterRegistry> mRegistry;
 
     /**
-     * Pushes a single measurement into the queue.
-     * @param measurement The measurement to push.
+     * Finds the peak level of given samples.
+     * @param channelData The samples.
+     * @param numSamples The number of samples.
+     * @return The peak level.
      */
-    void pushMeasurement (Measurement&& measurement);
+    template <typename SampleType>
+    static SampleType findPeakLevel (const SampleType* channelData, int numSamples);
 
     /**
-     * Called by the shared timer.
+     * Finds the peak level of a channel by inspecting only every Nth sample.
+     * @param channelData The channel data.
+     * @param numSamples The number of samples.
+     * @param stride Only every stride-th sample is inspected.
+     * @param offset The first sample to inspect.
+     * @return The peak level of the inspected samples.
      */
-    void timerCallback();
+    template <typename SampleType>
+    static SampleType findPeakLevelStrided (const SampleType* channelData, int numSamples, int stride, int offset);
+
+    /**
+     * Integrates every channel of a block (see integrateChannel()) and pushes the readings. The sample position must
+     * already be advanced by the block.
+     * @param channelData The audio data.
+     * @param numChannels The number of channels, of which the ones beyond the configuration are ignored.
+     * @param numSamples The number of samples.
+     * @param samplePosition The position of the end of the block.
+     * @param instrumentation The instrumentation to record the state of the queue in, or nullptr if disabled.
+     */
+    template <typename SampleType>
+    void integrateBlock (
+        const SampleType* const* channelData,
+        int numChannels,
+        int numSamples,
+        int64_t samplePosition,
+        LevelMeterInstrumentation* instrumentation);
+
+    /**
+     * Decides the amount of work to shed for the next block, based on the load and the policy. Called by the audio
+     * thread once per block.
+     */
+    SheddingDecision decideLoadShedding();
+
+    /**
+     * Sets the max number of channels and (re)allocates the storage of the audio thread for it. Can be called from
+     * any thread, while no audio is being measured.
+     * @param maxNumChannels The max number of channels.
+     */
+    void allocateChannelStorage (int maxNumChannels);
+
+    /**
+     * Makes sure the channel slots match the dispatch mode and number of channels. Replacing the slots retires the
+     * previous ones, so this must not be called while audio is being measured. Must be called with mStorageLock held.
+     */
+    void updateChannelSlots();
+
+    /**
+     * Makes sure the changed channels publisher matches the dispatch mode, number of channels and sample rate.
+     * Replacing the publisher retires the previous one. Must be called with mStorageLock held.
+     */
+    void updateChangedChannelsPublisher();
+
+    /**
+     * Prepares the subscribers for the latest configuration and hands them everything but the channel slots, the
+     * first step of dispatchMeasurements(). Must be called from the message thread.
+     */
+    void beginDispatch();
+
+    /**
+     * Hands the peaks in the channel slots to the subscribers, the second step of dispatchMeasurements(). Must be
+     * called from the message thread.
+     * @param slots The slots to sweep, which are ignored unless they are the current slots of this level meter.
+     */
+    void dispatchChannelSlots (LevelMeterRegistry::ChannelSlot* slots);
+
+    /**
+     * Finishes the update of the subscribers, the last step of dispatchMeasurements(). Must be called from the message
+     * thread.
+     */
+    void finishDispatch();
+
+    /**
+     * Frees the storage which was replaced since the previous call. Must be called from the message thread, while it
+     * doesn't hold on to any of that storage.
+     */
+    void releaseRetiredStorage();
+
+    /**
+     * Compiles the channel map which all subscribers have in common, if any, and publishes it to the audio thread.
+     * Only looks at the subscribers when the channel map is marked dirty, and does nothing (and doesn't allocate)
+     * while that map stays the same. Must be called from the message thread.
+     */
+    void updateChannelMap();
+
+    /**
+     * Destroys the retired channel maps which the audio thread no longer uses. Must be called from the message thread.
+     */
+    void releaseRetiredChannelMaps();
+
+    /**
+     * Prepares the subscribers for the latest configuration, if its epoch changed. Must be called from the message
+     * thread.
+     */
+    void updateConfiguration();
+
+    /**
+     * @return True if given epoch is the epoch of the configuration the subscribers are prepared for, after picking
+     * up a newer configuration if needed. Must be called from the message thread.
+     */
+    bool isCurrentEpoch (uint32_t epoch);
+
+    /**
+     * Finds the peak levels of two channels and the sums needed for their correlation, in a single pass.
+     * @param left The samples of the left channel.
+     * @param right The samples of the right channel.
+     * @param numSamples The number of samples.
+     * @param stereoMeasurement Receives the sums.
+     * @return The peak levels of the left and right channel.
+     */
+    template <typename SampleType>
+    static std::pair<SampleType, SampleType> measureStereoBlock (
+        const SampleType* left,
+        const SampleType* right,
+        int numSamples,
+        StereoMeasurement& stereoMeasurement);
+
 };
@@ -0,0 +1,168 @@
+#include "LevelMeterBatch.h"
+
+#include <algorithm>
+
+LevelMeterBatch::LevelMeterBatch (int const maxMeasurementsPerCallback, int const numFrames) :
+    mMaxEntriesPerFrame (std::max (1, maxMeasurementsPerCallback)),
+    mNumFrames (std::max (2, numFrames)),
+    mEntries (std::make_unique<Entry[]> (static_cast<size_t> (mMaxEntriesPerFrame * mNumFrames))),
+    mNumEntries (std::make_unique<int[]> (static_cast<size_t> (mNumFrames)))
+{
+    mRegistry->addSource (*this);
+}
+
+LevelMeterBatch::~LevelMeterBatch()
+{
+    mRegistry->removeSource (*this);
+}
+
+void LevelMeterBatch::add (LevelMeter& levelMeter)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    auto const it = std::lower_bound (mLevelMeters.begin(), mLevelMeters.end(), &levelMeter);
+    if (it == mLevelMeters.end() || *it != &levelMeter)
+        mLevelMeters.insert (it, &levelMeter);
+}
+
+void LevelMeterBatch::remove (LevelMeter& levelMeter)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    auto const it = std::lower_bound (mLevelMeters.begin(), mLevelMeters.end(), &levelMeter);
+    if (it != mLevelMeters.end() && *it == &levelMeter)
+        mLevelMeters.erase (it);
+}
+
+template <typename SampleType>
+void LevelMeterBatch::measureBlocks (const Block<SampleType>* blocks, int const numBlocks)
+{
+    auto const writeIndex = mWriteIndex.load (std::memory_order_relaxed);
+
+    // The frame to write to is still being read (or waiting to be read) when the ring is full.
+    auto const isFrameAvailable =
+        writeIndex - mReadIndex.load (std::memory_order_acquire) < static_cast<uint64_t> (mNumFrames);
+
+    auto const frameIndex = static_cast<size_t> (writeIndex % static_cast<uint64_t> (mNumFrames));
+    auto* entries = mEntries.get() + frameIndex * static_cast<size_t> (mMaxEntriesPerFrame);
+    int numEntries = 0;
+    uint64_t numDroppedMeasurements = 0;
+
+    for (int b = 0; b < numBlocks; b++)
+    {
+        auto const& block = blocks[b];
+        auto* levelMeter = block.levelMeter;
+        if (levelMeter == nullptr)
+            continue;
+
+        // Also for blocks which don't get published, so that the positions of later blocks stay right.
+        auto const samplePosition = levelMeter->advanceSamplePosition (block.numSamples);
+        auto const numChannels = std::min (block.numChannels, levelMeter->mMeasuringNumChannels);
+
+        // Integrating level meters (see LevelMeter::isIntegrating()) publish their readings themselves.
+        if (levelMeter->isIntegrating())
+        {
+            ChangedChannelsPublisher::ScopedFrame changedChannelsFrame (
+                levelMeter->mChangedChannels.load (std::memory_order_acquire));
+            levelMeter->integrateBlock (block.channelData, numChannels, block.numSamples, samplePosition, nullptr);
+            continue;
+        }
+
+        // These dispatch modes keep state of their own on the audio thread, which pushMeasurement() hands over to.
+        auto* changedChannels = levelMeter->mChangedChannels.load (std::memory_order_acquire);
+        if (changedChannels != nullptr || levelMeter->mChannelSlots.load (std::memory_order_acquire) != nullptr)
+        {
+            ChangedChannelsPublisher::ScopedFrame changedChannelsFrame (changedChannels);
+
+            for (int ch = 0; ch < numChannels; ch++)
+            {
+                auto const peakLevel = LevelMeter::findPeakLevel (block.channelData[ch], block.numSamples);
+                levelMeter->pushMeasurement (
+                    { ch, static_cast<double> (peakLevel), 1, 1, samplePosition, false, 0, 0 },
+                    nullptr);
+            }
+
+            continue;
+        }
+
+        if (!isFrameAvailable)
+            continue;
+
+        auto const numChannelsInFrame = std::min (numChannels, mMaxEntriesPerFrame - numEntries);
+        numDroppedMeasurements += static_cast<uint64_t> (numChannels - numChannelsInFrame);
+
+        for (int ch = 0; ch < numChannelsInFrame; ch++)
+        {
+            auto const peakLevel = LevelMeter::findPeakLevel (block.channelData[ch], block.numSamples);
+            auto const epoch = levelMeter->mMeasuringEpoch;
+            entries[numEntries++] = { levelMeter, ch, static_cast<float> (peakLevel), samplePosition, epoch };
+        }
+    }
+
+    if (numDroppedMeasurements > 0)
+        mNumDroppedMeasurements.fetch_add (numDroppedMeasurements, std::memory_order_relaxed);
+
+    if (!isFrameAvailable)
+    {
+        mNumDroppedFrames.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    mNumEntries[frameIndex] = numEntries;
+
+    // The only synchronisation per callback: makes the whole frame visible to the message thread.
+    mWriteIndex.store (writeIndex + 1, std::memory_order_release);
+}
+
+// Trigger symbol generation.
+template void LevelMeterBatch::measureBlocks (const Block<float>* blocks, int numBlocks);
+template void LevelMeterBatch::measureBlocks (const Block<double>* blocks, int numBlocks);
+
+uint64_t LevelMeterBatch::getNumDroppedFrames() const
+{
+    return mNumDroppedFrames.load (std::memory_order_relaxed);
+}
+
+uint64_t LevelMeterBatch::getNumDroppedMeasurements() const
+{
+    return mNumDroppedMeasurements.load (std::memory_order_relaxed);
+}
+
+void LevelMeterBatch::dispatchMeasurements()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    auto const writeIndex = mWriteIndex.load (std::memory_order_acquire);
+    auto readIndex = mReadIndex.load (std::memory_order_relaxed);
+
+    LevelMeter::Measurement measurement;
+
+    for (; readIndex < writeIndex; readIndex++)
+    {
+        auto const frameIndex = static_cast<size_t> (readIndex % static_cast<uint64_t> (mNumFrames));
+        auto const* entries = mEntries.get() + frameIndex * static_cast<size_t> (mMaxEntriesPerFrame);
+        LevelMeter* levelMeter = nullptr;
+        bool isAdded = false;
+
+        for (int i = 0; i < mNumEntries[frameIndex]; i++)
+        {
+            auto const& entry = entries[i];
+
+            // The entries of a level meter are consecutive, so it only needs to be looked up once per block.
+            if (std::exchange (levelMeter, entry.levelMeter) != entry.levelMeter)
+                isAdded = std::binary_search (mLevelMeters.begin(), mLevelMeters.end(), levelMeter);
+
+            // Measurements taken with an older configuration don't fit the subscribers anymore.
+            if (!isAdded || !levelMeter->isCurrentEpoch (entry.epoch))
+                continue;
+
+            measurement.channelIndex = entry.channelIndex;
+            measurement.peakLevel = static_cast<double> (entry.peakLevel);
+            measurement.samplePosition = entry.samplePosition;
+            measurement.epoch = entry.epoch;
+            levelMeter->dispatchToSubscribers (measurement);
+        }
+    }
+
+    mReadIndex.store (readIndex, std::memory_order_release);
+}
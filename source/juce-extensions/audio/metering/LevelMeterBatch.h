@@ -0,0 +1,143 @@
+#pragma once
+
+#include "LevelMeter.h"
+#include "LevelMeterRegistry.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Measures the blocks of many level meters at once, for audio callbacks which meter dozens of tracks and busses.
+ *
+ * measureBlocks() finds the peak level of every channel of every block in a single loop, writes the results into a
+ * frame which is shared by all level meters and publishes the frame with a single release store, instead of a queue
+ * operation per channel of every meter. Every tick, the frames published since the previous tick get fanned out to the
+ * subscribers of the right level meters, before the level meters themselves get dispatched.
+ *
+ * Frames live in a ring which is allocated up front. When the message thread falls behind by more frames than the ring
+ * holds, the measurements of a callback get lost (and counted). The sample positions of the level meters advance
+ * regardless, so later measurements stay in step with the audio.
+ *
+ * Like LevelMeter::measureBlock(), every measurement is tagged with the configuration of its level meter (see
+ * LevelMeter::setNumChannels()): channels beyond its number of channels are dropped, and measurements of an older
+ * configuration get discarded when dispatching. Level meters which dispatch a peak per tick or the changed channels
+ * (see LevelMeter::DispatchMode) get their measurements handed over on the audio thread instead of through the
+ * frame, and integrating level meters (see LevelMeter::isIntegrating()) integrate the blocks instead of measuring
+ * their peaks. The channels are never folded on the audio thread, so the subscribers apply their own channel maps.
+ *
+ * Only peak levels get measured: the audio tap, stereo analysis, clip detection and load shedding of a level meter
+ * only apply to LevelMeter::measureBlock().
+ */
+class LevelMeterBatch : private LevelMeterRegistry::MeasurementSource
+{
+public:
+    static constexpr int kDefaultMaxMeasurementsPerCallback = 512;
+    static constexpr int kDefaultNumFrames = 32;
+
+    /**
+     * A block of audio to measure for a level meter.
+     */
+    template <typename SampleType>
+    struct Block
+    {
+        LevelMeter* levelMeter = nullptr;
+        const SampleType* const* channelData = nullptr;
+        int numChannels = 0;
+        int numSamples = 0;
+    };
+
+    /**
+     * Constructor.
+     * @param maxMeasurementsPerCallback The max number of channels published in the frame of a call to measureBlocks(),
+     * channels beyond it are dropped (and counted, see getNumDroppedMeasurements()).
+     * @param numFrames The number of frames in the ring, which is the number of callbacks which can be published
+     * between two ticks.
+     */
+    explicit LevelMeterBatch (
+        int maxMeasurementsPerCallback = kDefaultMaxMeasurementsPerCallback,
+        int numFrames = kDefaultNumFrames);
+    ~LevelMeterBatch() override;
+
+    JUCE_DECLARE_NON_COPYABLE (LevelMeterBatch)
+    JUCE_DECLARE_NON_MOVEABLE (LevelMeterBatch)
+
+    /**
+     * Adds a level meter whose blocks will be measured by this batch. Measurements of level meters which aren't added
+     * are ignored. Must be called from the message thread.
+     * @param levelMeter The level meter to add.
+     */
+    void add (LevelMeter& levelMeter);
+
+    /**
+     * Removes a level meter, which must be done before it gets destroyed. Must be called from the message thread.
+     * @param levelMeter The level meter to remove.
+     */
+    void remove (LevelMeter& levelMeter);
+
+    /**
+     * Measures the blocks of an audio callback and publishes the measurements.
+     * Calling this method is realtime safe as long as being called from a single thread.
+     * @tparam SampleType The type of the audio sample.
+     * @param blocks The blocks to measure.
+     * @param numBlocks The number of blocks.
+     */
+    template <typename SampleType>
+    void measureBlocks (const Block<SampleType>* blocks, int numBlocks);
+
+    /**
+     * @return The number of callbacks whose measurements were lost because the ring was full. Can be called from any
+     * thread.
+     */
+    [[nodiscard]] uint64_t getNumDroppedFrames() const;
+
+    /**
+     * @return The number of measurements which were lost because they didn't fit in their frame (see the
+     * constructor). Can be called from any thread.
+     */
+    [[nodiscard]] uint64_t getNumDroppedMeasurements() const;
+
+    /**
+     * Hands the measurements published since the previous call to the subscribers of their level meters. This
+     * normally gets called by the LevelMeterRegistry at the start of every tick. Must be called from the message
+     * thread.
+     */
+    void dispatchMeasurements() override;
+
+private:
+    /**
+     * The measurement of a single channel.
+     */
+    struct Entry
+    {
+        LevelMeter* levelMeter = nullptr;
+        int channelIndex = 0;
+        float peakLevel = 0.0f;
+        int64_t samplePosition = -1;
+        uint32_t epoch = 0; ///< See LevelMeter::setNumChannels().
+    };
+
+    int mMaxEntriesPerFrame = kDefaultMaxMeasurementsPerCallback;
+    int mNumFrames = kDefaultNumFrames;
+
+    /// The entries of all frames, mMaxEntriesPerFrame per frame.
+    std::unique_ptr<Entry[]> mEntries;
+
+    /// The number of entries per frame.
+    std::unique_ptr<int[]> mNumEntries;
+
+    /// The number of frames published, only written by the audio thread.
+    std::atomic<uint64_t> mWriteIndex { 0 };
+
+    /// The number of frames dispatched, only written by the message thread.
+    std::atomic<uint64_t> mReadIndex { 0 };
+
+    std::atomic<uint64_t> mNumDroppedFrames { 0 };
+    std::atomic<uint64_t> mNumDroppedMeasurements { 0 };
+
+    /// The added level meters, sorted by address.
+    std::vector<LevelMeter*> mLevelMeters;
+
+    juce::SharedResourcePointer<LevelMeterRegistry> mRegistry;
+};
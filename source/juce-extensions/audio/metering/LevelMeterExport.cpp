@@ -0,0 +1,46 @@
+#include "LevelMeterExport.h"
+
+LevelMeterExport::LevelMeterExport (const juce::File& file, int const maxChannels) :
+    Subscriber (LevelMeter::Scale::getDefaultScale(), maxChannels),
+    mSharedMemory (LevelMeterSharedMemory::createForWriting (file, maxChannels))
+{
+}
+
+bool LevelMeterExport::isOpen() const
+{
+    return mSharedMemory != nullptr;
+}
+
+void LevelMeterExport::updateWithMeasurement (const LevelMeter::Measurement& measurement)
+{
+    auto const channelIndex = getChannelIndexForMeasurement (measurement);
+    if (!juce::isPositiveAndBelow (channelIndex, static_cast<int> (mTickMeasurements.size())))
+        return;
+
+    auto& tickMeasurement = mTickMeasurements[static_cast<size_t> (channelIndex)];
+    if (measurement.peakLevel > tickMeasurement.peakLevel)
+    {
+        tickMeasurement = measurement;
+        tickMeasurement.channelIndex = channelIndex;
+    }
+}
+
+void LevelMeterExport::measurementUpdatesFinished()
+{
+    if (mSharedMemory == nullptr)
+        return;
+
+    // Frames get published every tick, also without measurements, so readers keep in step.
+    mSharedMemory->writeFrame (mTickMeasurements.data(), static_cast<int> (mTickMeasurements.size()));
+
+    for (auto& tickMeasurement : mTickMeasurements)
+        tickMeasurement.peakLevel = -1.0;
+}
+
+void LevelMeterExport::levelMeterPrepared (int const numChannels)
+{
+    mTickMeasurements.resize (static_cast<size_t> (numChannels));
+
+    for (size_t ch = 0; ch < mTickMeasurements.size(); ch++)
+        mTickMeasurements[ch] = { static_cast<int> (ch), -1.0 };
+}
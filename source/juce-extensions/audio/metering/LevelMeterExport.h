@@ -0,0 +1,46 @@
+#pragma once
+
+#include "LevelMeter.h"
+#include "LevelMeterSharedMemory.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * Subscriber which publishes the measurements of a level meter into a shared memory segment every tick, so that a
+ * LevelMeterImport in another process can show them (see LevelMeterSharedMemory). Publishing only writes to the
+ * mapped memory, it doesn't make any system call.
+ */
+class LevelMeterExport : public LevelMeter::Subscriber
+{
+public:
+    /// Expose as public members
+    using LevelMeter::Subscriber::subscribeToLevelMeter;
+    using LevelMeter::Subscriber::unsubscribeFromLevelMeter;
+
+    /**
+     * Constructor. Creates the segment, or takes over an existing one.
+     * @param file The file of the segment, see LevelMeterSharedMemory::getDefaultFile().
+     * @param maxChannels The max number of channels to export. If a meter has more channels then all channels will be
+     * folded into a single mono channel.
+     */
+    explicit LevelMeterExport (
+        const juce::File& file,
+        int maxChannels = LevelMeterSharedMemory::kDefaultMaxChannels);
+
+    /**
+     * @return True if the segment was created, false if the file couldn't be created or mapped.
+     */
+    [[nodiscard]] bool isOpen() const;
+
+private:
+    std::unique_ptr<LevelMeterSharedMemory> mSharedMemory;
+
+    /// The highest measurement per channel of the current tick, of which peakLevel is negative if none.
+    std::vector<LevelMeter::Measurement> mTickMeasurements;
+
+    // MARK: LevelMeter::Subscriber overrides -
+    void updateWithMeasurement (const LevelMeter::Measurement& measurement) override;
+    void measurementUpdatesFinished() override;
+    void levelMeterPrepared (int numChannels) override;
+};
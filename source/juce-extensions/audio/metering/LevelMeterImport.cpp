@@ -0,0 +1,79 @@
+#include "LevelMeterImport.h"
+
+LevelMeterImport::LevelMeterImport (const juce::File& file) :
+    LevelMeter (LevelMeterRegistry::DispatchKind::custom),
+    mFile (file)
+{
+    connect();
+}
+
+LevelMeterImport::~LevelMeterImport() = default;
+
+bool LevelMeterImport::isConnected() const
+{
+    return mSharedMemory != nullptr;
+}
+
+uint64_t LevelMeterImport::getNumMissedFrames() const
+{
+    return mNumMissedFrames;
+}
+
+void LevelMeterImport::dispatchMeasurements()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    // Opening the file takes system calls, so don't try every tick.
+    if (mSharedMemory == nullptr && --mTicksUntilConnecting <= 0)
+        connect();
+
+    // A new writer took over the segment, which might have another layout.
+    if (mSharedMemory != nullptr && mSharedMemory->getSessionId() != mSessionId)
+        connect();
+
+    if (mSharedMemory != nullptr)
+    {
+        auto const latestTick = mSharedMemory->getLatestTick();
+        auto const oldestAvailableTick =
+            latestTick >= LevelMeterSharedMemory::kNumFrames ? latestTick - LevelMeterSharedMemory::kNumFrames + 1 : 1;
+
+        if (latestTick > mLastTick && mLastTick + 1 < oldestAvailableTick)
+            mNumMissedFrames += oldestAvailableTick - mLastTick - 1;
+
+        for (auto tick = std::max (mLastTick + 1, oldestAvailableTick); tick <= latestTick; tick++)
+        {
+            if (!mSharedMemory->readFrame (tick, mFrame))
+            {
+                mNumMissedFrames++;
+                continue;
+            }
+
+            if (mFrame.numChannels != getNumChannels())
+                prepareToPlay (mFrame.numChannels);
+
+            for (auto const& measurement : mFrame.measurements)
+                dispatchToSubscribers (measurement);
+        }
+
+        mLastTick = std::max (mLastTick, latestTick);
+    }
+
+    // Finishes the update of the subscribers.
+    LevelMeter::dispatchMeasurements();
+}
+
+void LevelMeterImport::connect()
+{
+    mSharedMemory = LevelMeterSharedMemory::openForReading (mFile);
+    mTicksUntilConnecting = LevelMeterConstants::kRefreshRateHz;
+
+    if (mSharedMemory == nullptr)
+        return;
+
+    mSessionId = mSharedMemory->getSessionId();
+    mFrame.measurements.reserve (static_cast<size_t> (mSharedMemory->getMaxChannels()));
+
+    // Start at the most recent frame, older ones are of no interest to a meter.
+    auto const latestTick = mSharedMemory->getLatestTick();
+    mLastTick = latestTick > 0 ? latestTick - 1 : 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "LevelMeter.h"
+#include "LevelMeterSharedMemory.h"
+
+#include <memory>
+
+/**
+ * A level meter which shows the measurements a LevelMeterExport in another process publishes into a shared memory
+ * segment, instead of measuring audio. Subscribe to it like any other level meter, for example with an unmodified
+ * LevelMeterComponent.
+ *
+ * Every tick it hands the subscribers all frames published since the previous tick (up to
+ * LevelMeterSharedMemory::kNumFrames), and follows the number of channels of the exporting level meter. While the
+ * segment doesn't exist yet, it tries to open it about once per second. Reading only touches the mapped memory.
+ * Only to be used from the message thread.
+ */
+class LevelMeterImport : public LevelMeter
+{
+public:
+    /**
+     * Constructor.
+     * @param file The file of the segment, see LevelMeterSharedMemory::getDefaultFile().
+     */
+    explicit LevelMeterImport (const juce::File& file);
+    ~LevelMeterImport() override;
+
+    JUCE_DECLARE_NON_COPYABLE (LevelMeterImport)
+    JUCE_DECLARE_NON_MOVEABLE (LevelMeterImport)
+
+    /**
+     * @return True if the segment is open.
+     */
+    [[nodiscard]] bool isConnected() const;
+
+    /**
+     * @return The number of frames which were overwritten before they could be read, since construction.
+     */
+    [[nodiscard]] uint64_t getNumMissedFrames() const;
+
+    /**
+     * Reads the frames published since the previous tick and hands them to the subscribers.
+     */
+    void dispatchMeasurements() override;
+
+private:
+    juce::File mFile;
+    std::unique_ptr<LevelMeterSharedMemory> mSharedMemory;
+    uint64_t mSessionId = 0;
+    uint64_t mLastTick = 0;
+    uint64_t mNumMissedFrames = 0;
+    int mTicksUntilConnecting = 0;
+    LevelMeterSharedMemory::Frame mFrame;
+
+    /**
+     * Opens the segment.
+     */
+    void connect();
+};
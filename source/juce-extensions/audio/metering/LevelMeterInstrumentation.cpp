@@ -0,0 +1,79 @@
+#include "LevelMeterInstrumentation.h"
+
+double LevelMeterInstrumentation::Statistics::getAverageCallCostNs() const
+{
+    if (numCalls == 0)
+        return 0.0;
+    return static_cast<double> (totalCallCostNs) / static_cast<double> (numCalls);
+}
+
+uint64_t LevelMeterInstrumentation::Statistics::getCallCostPercentileNs (double const percentile) const
+{
+    if (numCalls == 0)
+        return 0;
+
+    auto const target = static_cast<uint64_t> (std::ceil (juce::jlimit (0.0, 100.0, percentile) / 100.0 *
+                                                          static_cast<double> (numCalls)));
+    uint64_t count = 0;
+
+    for (size_t i = 0; i < callCostHistogram.size(); i++)
+    {
+        count += callCostHistogram[i];
+        if (count >= target && count > 0)
+            return std::min (maxCallCostNs, (uint64_t { 2 } << i) - 1);
+    }
+
+    return maxCallCostNs;
+}
+
+void LevelMeterInstrumentation::recordCall (std::chrono::nanoseconds const cost)
+{
+    auto const costNs = static_cast<uint64_t> (std::max (cost.count(), decltype (cost.count()) { 0 }));
+    auto const clampedNs = static_cast<juce::uint32> (std::min (costNs, uint64_t { 0xffffffff }));
+    auto const bucket = clampedNs == 0 ? 0 : juce::findHighestSetBit (clampedNs);
+
+    add (mCallCostHistogram[static_cast<size_t> (bucket)], 1);
+    add (mNumCalls, 1);
+    add (mTotalCallCostNs, costNs);
+    raise (mMaxCallCostNs, costNs);
+}
+
+void LevelMeterInstrumentation::recordQueueDepth (size_t const queueDepth)
+{
+    raise (mQueueHighWaterMark, static_cast<uint64_t> (queueDepth));
+}
+
+void LevelMeterInstrumentation::recordQueueGrowth (bool const wasDropped)
+{
+    add (mNumQueueGrowths, 1);
+    if (wasDropped)
+        add (mNumDroppedMeasurements, 1);
+}
+
+LevelMeterInstrumentation::Statistics LevelMeterInstrumentation::getStatistics() const
+{
+    Statistics statistics;
+
+    for (size_t i = 0; i < mCallCostHistogram.size(); i++)
+        statistics.callCostHistogram[i] = mCallCostHistogram[i].load (std::memory_order_relaxed);
+
+    statistics.numCalls = mNumCalls.load (std::memory_order_relaxed);
+    statistics.totalCallCostNs = mTotalCallCostNs.load (std::memory_order_relaxed);
+    statistics.maxCallCostNs = mMaxCallCostNs.load (std::memory_order_relaxed);
+    statistics.queueHighWaterMark = mQueueHighWaterMark.load (std::memory_order_relaxed);
+    statistics.numQueueGrowths = mNumQueueGrowths.load (std::memory_order_relaxed);
+    statistics.numDroppedMeasurements = mNumDroppedMeasurements.load (std::memory_order_relaxed);
+
+    return statistics;
+}
+
+void LevelMeterInstrumentation::add (std::atomic<uint64_t>& counter, uint64_t const amount)
+{
+    counter.store (counter.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void LevelMeterInstrumentation::raise (std::atomic<uint64_t>& counter, uint64_t const value)
+{
+    if (value > counter.load (std::memory_order_relaxed))
+        counter.store (value, std::memory_order_relaxed);
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <juce_core/juce_core.h>
+
+/**
+ * Records what a LevelMeter costs on the audio thread: a histogram of the time spent per call, the high-water mark of
+ * the measurement queue and the number of measurements which made the queue grow (which allocates).
+ * Recording is done by a single (audio) thread and is lock-free and wait-free. The statistics can be read from any
+ * other thread at any time. Counters only ever go up; to measure a period of time, take the difference between two
+ * snapshots.
+ */
+class LevelMeterInstrumentation
+{
+public:
+    /// The number of buckets in the call cost histogram. Bucket i counts the calls which took [2^i, 2^(i+1)) ns.
+    static constexpr int kNumHistogramBuckets = 32;
+
+    /**
+     * A snapshot of the recorded statistics.
+     */
+    struct Statistics
+    {
+        /// The number of calls per cost bucket, see kNumHistogramBuckets.
+        std::array<uint64_t, kNumHistogramBuckets> callCostHistogram {};
+
+        uint64_t numCalls = 0;               ///< The number of calls recorded.
+        uint64_t totalCallCostNs = 0;        ///< The total time spent in all calls.
+        uint64_t maxCallCostNs = 0;          ///< The time spent in the most expensive call.
+        uint64_t queueHighWaterMark = 0;     ///< The max number of measurements in the queue after a push.
+        uint64_t numQueueGrowths = 0;        ///< The number of measurements which made the queue grow (allocate).
+        uint64_t numDroppedMeasurements = 0; ///< The number of measurements lost because the queue couldn't grow.
+
+        /**
+         * @return The average time spent per call, or 0 if no calls were recorded.
+         */
+        [[nodiscard]] double getAverageCallCostNs() const;
+
+        /**
+         * Estimates a percentile of the call cost from the histogram.
+         * @param percentile The percentile [0, 100].
+         * @return The upper bound of the histogram bucket which contains the percentile, or 0 if no calls were
+         * recorded.
+         */
+        [[nodiscard]] uint64_t getCallCostPercentileNs (double percentile) const;
+    };
+
+    /**
+     * Measures the time between its construction and destruction and records it as a call. Does nothing when
+     * constructed with nullptr, which keeps the cost of disabled instrumentation to a single branch.
+     */
+    class ScopedCallTimer
+    {
+    public:
+        explicit ScopedCallTimer (LevelMeterInstrumentation* instrumentation) :
+            mInstrumentation (instrumentation)
+        {
+            if (mInstrumentation != nullptr)
+                mStart = Clock::now();
+        }
+
+        ~ScopedCallTimer()
+        {
+            if (mInstrumentation != nullptr)
+            {
+                auto const elapsed = Clock::now() - mStart;
+                mInstrumentation->recordCall (std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed));
+            }
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedCallTimer)
+        JUCE_DECLARE_NON_MOVEABLE (ScopedCallTimer)
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        LevelMeterInstrumentation* mInstrumentation = nullptr;
+        Clock::time_point mStart;
+    };
+
+    LevelMeterInstrumentation() = default;
+
+    JUCE_DECLARE_NON_COPYABLE (LevelMeterInstrumentation)
+    JUCE_DECLARE_NON_MOVEABLE (LevelMeterInstrumentation)
+
+    /**
+     * Records the cost of a single call. Only to be called from a single (audio) thread.
+     * @param cost The time spent in the call.
+     */
+    void recordCall (std::chrono::nanoseconds cost);
+
+    /**
+     * Records the number of measurements in the queue after a push. Only to be called from a single (audio) thread.
+     * @param queueDepth The number of measurements in the queue.
+     */
+    void recordQueueDepth (size_t queueDepth);
+
+    /**
+     * Records a measurement which didn't fit in the preallocated queue, so the queue had to grow. Only to be called
+     * from a single (audio) thread.
+     * @param wasDropped True if the measurement got lost, false if the queue managed to grow to fit it.
+     */
+    void recordQueueGrowth (bool wasDropped);
+
+    /**
+     * @return A snapshot of the statistics. Can be called from any thread. The individual counters are read one by
+     * one, so a snapshot taken while recording may be off by a call.
+     */
+    [[nodiscard]] Statistics getStatistics() const;
+
+private:
+    // There is a single writer, so counters get updated with a plain load and store instead of a read-modify-write.
+    std::array<std::atomic<uint64_t>, kNumHistogramBuckets> mCallCostHistogram {};
+    std::atomic<uint64_t> mNumCalls { 0 };
+    std::atomic<uint64_t> mTotalCallCostNs { 0 };
+    std::atomic<uint64_t> mMaxCallCostNs { 0 };
+    std::atomic<uint64_t> mQueueHighWaterMark { 0 };
+    std::atomic<uint64_t> mNumQueueGrowths { 0 };
+    std::atomic<uint64_t> mNumDroppedMeasurements { 0 };
+
+    /**
+     * Adds an amount to a counter which only gets written by a single thread.
+     */
+    static void add (std::atomic<uint64_t>& counter, uint64_t amount);
+
+    /**
+     * Raises a counter which only gets written by a single thread to given value, if it's higher.
+     */
+    static void raise (std::atomic<uint64_t>& counter, uint64_t value);
+};
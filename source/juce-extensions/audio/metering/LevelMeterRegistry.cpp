@@ -0,0 +1,302 @@
+#include "LevelMeterRegistry.h"
+#include "LevelMeter.h"
+
+#include <algorithm>
+
+void LevelMeterRegistry::ChannelSlot::accumulate (
+    double const newPeakLevel,
+    uint16_t const blockInterval,
+    uint16_t const sampleStride)
+{
+    // There is a single writer, so there's no need for a compare-exchange loop. When the reader takes the peak in
+    // between the load and the store, the old peak is stored again and shows up once more in the next tick.
+    auto const currentPeakLevel = peakLevel.load (std::memory_order_relaxed);
+    if (newPeakLevel > currentPeakLevel)
+        peakLevel.store (newPeakLevel, std::memory_order_relaxed);
+
+    accuracy.store ((static_cast<uint32_t> (blockInterval) << 16) | sampleStride, std::memory_order_relaxed);
+}
+
+bool LevelMeterRegistry::ChannelSlot::take (double& peakLevelOut, uint16_t& blockInterval, uint16_t& sampleStride)
+{
+    peakLevelOut = peakLevel.exchange (kNoPeakLevel, std::memory_order_relaxed);
+    if (peakLevelOut < 0.0)
+        return false;
+
+    auto const accuracyValue = accuracy.load (std::memory_order_relaxed);
+    blockInterval = static_cast<uint16_t> (accuracyValue >> 16);
+    sampleStride = static_cast<uint16_t> (accuracyValue & 0xffff);
+    return true;
+}
+
+LevelMeterRegistry::~LevelMeterRegistry()
+{
+    stopTimer(); // Paranoia.
+}
+
+void LevelMeterRegistry::add (LevelMeter& levelMeter, DispatchKind const dispatchKind)
+{
+    // Set the timer going if we're about to add the first level meter.
+    if (getNumLevelMeters() == 0)
+        startTimerHz (LevelMeterConstants::kRefreshRateHz);
+
+    switch (dispatchKind)
+    {
+        case DispatchKind::regular:
+            mLevelMeters.push_back (&levelMeter);
+            break;
+        case DispatchKind::custom:
+            mCustomLevelMeters.push_back (&levelMeter);
+            break;
+        case DispatchKind::aggregate:
+            mAggregateLevelMeters.push_back (&levelMeter);
+            break;
+    }
+}
+
+void LevelMeterRegistry::remove (LevelMeter& levelMeter)
+{
+    for (auto* levelMeters : { &mLevelMeters, &mCustomLevelMeters, &mAggregateLevelMeters })
+    {
+        auto const it = std::find (levelMeters->begin(), levelMeters->end(), &levelMeter);
+        if (it == levelMeters->end())
+            continue;
+
+        // Moving another meter into this place could make the sweep skip it.
+        if (mIsDispatching)
+        {
+            *it = nullptr;
+            mNumRemovedLevelMeters++;
+            break;
+        }
+
+        // The order of the meters doesn't matter, so avoid moving the whole tail.
+        *it = levelMeters->back();
+        levelMeters->pop_back();
+        break;
+    }
+
+    if (getNumLevelMeters() == 0)
+        stopTimer();
+}
+
+void LevelMeterRegistry::addSource (MeasurementSource& source)
+{
+    mSources.push_back (&source);
+}
+
+void LevelMeterRegistry::removeSource (MeasurementSource& source)
+{
+    auto const it = std::find (mSources.begin(), mSources.end(), &source);
+    if (it == mSources.end())
+        return;
+
+    if (mIsDispatching)
+    {
+        *it = nullptr;
+        mNumRemovedSources++;
+        return;
+    }
+
+    mSources.erase (it);
+}
+
+size_t LevelMeterRegistry::getNumLevelMeters() const
+{
+    return mLevelMeters.size() + mCustomLevelMeters.size() + mAggregateLevelMeters.size() - mNumRemovedLevelMeters;
+}
+
+uint64_t LevelMeterRegistry::getTickCount() const
+{
+    return mTickCount;
+}
+
+bool LevelMeterRegistry::isDispatching() const
+{
+    return mIsDispatching;
+}
+
+LevelMeterRegistry::ChannelSlot* LevelMeterRegistry::allocateChannelSlots (
+    int const numChannels,
+    LevelMeter* const owner)
+{
+    auto const numCacheLines = getNumCacheLines (numChannels);
+    if (numCacheLines == 0)
+        return nullptr;
+
+    const juce::ScopedLock lock (mPoolLock);
+
+    auto takeFromPool = [numCacheLines, owner] (Pool& pool) -> ChannelSlot* {
+        for (auto it = pool.freeRuns.begin(); it != pool.freeRuns.end(); ++it)
+        {
+            auto& [first, size] = *it;
+            if (size < numCacheLines)
+                continue;
+
+            auto* cacheLine = &pool.cacheLines[first];
+            pool.owners[first] = { owner, numCacheLines };
+            first += numCacheLines;
+            size -= numCacheLines;
+            if (size == 0)
+                pool.freeRuns.erase (it);
+
+            // Hand out slots in the same state as new ones.
+            for (auto* line = cacheLine; line != cacheLine + numCacheLines; ++line)
+            {
+                for (auto& slot : line->slots)
+                {
+                    slot.peakLevel.store (ChannelSlot::kNoPeakLevel, std::memory_order_relaxed);
+                    slot.accuracy.store (0x00010001, std::memory_order_relaxed);
+                }
+            }
+
+            return cacheLine->slots;
+        }
+
+        return nullptr;
+    };
+
+    for (auto& pool : mPools)
+        if (auto* slots = takeFromPool (pool))
+            return slots;
+
+    auto& pool = mPools.emplace_back();
+    pool.numCacheLines = std::max (numCacheLines, kMinSlotsPerPool / kSlotsPerCacheLine);
+    pool.cacheLines = std::make_unique<CacheLine[]> (pool.numCacheLines);
+    pool.owners = std::make_unique<RunOwner[]> (pool.numCacheLines);
+    pool.freeRuns.emplace_back (0, pool.numCacheLines);
+
+    return takeFromPool (pool);
+}
+
+void LevelMeterRegistry::freeChannelSlots (ChannelSlot* const slots, int const numChannels)
+{
+    auto const numCacheLines = getNumCacheLines (numChannels);
+    if (slots == nullptr || numCacheLines == 0)
+        return;
+
+    const juce::ScopedLock lock (mPoolLock);
+
+    for (auto& pool : mPools)
+    {
+        auto* const firstCacheLine = pool.cacheLines.get();
+        auto* const cacheLine = reinterpret_cast<CacheLine*> (slots);
+
+        if (cacheLine < firstCacheLine || cacheLine >= firstCacheLine + pool.numCacheLines)
+            continue;
+
+        auto const first = static_cast<size_t> (cacheLine - firstCacheLine);
+        auto& runs = pool.freeRuns;
+        pool.owners[first] = {};
+
+        // Insert the run in order and merge it with its neighbours, to keep the pool from fragmenting.
+        auto it = std::lower_bound (runs.begin(), runs.end(), std::make_pair (first, size_t { 0 }));
+        it = runs.emplace (it, first, numCacheLines);
+
+        if (auto next = std::next (it); next != runs.end() && it->first + it->second == next->first)
+        {
+            it->second += next->second;
+            runs.erase (next);
+        }
+
+        if (it != runs.begin())
+        {
+            if (auto previous = std::prev (it); previous->first + previous->second == it->first)
+            {
+                previous->second += it->second;
+                runs.erase (it);
+            }
+        }
+
+        return;
+    }
+
+    jassertfalse; // The slots were not allocated by this registry.
+}
+
+void LevelMeterRegistry::dispatchMeasurements()
+{
+    jassert (!mIsDispatching); // Not reentrant.
+
+    mTickCount++;
+    mIsDispatching = true;
+
+    for (size_t i = 0; i < mSources.size(); i++)
+        if (auto* source = mSources[i])
+            source->dispatchMeasurements();
+
+    // The regular meters get dispatched without a virtual call (see the class description). Iterate by index, since
+    // subscribers might add or remove level meters while being called.
+    for (size_t i = 0; i < mLevelMeters.size(); i++)
+        if (auto* levelMeter = mLevelMeters[i])
+            levelMeter->beginDispatch();
+
+    sweepChannelSlots();
+
+    for (size_t i = 0; i < mLevelMeters.size(); i++)
+        if (auto* levelMeter = mLevelMeters[i])
+            levelMeter->finishDispatch();
+
+    for (size_t i = 0; i < mCustomLevelMeters.size(); i++)
+        if (auto* levelMeter = mCustomLevelMeters[i])
+            levelMeter->dispatchMeasurements();
+
+    // Aggregates derive their measurements from the ones dispatched above.
+    for (size_t i = 0; i < mAggregateLevelMeters.size(); i++)
+        if (auto* levelMeter = mAggregateLevelMeters[i])
+            levelMeter->dispatchMeasurements();
+
+    mIsDispatching = false;
+    eraseRemoved();
+}
+
+void LevelMeterRegistry::eraseRemoved()
+{
+    if (mNumRemovedLevelMeters > 0)
+    {
+        for (auto* levelMeters : { &mLevelMeters, &mCustomLevelMeters, &mAggregateLevelMeters })
+            levelMeters->erase (std::remove (levelMeters->begin(), levelMeters->end(), nullptr), levelMeters->end());
+
+        mNumRemovedLevelMeters = 0;
+    }
+
+    if (mNumRemovedSources > 0)
+    {
+        mSources.erase (std::remove (mSources.begin(), mSources.end(), nullptr), mSources.end());
+        mNumRemovedSources = 0;
+    }
+}
+
+void LevelMeterRegistry::sweepChannelSlots()
+{
+    const juce::ScopedLock lock (mPoolLock);
+
+    // Iterate by index, since subscribers might allocate or free slots (and add pools) while being called.
+    for (size_t p = 0; p < mPools.size(); p++)
+    {
+        for (size_t line = 0; line < mPools[p].numCacheLines;)
+        {
+            auto const owner = mPools[p].owners[line];
+            if (owner.levelMeter == nullptr)
+            {
+                line++;
+                continue;
+            }
+
+            owner.levelMeter->dispatchChannelSlots (mPools[p].cacheLines[line].slots);
+            line += owner.numCacheLines;
+        }
+    }
+}
+
+void LevelMeterRegistry::timerCallback()
+{
+    dispatchMeasurements();
+}
+
+size_t LevelMeterRegistry::getNumCacheLines (int const numChannels)
+{
+    if (numChannels <= 0)
+        return 0;
+    return (static_cast<size_t> (numChannels) + kSlotsPerCacheLine - 1) / kSlotsPerCacheLine;
+}
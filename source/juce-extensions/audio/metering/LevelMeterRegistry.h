@@ -0,0 +1,250 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <juce_events/juce_events.h>
+#include <memory>
+#include <vector>
+
+class LevelMeter;
+
+/**
+ * Keeps track of all level meters in the process and dispatches their measurements from a single shared timer.
+ * The registered meters are kept in one contiguous array, so every tick is a single linear sweep over all meters.
+ * For meters which dispatch a single peak per tick (see LevelMeter::DispatchMode), the registry also owns the
+ * per-channel state which the audio thread writes to. These channel slots are allocated from contiguous pools, with
+ * the slots of every meter starting on a cache line of their own, so that meters fed from different audio threads
+ * never share a cache line.
+ * A tick dispatches the regular meters without a virtual call: a pass over the meters drains their queues, a single
+ * sweep over all pools hands the peaks in the slots to the meters which own them, and a final pass over the meters
+ * finishes the update of their subscribers. Only meters which dispatch in ways of their own (see DispatchKind) get
+ * their virtual LevelMeter::dispatchMeasurements() called.
+ * Access the registry through juce::SharedResourcePointer<LevelMeterRegistry>. Only to be used from the message
+ * thread, unless noted otherwise.
+ */
+class LevelMeterRegistry : private juce::Timer
+{
+public:
+    /// The size of a cache line, which the channel slots of every meter are aligned to.
+    static constexpr size_t kCacheLineSize = 64;
+
+    /**
+     * The state of a single channel of a meter: the highest peak level since the previous tick. Written by the audio
+     * thread, read and reset by the message thread.
+     */
+    struct ChannelSlot
+    {
+        /// The value of peakLevel when there was no measurement since the previous tick.
+        static constexpr double kNoPeakLevel = -1.0;
+
+        std::atomic<double> peakLevel { kNoPeakLevel };
+
+        /// The block interval (upper 16 bits) and sample stride (lower 16 bits) of the most recent measurement.
+        std::atomic<uint32_t> accuracy { 0x00010001 };
+
+        /**
+         * Raises the peak level to given value, if higher. Realtime safe, only to be called from a single (audio)
+         * thread.
+         * @param newPeakLevel The peak level of a new measurement.
+         * @param blockInterval The block interval of the measurement.
+         * @param sampleStride The sample stride of the measurement.
+         */
+        void accumulate (double newPeakLevel, uint16_t blockInterval, uint16_t sampleStride);
+
+        /**
+         * Takes the peak level since the previous call and resets it. A peak which gets accumulated while taking it
+         * may show up in the next call as well, but never gets lost.
+         * @param peakLevel Receives the peak level.
+         * @param blockInterval Receives the block interval.
+         * @param sampleStride Receives the sample stride.
+         * @return True if there was at least one measurement since the previous call.
+         */
+        bool take (double& peakLevel, uint16_t& blockInterval, uint16_t& sampleStride);
+    };
+
+    static_assert (kCacheLineSize % sizeof (ChannelSlot) == 0, "Channel slots should tile a cache line.");
+
+    /**
+     * How a level meter gets dispatched every tick.
+     */
+    enum class DispatchKind
+    {
+        /// Dispatched by the sweep of the registry, without a virtual call.
+        regular,
+
+        /// Overrides LevelMeter::dispatchMeasurements() (like LevelMeterImport), which gets called after the regular
+        /// level meters.
+        custom,
+
+        /// Derives its measurements from other level meters (like AggregateLevelMeter), which gets called after all
+        /// other level meters.
+        aggregate
+    };
+
+    /**
+     * Baseclass for classes which hand measurements to level meters from outside of the level meters themselves (like
+     * LevelMeterBatch). Sources get dispatched at the start of every tick, before any level meter.
+     */
+    class MeasurementSource
+    {
+    public:
+        virtual ~MeasurementSource() = default;
+
+        /**
+         * Hands the pending measurements to the level meters. Called from the message thread.
+         */
+        virtual void dispatchMeasurements() = 0;
+    };
+
+    LevelMeterRegistry() = default;
+    ~LevelMeterRegistry() override;
+
+    JUCE_DECLARE_NON_COPYABLE (LevelMeterRegistry)
+    JUCE_DECLARE_NON_MOVEABLE (LevelMeterRegistry)
+
+    /**
+     * Adds a level meter, which will have its measurements dispatched every tick. Starts the timer when adding the
+     * first meter.
+     * @param levelMeter The level meter to add.
+     * @param dispatchKind How the level meter gets dispatched.
+     */
+    void add (LevelMeter& levelMeter, DispatchKind dispatchKind = DispatchKind::regular);
+
+    /**
+     * Adds a measurement source, which will be dispatched every tick while there are level meters.
+     * @param source The source to add.
+     */
+    void addSource (MeasurementSource& source);
+
+    /**
+     * Removes a measurement source. Can be called while dispatching.
+     * @param source The source to remove.
+     */
+    void removeSource (MeasurementSource& source);
+
+    /**
+     * Removes a level meter. Stops the timer when removing the last meter. While dispatching, the meter only gets
+     * marked as removed and the array gets compacted at the end of the tick, so no other meter gets skipped.
+     * @param levelMeter The level meter to remove.
+     */
+    void remove (LevelMeter& levelMeter);
+
+    /**
+     * @return The number of registered level meters.
+     */
+    [[nodiscard]] size_t getNumLevelMeters() const;
+
+    /**
+     * @return The number of ticks so far, which is incremented at the start of every dispatchMeasurements().
+     */
+    [[nodiscard]] uint64_t getTickCount() const;
+
+    /**
+     * @return True while dispatchMeasurements() is running, for meters and subscribers called from a tick.
+     */
+    [[nodiscard]] bool isDispatching() const;
+
+    /**
+     * Allocates a contiguous, cache line aligned run of channel slots. Can be called from any thread, since level
+     * meters get prepared off the message thread.
+     * @param numChannels The number of slots.
+     * @param owner The level meter which the sweep of every tick hands the slots to, or nullptr if the level meter
+     * sweeps the slots itself.
+     * @return The first slot, or nullptr if numChannels is 0.
+     */
+    ChannelSlot* allocateChannelSlots (int numChannels, LevelMeter* owner = nullptr);
+
+    /**
+     * Returns slots allocated with allocateChannelSlots() to the pool. The audio thread must no longer write to them.
+     * Can be called from any thread.
+     * @param slots The first slot.
+     * @param numChannels The number of slots, as passed to allocateChannelSlots().
+     */
+    void freeChannelSlots (ChannelSlot* slots, int numChannels);
+
+    /**
+     * Dispatches the measurements of all registered sources and level meters. This normally gets called by the timer,
+     * but it can also be called manually to drive the meters without a running message loop (for example when
+     * benchmarking).
+     */
+    void dispatchMeasurements();
+
+private:
+    static constexpr size_t kSlotsPerCacheLine = kCacheLineSize / sizeof (ChannelSlot);
+
+    /// The minimum number of slots in a pool, more when a single meter needs more.
+    static constexpr size_t kMinSlotsPerPool = 4096;
+
+    /**
+     * A cache line worth of slots, which makes sure that every allocation is aligned to a cache line.
+     */
+    struct alignas (kCacheLineSize) CacheLine
+    {
+        ChannelSlot slots[kSlotsPerCacheLine];
+    };
+
+    /**
+     * The level meter which owns a run of cache lines, stored at the first cache line of the run.
+     */
+    struct RunOwner
+    {
+        LevelMeter* levelMeter = nullptr;
+        size_t numCacheLines = 0;
+    };
+
+    /**
+     * A contiguous block of slots, of which runs get handed out.
+     */
+    struct Pool
+    {
+        std::unique_ptr<CacheLine[]> cacheLines;
+        std::unique_ptr<RunOwner[]> owners;
+        size_t numCacheLines = 0;
+
+        /// Runs of free cache lines as [first, first + size), sorted by first.
+        std::vector<std::pair<size_t, size_t>> freeRuns;
+    };
+
+    /// The registered regular level meters, in one contiguous array.
+    std::vector<LevelMeter*> mLevelMeters;
+
+    /// The registered level meters which dispatch in ways of their own.
+    std::vector<LevelMeter*> mCustomLevelMeters;
+
+    /// The registered aggregate level meters, which get dispatched after the regular level meters.
+    std::vector<LevelMeter*> mAggregateLevelMeters;
+
+    /// The registered measurement sources, which get dispatched before the level meters.
+    std::vector<MeasurementSource*> mSources;
+
+    /// The number of ticks so far.
+    uint64_t mTickCount = 0;
+
+    /// True while dispatching, when removed meters and sources are set to nullptr instead of being erased.
+    bool mIsDispatching = false;
+
+    /// The number of meters and sources set to nullptr in the current tick.
+    size_t mNumRemovedLevelMeters = 0;
+    size_t mNumRemovedSources = 0;
+
+    /// Guards the pools, which get allocated from on any thread.
+    juce::CriticalSection mPoolLock;
+    std::vector<Pool> mPools;
+
+    void timerCallback() override;
+
+    /**
+     * Erases the meters and sources which were removed while dispatching.
+     */
+    void eraseRemoved();
+
+    /**
+     * Hands the slots of every owned run to its level meter, in a single linear sweep over all pools.
+     */
+    void sweepChannelSlots();
+
+    /**
+     * @return The number of cache lines needed for given number of channels.
+     */
+    static size_t getNumCacheLines (int numChannels);
+};
@@ -0,0 +1,253 @@
+#include "LevelMeterSharedMemory.h"
+
+#include <cstring>
+
+namespace
+{
+/// "JXLM", identifies level meter segments.
+constexpr uint32_t kMagic = 0x4d4c584a;
+constexpr uint32_t kVersion = 1;
+constexpr size_t kCacheLineSize = 64;
+
+constexpr uint64_t kHasMeasurementFlag = 1;
+
+uint64_t toBits (double const value)
+{
+    uint64_t bits;
+    std::memcpy (&bits, &value, sizeof (bits));
+    return bits;
+}
+
+double fromBits (uint64_t const bits)
+{
+    double value;
+    std::memcpy (&value, &bits, sizeof (value));
+    return value;
+}
+
+size_t roundUpToCacheLine (size_t const size)
+{
+    return (size + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+}
+} // namespace
+
+// The segment is shared between processes, so it may only hold atomics which don't need a lock.
+static_assert (std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free);
+
+struct LevelMeterSharedMemory::SegmentHeader
+{
+    /// Written last when a writer takes over the segment, so readers see a completely initialised header.
+    std::atomic<uint32_t> magic;
+    std::atomic<uint32_t> version;
+    std::atomic<uint32_t> maxChannels;
+    std::atomic<uint32_t> numFrames;
+    std::atomic<uint64_t> sessionId;
+    std::atomic<uint64_t> latestTick;
+};
+
+struct LevelMeterSharedMemory::FrameHeader
+{
+    /// Odd while being written, 2 * tick + 2 once the frame of tick was written.
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> numChannels;
+};
+
+struct LevelMeterSharedMemory::ChannelSlot
+{
+    std::atomic<uint64_t> peakLevel;
+
+    /// kHasMeasurementFlag, the block interval in bits 16-31 and the sample stride in bits 32-47.
+    std::atomic<uint64_t> info;
+};
+
+juce::File LevelMeterSharedMemory::getDefaultFile (const juce::String& name)
+{
+#if JUCE_LINUX
+    return juce::File ("/dev/shm").getChildFile (name);
+#else
+    return juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile (name);
+#endif
+}
+
+std::unique_ptr<LevelMeterSharedMemory> LevelMeterSharedMemory::createForWriting (
+    const juce::File& file,
+    int const maxChannels)
+{
+    auto const clampedMaxChannels = juce::jlimit (1, 1024, maxChannels);
+    auto const size = static_cast<int64_t> (getSegmentSize (clampedMaxChannels));
+
+    // Grow an existing segment but never shrink it, readers might still have it mapped.
+    if (file.getSize() < size)
+    {
+        auto stream = file.createOutputStream();
+        if (stream == nullptr || !stream->openedOk())
+            return nullptr;
+
+        if (!stream->writeRepeatedByte (0, static_cast<size_t> (size - stream->getPosition())))
+            return nullptr;
+    }
+
+    auto mappedFile = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readWrite);
+    if (mappedFile->getData() == nullptr || static_cast<int64_t> (mappedFile->getSize()) < size)
+        return nullptr;
+
+    std::unique_ptr<LevelMeterSharedMemory> segment {
+        new LevelMeterSharedMemory (std::move (mappedFile), clampedMaxChannels)
+    };
+    auto& header = segment->getHeader();
+
+    header.magic.store (0, std::memory_order_relaxed);
+    header.version.store (kVersion, std::memory_order_relaxed);
+    header.maxChannels.store (static_cast<uint32_t> (clampedMaxChannels), std::memory_order_relaxed);
+    header.numFrames.store (kNumFrames, std::memory_order_relaxed);
+    header.sessionId.store (static_cast<uint64_t> (juce::Random::getSystemRandom().nextInt64()));
+    header.latestTick.store (0, std::memory_order_relaxed);
+
+    for (uint64_t frame = 0; frame < kNumFrames; frame++)
+        segment->getFrameHeader (frame).sequence.store (0, std::memory_order_relaxed);
+
+    header.magic.store (kMagic, std::memory_order_release);
+    return segment;
+}
+
+std::unique_ptr<LevelMeterSharedMemory> LevelMeterSharedMemory::openForReading (const juce::File& file)
+{
+    if (!file.existsAsFile())
+        return nullptr;
+
+    auto mappedFile = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+    if (mappedFile->getData() == nullptr || mappedFile->getSize() < sizeof (SegmentHeader))
+        return nullptr;
+
+    auto const& header = *static_cast<const SegmentHeader*> (mappedFile->getData());
+
+    if (header.magic.load (std::memory_order_acquire) != kMagic
+        || header.version.load (std::memory_order_relaxed) != kVersion
+        || header.numFrames.load (std::memory_order_relaxed) != kNumFrames)
+        return nullptr;
+
+    auto const maxChannels = static_cast<int> (header.maxChannels.load (std::memory_order_relaxed));
+    if (maxChannels <= 0 || mappedFile->getSize() < getSegmentSize (maxChannels))
+        return nullptr;
+
+    return std::unique_ptr<LevelMeterSharedMemory> { new LevelMeterSharedMemory (std::move (mappedFile), maxChannels) };
+}
+
+LevelMeterSharedMemory::LevelMeterSharedMemory (
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile,
+    int const maxChannels) :
+    mMappedFile (std::move (mappedFile)),
+    mData (static_cast<uint8_t*> (mMappedFile->getData())),
+    mMaxChannels (juce::jlimit (1, 1024, maxChannels)),
+    mFrameStride (getFrameStride (mMaxChannels))
+{
+}
+
+LevelMeterSharedMemory::~LevelMeterSharedMemory() = default;
+
+void LevelMeterSharedMemory::writeFrame (const LevelMeter::Measurement* const measurements, int const numChannels)
+{
+    auto const tick = mNextTick++;
+    auto const numChannelsInFrame = juce::jlimit (0, mMaxChannels, numChannels);
+    auto& frameHeader = getFrameHeader (tick);
+    auto* slots = getChannelSlots (tick);
+
+    frameHeader.sequence.store (tick * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    frameHeader.numChannels.store (static_cast<uint64_t> (numChannelsInFrame), std::memory_order_relaxed);
+
+    for (int ch = 0; ch < numChannelsInFrame; ch++)
+    {
+        auto const& measurement = measurements[ch];
+        auto const hasMeasurement = measurement.peakLevel >= 0.0;
+
+        slots[ch].peakLevel.store (toBits (measurement.peakLevel), std::memory_order_relaxed);
+        slots[ch].info.store (
+            (hasMeasurement ? kHasMeasurementFlag : 0) | (uint64_t { measurement.blockInterval } << 16)
+                | (uint64_t { measurement.sampleStride } << 32),
+            std::memory_order_relaxed);
+    }
+
+    frameHeader.sequence.store (tick * 2 + 2, std::memory_order_release);
+    getHeader().latestTick.store (tick, std::memory_order_release);
+}
+
+bool LevelMeterSharedMemory::readFrame (uint64_t const tick, Frame& dest) const
+{
+    auto const expectedSequence = tick * 2 + 2;
+    auto const& frameHeader = getFrameHeader (tick);
+    auto const* slots = getChannelSlots (tick);
+
+    if (frameHeader.sequence.load (std::memory_order_acquire) != expectedSequence)
+        return false;
+
+    auto const numChannels = static_cast<int> (
+        std::min (frameHeader.numChannels.load (std::memory_order_relaxed), static_cast<uint64_t> (mMaxChannels)));
+
+    dest.measurements.clear();
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        auto const info = slots[ch].info.load (std::memory_order_relaxed);
+        if ((info & kHasMeasurementFlag) == 0)
+            continue;
+
+        dest.measurements.push_back ({
+            ch,
+            fromBits (slots[ch].peakLevel.load (std::memory_order_relaxed)),
+            static_cast<uint16_t> (info >> 16),
+            static_cast<uint16_t> (info >> 32),
+        });
+    }
+
+    // The frame might have been overwritten while copying it.
+    std::atomic_thread_fence (std::memory_order_acquire);
+    if (frameHeader.sequence.load (std::memory_order_relaxed) != expectedSequence)
+        return false;
+
+    dest.tick = tick;
+    dest.numChannels = numChannels;
+    return true;
+}
+
+uint64_t LevelMeterSharedMemory::getLatestTick() const
+{
+    return getHeader().latestTick.load (std::memory_order_acquire);
+}
+
+uint64_t LevelMeterSharedMemory::getSessionId() const
+{
+    return getHeader().sessionId.load (std::memory_order_relaxed);
+}
+
+int LevelMeterSharedMemory::getMaxChannels() const
+{
+    return mMaxChannels;
+}
+
+LevelMeterSharedMemory::SegmentHeader& LevelMeterSharedMemory::getHeader() const
+{
+    return *reinterpret_cast<SegmentHeader*> (mData);
+}
+
+LevelMeterSharedMemory::FrameHeader& LevelMeterSharedMemory::getFrameHeader (uint64_t const tick) const
+{
+    auto const offset = roundUpToCacheLine (sizeof (SegmentHeader)) + (tick % kNumFrames) * mFrameStride;
+    return *reinterpret_cast<FrameHeader*> (mData + offset);
+}
+
+LevelMeterSharedMemory::ChannelSlot* LevelMeterSharedMemory::getChannelSlots (uint64_t const tick) const
+{
+    return reinterpret_cast<ChannelSlot*> (reinterpret_cast<uint8_t*> (&getFrameHeader (tick)) + sizeof (FrameHeader));
+}
+
+size_t LevelMeterSharedMemory::getSegmentSize (int const maxChannels)
+{
+    return roundUpToCacheLine (sizeof (SegmentHeader)) + kNumFrames * getFrameStride (maxChannels);
+}
+
+size_t LevelMeterSharedMemory::getFrameStride (int const maxChannels)
+{
+    return roundUpToCacheLine (sizeof (FrameHeader) + static_cast<size_t> (maxChannels) * sizeof (ChannelSlot));
+}
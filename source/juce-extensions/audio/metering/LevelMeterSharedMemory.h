@@ -0,0 +1,126 @@
+#pragma once
+
+#include "LevelMeter.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * A shared memory segment through which LevelMeterExport hands the measurements of a level meter to LevelMeterImport in
+ * another process. The segment is a memory-mapped file, so after opening it neither side makes a system call, and the
+ * processes only share atomics: there are no locks which one process could hold while the other waits.
+ *
+ * Every tick the writer publishes a frame with the highest measurement per channel. Frames are kept in a ring of
+ * kNumFrames, each guarded by a sequence number (a seqlock): the writer makes it odd while writing and sets it to an
+ * even value derived from the tick when done. A reader which finds a different sequence number after copying a frame
+ * knows the frame was overwritten and discards the copy. Readers never write to the segment.
+ *
+ * There must be a single writer per segment.
+ */
+class LevelMeterSharedMemory
+{
+public:
+    static constexpr int kDefaultMaxChannels = 64;
+    static constexpr int kNumFrames = 8;
+
+    /**
+     * The measurements of a single tick.
+     */
+    struct Frame
+    {
+        uint64_t tick = 0;
+        int numChannels = 0;
+
+        /// The highest measurement of the channels which were measured during the tick.
+        std::vector<LevelMeter::Measurement> measurements;
+    };
+
+    /**
+     * @param name The name of the segment.
+     * @return The file for a segment of given name, in memory backed storage where available.
+     */
+    static juce::File getDefaultFile (const juce::String& name);
+
+    /**
+     * Creates a segment for writing, or takes over an existing one. Readers which have the segment open will notice
+     * the new session and start reading the new frames.
+     * @param file The file of the segment.
+     * @param maxChannels The max number of channels per frame.
+     * @return The segment, or nullptr if the file couldn't be created or mapped.
+     */
+    static std::unique_ptr<LevelMeterSharedMemory> createForWriting (const juce::File& file, int maxChannels);
+
+    /**
+     * Opens an existing segment for reading.
+     * @param file The file of the segment.
+     * @return The segment, or nullptr if the file doesn't exist or doesn't hold a valid segment.
+     */
+    static std::unique_ptr<LevelMeterSharedMemory> openForReading (const juce::File& file);
+
+    ~LevelMeterSharedMemory();
+
+    JUCE_DECLARE_NON_COPYABLE (LevelMeterSharedMemory)
+    JUCE_DECLARE_NON_MOVEABLE (LevelMeterSharedMemory)
+
+    /**
+     * Publishes the measurements of a tick. Only to be called by the writer.
+     * @param measurements The highest measurement per channel, with a negative peak level for channels which weren't
+     * measured. Channels beyond getMaxChannels() are ignored.
+     * @param numChannels The number of channels.
+     */
+    void writeFrame (const LevelMeter::Measurement* measurements, int numChannels);
+
+    /**
+     * Reads the frame of given tick, if it is still available.
+     * @param tick The tick, which must not be newer than getLatestTick().
+     * @param dest The frame to copy into, which doesn't allocate once its measurements hold getMaxChannels().
+     * @return True if read, false if the frame was overwritten by a newer one.
+     */
+    bool readFrame (uint64_t tick, Frame& dest) const;
+
+    /**
+     * @return The most recent tick published, 0 if none.
+     */
+    [[nodiscard]] uint64_t getLatestTick() const;
+
+    /**
+     * @return The identifier of the writer's session, which changes when a writer takes over the segment.
+     */
+    [[nodiscard]] uint64_t getSessionId() const;
+
+    /**
+     * @return The max number of channels per frame.
+     */
+    [[nodiscard]] int getMaxChannels() const;
+
+private:
+    struct SegmentHeader;
+    struct FrameHeader;
+    struct ChannelSlot;
+
+    std::unique_ptr<juce::MemoryMappedFile> mMappedFile;
+    uint8_t* mData = nullptr;
+    int mMaxChannels = 0;
+    size_t mFrameStride = 0;
+
+    /// The next tick to publish, only used by the writer.
+    uint64_t mNextTick = 1;
+
+    LevelMeterSharedMemory (std::unique_ptr<juce::MemoryMappedFile> mappedFile, int maxChannels);
+
+    [[nodiscard]] SegmentHeader& getHeader() const;
+    [[nodiscard]] FrameHeader& getFrameHeader (uint64_t tick) const;
+    [[nodiscard]] ChannelSlot* getChannelSlots (uint64_t tick) const;
+
+    /**
+     * @return The size of a segment with given number of channels.
+     */
+    static size_t getSegmentSize (int maxChannels);
+
+    /**
+     * @return The distance between frames in a segment with given number of channels.
+     */
+    static size_t getFrameStride (int maxChannels);
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "LevelMeterConstants.h"
+#include "MeterClock.h"
 
 #include <cstdint>
 #include <juce_audio_basics/juce_audio_basics.h>
@@ -41,25 +42,46 @@ public:
             mHighestLevel = level;
 
             if (mHighestLevel > mReturningLevel)
-                mPeakHoldTimeLeft = mPeakHoldTime;
+                mPeakHoldTimeLeft = static_cast<double> (mPeakHoldTime);
         }
     }
 
+    /**
+     * Sets the clock which getNextLevel() reads, which is the system clock by default.
+     * @param clock The clock. Must outlive this value.
+     */
+    void setClock (const MeterClock& clock)
+    {
+        mClock = &clock;
+        mPreviousTimeMs = clock.getTimeMs();
+    }
+
     /**
      * Gets the next level to show on a meter, taking into account the return rate. The level will be calculated for
-     * this point in time using a monotonic system clock.
+     * the current time of the clock (see setClock()).
      * @return The level for this point in time.
      */
     SampleType getNextLevel()
     {
-        auto deltaTime = getDeltaTime();
-        SampleType declineDb = deltaTime / 1000.0 * mReturnRateDbPerSecond;
+        return getNextLevel (getDeltaTime());
+    }
 
-        auto declineGain = juce::Decibels::decibelsToGain (-declineDb, mMinusInfinityDb);
+    /**
+     * Gets the next level to show on a meter, taking into account the return rate, after given amount of time has
+     * passed since the previous call. Use this to drive the value by another clock than the system clock, like the
+     * position in an audio stream.
+     * @param deltaTimeMs The time since the previous call, in milliseconds.
+     * @return The level for this point in time.
+     */
+    SampleType getNextLevel (double const deltaTimeMs)
+    {
+        SampleType declineDb = static_cast<SampleType> (deltaTimeMs / 1000.0) * mReturnRateDbPerSecond;
 
-        mPeakHoldTimeLeft = mPeakHoldTimeLeft > deltaTime ? mPeakHoldTimeLeft - deltaTime : 0;
+        auto declineGain = juce::Decibels::decibelsToGain (-declineDb, static_cast<SampleType> (mMinusInfinityDb));
 
-        if (mPeakHoldTimeLeft == 0)
+        mPeakHoldTimeLeft = mPeakHoldTimeLeft > deltaTimeMs ? mPeakHoldTimeLeft - deltaTimeMs : 0.0;
+
+        if (mPeakHoldTimeLeft <= 0.0)
             mReturningLevel *= declineGain;
 
         if (mHighestLevel > mReturningLevel)
@@ -96,7 +118,7 @@ public:
     {
         mHighestLevel = {};
         mReturningLevel = {};
-        mPreviousTime = {};
+        mPreviousTimeMs = {};
         mPeakHoldTime = {};
         mPeakHoldTimeLeft = {};
     }
@@ -111,8 +133,11 @@ private:
     /// Used for storing the highest level passed to UpdateLevel().
     SampleType mReturningLevel { 0.0 };
 
-    /// Used for finding the time since the previous call to DeltaTime().
-    uint32_t mPreviousTime { 0 };
+    /// The clock to read the time from.
+    const MeterClock* mClock = &MeterClock::getSystemClock();
+
+    /// Used for finding the time since the previous call to getDeltaTime().
+    double mPreviousTimeMs { 0.0 };
 
     /// Specifies the lowest level of audio which equals to zero gain.
     double mMinusInfinityDb = { LevelMeterConstants::kDefaultMinusInfinityDb };
@@ -120,17 +145,19 @@ private:
     /// Runtime setting for the amount of time the value needs to be held at the highest value.
     uint32_t mPeakHoldTime { 0 };
 
-    /// Keeps track of the time the value still needs to hold.
-    uint32_t mPeakHoldTimeLeft { 0 };
+    /// Keeps track of the time (in milliseconds) the value still needs to hold.
+    double mPeakHoldTimeLeft { 0.0 };
 
     /**
      * @return The amount of time (in milliseconds) since the previous call to this method.
      */
-    uint32_t getDeltaTime()
+    double getDeltaTime()
     {
-        auto currentTime = juce::Time::getMillisecondCounter();
-        auto deltaTime = currentTime - mPreviousTime;
-        mPreviousTime = currentTime;
-        return deltaTime;
+        auto const currentTimeMs = mClock->getTimeMs();
+
+        // A virtual clock may have been set back, which doesn't bring back any decay.
+        auto const deltaTimeMs = std::max (0.0, currentTimeMs - mPreviousTimeMs);
+        mPreviousTimeMs = currentTimeMs;
+        return deltaTimeMs;
     }
 };
@@ -0,0 +1,141 @@
+#include "LevelStatistics.h"
+
+#include <cmath>
+#include <limits>
+
+LevelStatistics::Options LevelStatistics::Options::getDefault()
+{
+    return {};
+}
+
+LevelStatistics::Distribution::Distribution (const Options& options) :
+    histogram (options.minimumDb, options.maximumDb, options.binWidthDb)
+{
+}
+
+void LevelStatistics::Distribution::addLevel (double const level)
+{
+    // A single NaN or infinity would poison the peak and the sum of squares for good.
+    if (!std::isfinite (level))
+        return;
+
+    histogram.addLevel (level);
+    peakLevel = std::max (peakLevel, level);
+    sumOfSquares += level * level;
+}
+
+void LevelStatistics::Distribution::merge (const Distribution& other)
+{
+    histogram.merge (other.histogram);
+    peakLevel = std::max (peakLevel, other.peakLevel);
+    sumOfSquares += other.sumOfSquares;
+}
+
+void LevelStatistics::Distribution::clear()
+{
+    histogram.clear();
+    peakLevel = 0.0;
+    sumOfSquares = 0.0;
+}
+
+uint64_t LevelStatistics::Distribution::getNumEntries() const
+{
+    return histogram.getTotalCount();
+}
+
+double LevelStatistics::Distribution::getPercentileDb (double const percentile) const
+{
+    return histogram.getPercentileDb (percentile);
+}
+
+double LevelStatistics::Distribution::getAverageLevelDb() const
+{
+    auto const numEntries = getNumEntries();
+    if (numEntries == 0 || sumOfSquares <= 0.0)
+        return -std::numeric_limits<double>::infinity();
+
+    return 10.0 * std::log10 (sumOfSquares / static_cast<double> (numEntries));
+}
+
+double LevelStatistics::Distribution::getPeakLevelDb() const
+{
+    if (peakLevel <= 0.0)
+        return -std::numeric_limits<double>::infinity();
+
+    return 20.0 * std::log10 (peakLevel);
+}
+
+double LevelStatistics::Distribution::getCrestFactorDb() const
+{
+    if (peakLevel <= 0.0)
+        return 0.0;
+
+    return getPeakLevelDb() - getAverageLevelDb();
+}
+
+double LevelStatistics::Distribution::getDynamicRangeDb (double const lowPercentile, double const highPercentile) const
+{
+    return getPercentileDb (highPercentile) - getPercentileDb (lowPercentile);
+}
+
+LevelStatistics::LevelStatistics (const Options& options, int const maxChannels) :
+    Subscriber (LevelMeter::Scale::getDefaultScale(), maxChannels),
+    mOptions (options),
+    mEmptyDistribution (options)
+{
+}
+
+const LevelStatistics::Distribution& LevelStatistics::getDistribution (int const channelIndex) const
+{
+    if (juce::isPositiveAndBelow (channelIndex, static_cast<int> (mDistributions.size())))
+        return mDistributions[static_cast<size_t> (channelIndex)];
+    return mEmptyDistribution;
+}
+
+LevelStatistics::Distribution LevelStatistics::getCombinedDistribution() const
+{
+    Distribution combined (mOptions);
+
+    for (auto const& distribution : mDistributions)
+        combined.merge (distribution);
+
+    return combined;
+}
+
+void LevelStatistics::clearStatistics()
+{
+    for (auto& distribution : mDistributions)
+        distribution.clear();
+}
+
+void LevelStatistics::updateWithMeasurement (const LevelMeter::Measurement& measurement)
+{
+    auto const channelIndex = getChannelIndexForMeasurement (measurement);
+    if (!juce::isPositiveAndBelow (channelIndex, static_cast<int> (mCurrentTick.size())))
+        return;
+
+    auto& current = mCurrentTick[static_cast<size_t> (channelIndex)];
+    current = std::max (current, measurement.peakLevel);
+}
+
+void LevelStatistics::measurementUpdatesFinished()
+{
+    // One entry per tick keeps the entries evenly spread in time, whatever the block size. Ticks without any
+    // measurement (like while the audio is stopped) don't count.
+    for (size_t ch = 0; ch < mCurrentTick.size(); ch++)
+    {
+        if (mCurrentTick[ch] >= 0.0)
+            mDistributions[ch].addLevel (mCurrentTick[ch]);
+
+        mCurrentTick[ch] = -1.0;
+    }
+}
+
+void LevelStatistics::levelMeterPrepared (int const numChannels)
+{
+    // Keeps collecting when the layout stays the same, like when the sample rate changes.
+    if (static_cast<int> (mDistributions.size()) != numChannels)
+        mDistributions.assign (static_cast<size_t> (numChannels), Distribution (mOptions));
+
+    mCurrentTick.assign (static_cast<size_t> (numChannels), -1.0);
+}
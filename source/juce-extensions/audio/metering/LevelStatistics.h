@@ -0,0 +1,150 @@
+#pragma once
+
+#include "LevelMeter.h"
+#include "juce-extensions/audio/analysis/LevelHistogram.h"
+
+#include <vector>
+
+/**
+ * Subscriber which collects the distribution of the levels of every channel over a long time (minutes to hours), for
+ * programme quality control: percentiles, crest factor and dynamic range.
+ *
+ * Every tick, the highest measurement of each channel which measured anything gets added to a histogram with fixed
+ * resolution. Memory is constant and the cost per measurement is O(1), no matter how long the statistics run. The
+ * statistics can be queried at any time, and distributions of channels (or of other LevelStatistics with the same
+ * options) can be merged.
+ *
+ * The statistics describe the envelope of block peak levels, sampled at the refresh rate of the level meters: the
+ * crest factor and dynamic range reflect the macro dynamics of the programme, not the sample level crest factor of
+ * the waveform.
+ *
+ * All methods must be called from the message thread.
+ */
+class LevelStatistics : public LevelMeter::Subscriber
+{
+public:
+    struct Options
+    {
+        double minimumDb = LevelHistogram::kDefaultMinimumDb;   ///< The lower edge of the histograms.
+        double maximumDb = LevelHistogram::kDefaultMaximumDb;   ///< The upper edge of the histograms.
+        double binWidthDb = LevelHistogram::kDefaultBinWidthDb; ///< The resolution of the histograms.
+
+        /**
+         * @returns The default options.
+         */
+        static Options getDefault();
+    };
+
+    /**
+     * The level distribution of a channel, or of several merged channels.
+     */
+    struct Distribution
+    {
+        LevelHistogram histogram;  ///< The level of every entry.
+        double peakLevel = 0.0;    ///< The highest level.
+        double sumOfSquares = 0.0; ///< The sum of the squared level of every entry.
+
+        /**
+         * Constructor.
+         * @param options The layout of the histogram.
+         */
+        explicit Distribution (const Options& options = Options::getDefault());
+
+        /**
+         * Adds a level. Non-finite levels (NaN or infinity) are ignored.
+         * @param level The level as gain.
+         */
+        void addLevel (double level);
+
+        /**
+         * Merges another distribution into this one. Merging is associative and commutative, so distributions can be
+         * combined in any order. Both need to have the same options.
+         * @param other The distribution to merge.
+         */
+        void merge (const Distribution& other);
+
+        /**
+         * Resets to an empty distribution.
+         */
+        void clear();
+
+        /**
+         * @return The number of levels added.
+         */
+        [[nodiscard]] uint64_t getNumEntries() const;
+
+        /**
+         * @param percentile The percentile [0, 100].
+         * @return The level in decibels below which given percentage of the entries falls, at the resolution of the
+         * histogram.
+         */
+        [[nodiscard]] double getPercentileDb (double percentile) const;
+
+        /**
+         * @return The energy average of the levels in decibels, or minus infinity when empty.
+         */
+        [[nodiscard]] double getAverageLevelDb() const;
+
+        /**
+         * @return The highest level in decibels, or minus infinity when empty.
+         */
+        [[nodiscard]] double getPeakLevelDb() const;
+
+        /**
+         * @return The ratio of the highest level to the energy average in decibels (comparable to the peak to
+         * loudness ratio), or 0.0 when empty.
+         */
+        [[nodiscard]] double getCrestFactorDb() const;
+
+        /**
+         * @param lowPercentile The percentile of the quiet end, 10 by default.
+         * @param highPercentile The percentile of the loud end, 95 by default.
+         * @return The distance in decibels between given percentiles (comparable to the loudness range).
+         */
+        [[nodiscard]] double getDynamicRangeDb (double lowPercentile = 10.0, double highPercentile = 95.0) const;
+    };
+
+    /// Expose as public members
+    using LevelMeter::Subscriber::getNumChannels;
+    using LevelMeter::Subscriber::subscribeToLevelMeter;
+    using LevelMeter::Subscriber::unsubscribeFromLevelMeter;
+
+    /**
+     * Constructor.
+     * @param options The options.
+     * @param maxChannels The max number of channels to collect. If a meter has more channels then all channels will be
+     * folded into a single mono channel.
+     */
+    explicit LevelStatistics (const Options& options = Options::getDefault(), int maxChannels = kDefaultMaxChannels);
+
+    /**
+     * @param channelIndex The index of the channel.
+     * @return The distribution of given channel, which is empty for channels which don't exist.
+     */
+    [[nodiscard]] const Distribution& getDistribution (int channelIndex) const;
+
+    /**
+     * @return The distributions of all channels merged.
+     */
+    [[nodiscard]] Distribution getCombinedDistribution() const;
+
+    /**
+     * Clears the collected statistics, without interrupting the collection.
+     */
+    void clearStatistics();
+
+private:
+    Options mOptions;
+    std::vector<Distribution> mDistributions;
+
+    /// Returned for channels which don't exist.
+    Distribution mEmptyDistribution;
+
+    /// The highest level per channel of the current tick, negative if none.
+    std::vector<double> mCurrentTick;
+
+    // MARK: LevelMeter::Subscriber overrides -
+    void updateWithMeasurement (const LevelMeter::Measurement& measurement) override;
+    void measurementUpdatesFinished() override;
+    void levelMeterPrepared (int numChannels) override;
+};
@@ -0,0 +1,21 @@
+#include "MeterClock.h"
+
+#include <juce_core/juce_core.h>
+
+namespace
+{
+class SystemMeterClock final : public MeterClock
+{
+public:
+    [[nodiscard]] double getTimeMs() const override
+    {
+        return juce::Time::getMillisecondCounterHiRes();
+    }
+};
+} // namespace
+
+const MeterClock& MeterClock::getSystemClock()
+{
+    static const SystemMeterClock systemClock;
+    return systemClock;
+}
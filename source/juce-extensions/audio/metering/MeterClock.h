@@ -0,0 +1,62 @@
+#pragma once
+
+/**
+ * The source of time for the ballistics of meters: how far peak values decay and how long they hold between two
+ * readings. Meters follow the system clock by default. A VirtualMeterClock lets meters run at any speed instead, for
+ * example to render them offline, faster than realtime.
+ */
+class MeterClock
+{
+public:
+    virtual ~MeterClock() = default;
+
+    /**
+     * @return The current time in milliseconds. Only the difference between two readings matters.
+     */
+    [[nodiscard]] virtual double getTimeMs() const = 0;
+
+    /**
+     * @return The clock which follows the monotonic system clock, shared by all meters. Thread safe.
+     */
+    static const MeterClock& getSystemClock();
+};
+
+/**
+ * A clock which only moves when told to. Not thread safe: advance the clock from the thread which reads the meters.
+ */
+class VirtualMeterClock : public MeterClock
+{
+public:
+    /**
+     * Constructor.
+     * @param timeMs The time to start at, in milliseconds.
+     */
+    explicit VirtualMeterClock (double const timeMs = 0.0) : mTimeMs (timeMs) {}
+
+    /**
+     * Sets the current time.
+     * @param timeMs The time in milliseconds.
+     */
+    void setTimeMs (double const timeMs)
+    {
+        mTimeMs = timeMs;
+    }
+
+    /**
+     * Moves the clock forward.
+     * @param deltaTimeMs The amount of time in milliseconds.
+     */
+    void advance (double const deltaTimeMs)
+    {
+        mTimeMs += deltaTimeMs;
+    }
+
+    // MARK: MeterClock overrides -
+    [[nodiscard]] double getTimeMs() const override
+    {
+        return mTimeMs;
+    }
+
+private:
+    double mTimeMs = 0.0;
+};
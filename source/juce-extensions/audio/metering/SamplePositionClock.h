@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Estimates the position in an audio stream (in samples) at any moment, from the positions reported by the audio thread
+ * at the moments they arrived. Audio arrives in blocks, so the reported positions jump ahead by a block at a time and
+ * arrive with jitter. This clock runs at the sample rate in between, and slowly follows the reported positions, which
+ * makes the estimate steady no matter the block size.
+ */
+class SamplePositionClock
+{
+public:
+    /**
+     * Prepares the clock for a stream of given sample rate, forgetting previous observations.
+     * @param sampleRate The sample rate of the stream.
+     */
+    void prepare (double const sampleRate)
+    {
+        mSampleRate = sampleRate;
+        reset();
+    }
+
+    /**
+     * Forgets previous observations, for example because the stream restarted.
+     */
+    void reset()
+    {
+        mAnchorPosition = -1.0;
+        mAnchorTimeMs = 0.0;
+    }
+
+    /**
+     * Adds an observation of the stream.
+     * @param samplePosition The position reported by the audio thread.
+     * @param timeMs The moment the position arrived, in milliseconds.
+     */
+    void observe (int64_t const samplePosition, double const timeMs)
+    {
+        if (mSampleRate <= 0.0)
+            return;
+
+        auto const position = static_cast<double> (samplePosition);
+        auto const error = position - getPosition (timeMs);
+
+        if (!hasObservations() || std::abs (error) > kMaxErrorSeconds * mSampleRate)
+        {
+            // Too far off to follow smoothly (or the first observation), start over at the observed position.
+            mAnchorPosition = position;
+            mAnchorTimeMs = timeMs;
+            return;
+        }
+
+        mAnchorPosition = getPosition (timeMs) + error * kCorrection;
+        mAnchorTimeMs = timeMs;
+    }
+
+    /**
+     * @param timeMs The moment, in milliseconds.
+     * @return The estimated position of the stream at given moment, or -1.0 when nothing was observed yet.
+     */
+    [[nodiscard]] double getPosition (double const timeMs) const
+    {
+        if (!hasObservations())
+            return -1.0;
+        return mAnchorPosition + (timeMs - mAnchorTimeMs) / 1000.0 * mSampleRate;
+    }
+
+    /**
+     * @return True if at least one position was observed since the clock was prepared or reset.
+     */
+    [[nodiscard]] bool hasObservations() const
+    {
+        return mAnchorPosition >= 0.0;
+    }
+
+private:
+    /// When an observation is further off than this, the clock jumps to it instead of following it.
+    static constexpr double kMaxErrorSeconds = 0.25;
+
+    /// The fraction of the error which gets corrected per observation.
+    static constexpr double kCorrection = 0.05;
+
+    double mSampleRate = 0.0;
+    double mAnchorPosition = -1.0;
+    double mAnchorTimeMs = 0.0;
+};
@@ -0,0 +1,122 @@
+#include "FaderGainProcessor.h"
+
+FaderGainProcessor::Options FaderGainProcessor::Options::getDefault()
+{
+    return {};
+}
+
+FaderGainProcessor::FaderGainProcessor (const LevelMeter::Scale& scale, const Options& options) :
+    mScale (scale),
+    mGainTable (static_cast<size_t> (std::max (1, options.tableSize)) + 1),
+    mRampLengthSeconds (std::max (0.0, options.rampLengthSeconds))
+{
+    auto const numIntervals = static_cast<double> (mGainTable.size() - 1);
+
+    for (size_t i = 0; i < mGainTable.size(); i++)
+    {
+        auto const levelDb = mScale.calculateLevelDbForProportion (static_cast<double> (i) / numIntervals);
+        mGainTable[i] = juce::Decibels::decibelsToGain (levelDb, mScale.getMinusInfinityDb());
+    }
+
+    setTargetDb (std::min (0.0, mScale.calculateLevelDbForProportion (1.0)));
+}
+
+void FaderGainProcessor::prepareToPlay (double const sampleRate)
+{
+    mRampLength = std::max (1, juce::roundToInt (mRampLengthSeconds * sampleRate));
+
+    mCurrentTargetProportion = mTargetProportion.load (std::memory_order_relaxed);
+    mTargetGain = lookUpGain (mCurrentTargetProportion);
+    mGain = mTargetGain;
+    mGainStep = 0.0;
+    mNumRampSamplesLeft = 0;
+}
+
+void FaderGainProcessor::setTargetProportion (double const proportion)
+{
+    mTargetProportion.store (static_cast<float> (juce::jlimit (0.0, 1.0, proportion)), std::memory_order_relaxed);
+}
+
+void FaderGainProcessor::setTargetDb (double const levelDb)
+{
+    setTargetProportion (mScale.calculateProportionForLevelDb (levelDb));
+}
+
+const LevelMeter::Scale& FaderGainProcessor::getScale() const
+{
+    return mScale;
+}
+
+template <typename SampleType>
+void FaderGainProcessor::process (juce::AudioBuffer<SampleType>& audioBuffer)
+{
+    process (audioBuffer.getArrayOfWritePointers(), audioBuffer.getNumChannels(), audioBuffer.getNumSamples());
+}
+
+// Trigger symbol generation.
+template void FaderGainProcessor::process (juce::AudioBuffer<float>& audioBuffer);
+template void FaderGainProcessor::process (juce::AudioBuffer<double>& audioBuffer);
+
+template <typename SampleType>
+void FaderGainProcessor::process (SampleType* const* channelData, int const numChannels, int const numSamples)
+{
+    updateTarget();
+
+    int offset = 0;
+
+    // The ramp gets calculated once per chunk and applied to every channel.
+    while (mNumRampSamplesLeft > 0 && offset < numSamples)
+    {
+        SampleType ramp[kRampChunkSize];
+        auto const numRampSamples = std::min ({ kRampChunkSize, mNumRampSamplesLeft, numSamples - offset });
+
+        for (int i = 0; i < numRampSamples; i++)
+            ramp[i] = static_cast<SampleType> (mGain + mGainStep * (i + 1));
+
+        for (int ch = 0; ch < numChannels; ch++)
+            juce::FloatVectorOperations::multiply (channelData[ch] + offset, ramp, numRampSamples);
+
+        mNumRampSamplesLeft -= numRampSamples;
+        mGain = mNumRampSamplesLeft > 0 ? mGain + mGainStep * numRampSamples : mTargetGain;
+        offset += numRampSamples;
+    }
+
+    if (offset >= numSamples || mGain == 1.0)
+        return;
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        if (mGain == 0.0)
+            juce::FloatVectorOperations::clear (channelData[ch] + offset, numSamples - offset);
+        else
+            juce::FloatVectorOperations::multiply (
+                channelData[ch] + offset,
+                static_cast<SampleType> (mGain),
+                numSamples - offset);
+    }
+}
+
+// Trigger symbol generation.
+template void FaderGainProcessor::process (float* const* channelData, int numChannels, int numSamples);
+template void FaderGainProcessor::process (double* const* channelData, int numChannels, int numSamples);
+
+double FaderGainProcessor::lookUpGain (float const proportion) const
+{
+    auto const position = static_cast<double> (proportion) * static_cast<double> (mGainTable.size() - 1);
+    auto const index = std::min (static_cast<size_t> (position), mGainTable.size() - 2);
+    auto const fraction = position - static_cast<double> (index);
+
+    return mGainTable[index] + (mGainTable[index + 1] - mGainTable[index]) * fraction;
+}
+
+void FaderGainProcessor::updateTarget()
+{
+    auto const targetProportion = mTargetProportion.load (std::memory_order_relaxed);
+    if (targetProportion == mCurrentTargetProportion)
+        return;
+
+    mCurrentTargetProportion = targetProportion;
+    mTargetGain = lookUpGain (targetProportion);
+    mGainStep = (mTargetGain - mGain) / mRampLength;
+    mNumRampSamplesLeft = mRampLength;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "juce-extensions/audio/metering/LevelMeter.h"
+
+#include <atomic>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+
+/**
+ * Applies the gain of a fader (like a ScaledSlider) to audio on the audio thread. The fader sets its position as an
+ * atomic target, from any thread. The audio thread turns the position into a gain through a table of the fader law
+ * which is calculated up front, so it never calls pow(), and ramps towards a new gain per sample, calculating the ramp
+ * once and applying it to all channels with vector operations. Processing doesn't allocate.
+ */
+class FaderGainProcessor
+{
+public:
+    struct Options
+    {
+        int tableSize = 1024;            ///< The number of intervals in the table of the fader law.
+        double rampLengthSeconds = 0.02; ///< The time to ramp from one gain to the next.
+
+        /**
+         * @returns The default options.
+         */
+        static Options getDefault();
+    };
+
+    /**
+     * Constructor. The gain starts at the top of the scale's range if that's below 0 dB, else at 0 dB.
+     * @param scale The scale of the fader, which defines the fader law. It must outlive this processor.
+     * @param options The options.
+     */
+    explicit FaderGainProcessor (
+        const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale(),
+        const Options& options = Options::getDefault());
+
+    JUCE_DECLARE_NON_COPYABLE (FaderGainProcessor)
+    JUCE_DECLARE_NON_MOVEABLE (FaderGainProcessor)
+
+    /**
+     * Prepares for given sample rate and jumps to the target gain. Must not be called while processing.
+     * @param sampleRate The sample rate.
+     */
+    void prepareToPlay (double sampleRate);
+
+    /**
+     * Sets the target position of the fader. Realtime safe, can be called from any thread.
+     * @param proportion The position along the fader [0.0, 1.0], as used by the scale.
+     */
+    void setTargetProportion (double proportion);
+
+    /**
+     * Sets the target gain of the fader in decibels, which gets converted to a position along the fader.
+     * @param levelDb The gain in decibels.
+     */
+    void setTargetDb (double levelDb);
+
+    /**
+     * @return The scale of the fader.
+     */
+    [[nodiscard]] const LevelMeter::Scale& getScale() const;
+
+    /**
+     * Applies the gain to a block of audio, in place. Only to be called from a single (audio) thread.
+     * @tparam SampleType The type of the audio sample.
+     * @param audioBuffer The audio buffer.
+     */
+    template <typename SampleType>
+    void process (juce::AudioBuffer<SampleType>& audioBuffer);
+
+    /**
+     * Applies the gain to a block of audio, in place. Only to be called from a single (audio) thread.
+     * @tparam SampleType The type of the audio sample.
+     * @param channelData The audio data.
+     * @param numChannels The number of channels.
+     * @param numSamples The number of samples.
+     */
+    template <typename SampleType>
+    void process (SampleType* const* channelData, int numChannels, int numSamples);
+
+private:
+    /// The number of samples of a ramp which get calculated at once, on the stack.
+    static constexpr int kRampChunkSize = 256;
+
+    const LevelMeter::Scale& mScale;
+
+    /// The gain for every position along the fader, in tableSize intervals.
+    std::vector<double> mGainTable;
+
+    std::atomic<float> mTargetProportion { 1.0f };
+
+    /// The rest is only accessed by the audio thread (and prepareToPlay()).
+    double mRampLengthSeconds = 0.02;
+    int mRampLength = 1;
+    float mCurrentTargetProportion = -1.0f;
+    double mGain = 1.0;
+    double mTargetGain = 1.0;
+    double mGainStep = 0.0;
+    int mNumRampSamplesLeft = 0;
+
+    /**
+     * @return The gain for given position along the fader, interpolated from the table.
+     */
+    [[nodiscard]] double lookUpGain (float proportion) const;
+
+    /**
+     * Starts ramping towards the target, when the target moved since the previous block.
+     */
+    void updateTarget();
+};
@@ -0,0 +1,174 @@
+#include "BackgroundRenderer.h"
+
+/**
+ * Renders a single target once. A job gets deleted by the pool only after it left the pool, so clearing the in
+ * flight flag of the target in the destructor (rather than at the end of runJob()) guarantees that the next render of
+ * a target never overlaps the previous one.
+ */
+class BackgroundRenderer::RenderJob : public juce::ThreadPoolJob
+{
+public:
+    RenderJob (BackgroundRenderer& renderer, Target& target) :
+        juce::ThreadPoolJob ("Background render"),
+        mRenderer (renderer),
+        mTarget (target)
+    {
+    }
+
+    ~RenderJob() override
+    {
+        mTarget.renderFinished();
+
+        // The target (and maybe the renderer's last owner) can go away from here on, the renderer itself only after
+        // its workers stopped.
+        mRenderer.mNumPendingRenders.fetch_sub (1, std::memory_order_release);
+    }
+
+    JobStatus runJob() override
+    {
+        mTarget.render();
+        return jobHasFinished;
+    }
+
+private:
+    BackgroundRenderer& mRenderer;
+    Target& mTarget;
+};
+
+BackgroundRenderer::BackgroundRenderer() : mThreadPool (std::max (1, juce::SystemStats::getNumCpus() - 1))
+{
+}
+
+BackgroundRenderer::~BackgroundRenderer()
+{
+    // All targets hold a reference to the renderer, so they should be gone (and their renders finished) by now.
+    jassert (mNumPendingRenders.load() == 0);
+}
+
+int BackgroundRenderer::getNumThreads() const
+{
+    return mThreadPool.getNumThreads();
+}
+
+void BackgroundRenderer::waitUntilIdle() const
+{
+    while (mNumPendingRenders.load (std::memory_order_acquire) > 0)
+        juce::Thread::yield();
+}
+
+void BackgroundRenderer::startRender (Target& target)
+{
+    mNumPendingRenders.fetch_add (1, std::memory_order_relaxed);
+    mThreadPool.addJob (new RenderJob (*this, target), true);
+}
+
+BackgroundRenderer::Target::Target (juce::Component& component) : mComponent (component)
+{
+}
+
+BackgroundRenderer::Target::~Target()
+{
+    // Subclasses must stop rendering in their own destructor, a worker might be inside renderSnapshot() otherwise.
+    jassert (mIsStopped.load() && !mIsRendering.load());
+    stopRendering();
+}
+
+void BackgroundRenderer::Target::requestRender()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    if (mIsStopped.load (std::memory_order_relaxed) || !mComponent.isVisible())
+        return;
+
+    mIsRenderRequested = true;
+
+    if (!mIsRendering.load (std::memory_order_acquire))
+        startRender();
+}
+
+void BackgroundRenderer::Target::drawRenderedImage (juce::Graphics& g)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    mImages.update();
+    const auto& image = mImages.getReadBuffer();
+
+    // Until the next render finishes, a resized component shows the previous image stretched.
+    if (image.isValid())
+        g.drawImage (image, mComponent.getLocalBounds().toFloat());
+}
+
+void BackgroundRenderer::Target::stopRendering()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    mIsStopped.store (true, std::memory_order_relaxed);
+
+    // A render which didn't start yet returns right away, so this only waits for at most one render.
+    while (mIsRendering.load (std::memory_order_acquire))
+        juce::Thread::yield();
+
+    cancelPendingUpdate();
+}
+
+void BackgroundRenderer::Target::startRender()
+{
+    jassert (!mIsRendering.load()); // Renders of the same target must never overlap.
+
+    mIsRenderRequested = false;
+
+    takeSnapshot();
+    mBounds = mComponent.getLocalBounds();
+    mScaleFactor = juce::Component::getApproximateScaleFactorForComponent (&mComponent);
+
+    mIsRendering.store (true, std::memory_order_relaxed);
+    mRenderer->startRender (*this);
+}
+
+void BackgroundRenderer::Target::render()
+{
+    if (mIsStopped.load (std::memory_order_relaxed) || mBounds.isEmpty())
+        return;
+
+    auto const width = juce::roundToInt (static_cast<float> (mBounds.getWidth()) * mScaleFactor);
+    auto const height = juce::roundToInt (static_cast<float> (mBounds.getHeight()) * mScaleFactor);
+
+    // Every image of the triple buffer gets allocated on its own, copies of a juce::Image would share their pixels.
+    auto& image = mImages.getWriteBuffer();
+
+    if (image.getWidth() != width || image.getHeight() != height)
+        image = juce::Image (juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+    else
+        image.clear (image.getBounds());
+
+    {
+        juce::Graphics g (image);
+        g.addTransform (juce::AffineTransform::scale (mScaleFactor));
+        renderSnapshot (g, mBounds);
+    }
+
+    mImages.publish();
+}
+
+void BackgroundRenderer::Target::renderFinished()
+{
+    triggerAsyncUpdate();
+
+    // The last access to the target, which may get destroyed from here on.
+    mIsRendering.store (false, std::memory_order_release);
+}
+
+void BackgroundRenderer::Target::handleAsyncUpdate()
+{
+    mComponent.repaint();
+
+    if (!mIsRenderRequested || mIsStopped.load (std::memory_order_relaxed))
+        return;
+
+    // The worker triggers this update right before clearing the flag, so the previous render might not have let go of
+    // the target yet. Look again on the next update instead of starting a render which would overlap it.
+    if (mIsRendering.load (std::memory_order_acquire))
+        triggerAsyncUpdate();
+    else
+        startRender();
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "juce-extensions/core/TripleBuffer.h"
+
+#include <atomic>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * Rasterises components on a pool of worker threads, so that painting hundreds of meters at once doesn't stall the
+ * message thread. A component hands a snapshot of what it shows to its Target, a worker draws the snapshot into an
+ * image and paint() only composites the finished image. Every target has at most one render in flight, so the work
+ * gets split across the cores by target (i.e. by meter).
+ *
+ * Access the renderer through juce::SharedResourcePointer<BackgroundRenderer>, or let a Target do so.
+ */
+class BackgroundRenderer
+{
+public:
+    class Target;
+
+    /**
+     * Constructor, starts a worker thread per core but one, which is left for the message and audio threads.
+     */
+    BackgroundRenderer();
+
+    ~BackgroundRenderer();
+
+    JUCE_DECLARE_NON_COPYABLE (BackgroundRenderer)
+    JUCE_DECLARE_NON_MOVEABLE (BackgroundRenderer)
+
+    /**
+     * @return The number of worker threads.
+     */
+    [[nodiscard]] int getNumThreads() const;
+
+    /**
+     * Blocks until all renders which have been started are finished. Meant for benchmarks and offline use, a UI
+     * doesn't need to wait for anything.
+     */
+    void waitUntilIdle() const;
+
+private:
+    class RenderJob;
+
+    /// The number of renders which have been started and not finished.
+    std::atomic<int> mNumPendingRenders { 0 };
+
+    /// Declared last, so that the workers are stopped before anything else goes away.
+    juce::ThreadPool mThreadPool;
+
+    /**
+     * Starts rendering given target on a worker thread.
+     */
+    void startRender (Target& target);
+};
+
+/**
+ * The part of a component which gets rendered by a BackgroundRenderer. Owned by the component, and only to be used from
+ * the message thread unless noted otherwise.
+ *
+ * Subclasses must call stopRendering() in their destructor, since a worker may be calling renderSnapshot() until then.
+ */
+class BackgroundRenderer::Target : private juce::AsyncUpdater
+{
+public:
+    /**
+     * Constructor.
+     * @param component The component to render, which gets repainted whenever a new image is ready. Must outlive
+     * this target.
+     */
+    explicit Target (juce::Component& component);
+
+    ~Target() override;
+
+    JUCE_DECLARE_NON_COPYABLE (Target)
+    JUCE_DECLARE_NON_MOVEABLE (Target)
+
+    /**
+     * Renders the component with its current state. When a render is still in flight, the request is remembered
+     * and a single render of the latest state follows when it finishes. Does nothing while the component is
+     * invisible.
+     */
+    void requestRender();
+
+    /**
+     * Draws the most recently rendered image over the local bounds of the component. To be called from paint().
+     * @param g The graphics context to draw to.
+     */
+    void drawRenderedImage (juce::Graphics& g);
+
+protected:
+    /**
+     * Waits for the render in flight (if any) to finish and prevents further renders.
+     */
+    void stopRendering();
+
+    /**
+     * Called on the message thread right before a render starts, to copy the state which renderSnapshot() draws.
+     * The copy is owned by the worker until the render finishes, so it isn't touched again before the next call.
+     */
+    virtual void takeSnapshot() = 0;
+
+    /**
+     * Called on a worker thread to draw the state copied by takeSnapshot(). Must not touch the component.
+     * @param g The graphics context of the image.
+     * @param bounds The local bounds of the component at the time of the snapshot.
+     */
+    virtual void renderSnapshot (juce::Graphics& g, juce::Rectangle<int> bounds) = 0;
+
+private:
+    friend class BackgroundRenderer;
+
+    juce::SharedResourcePointer<BackgroundRenderer> mRenderer;
+    juce::Component& mComponent;
+
+    /// The images, written by the worker rendering this target and read by paint().
+    TripleBuffer<juce::Image> mImages;
+
+    /// The bounds and scale of the snapshot, owned by the worker while a render is in flight.
+    juce::Rectangle<int> mBounds;
+    float mScaleFactor = 1.0f;
+
+    /// Set when a render was requested while another one was in flight.
+    bool mIsRenderRequested = false;
+
+    /// Set by the message thread when a render starts, cleared by the worker when it's finished.
+    std::atomic<bool> mIsRendering { false };
+
+    std::atomic<bool> mIsStopped { false };
+
+    /**
+     * Takes a snapshot and starts rendering it.
+     */
+    void startRender();
+
+    /**
+     * Draws the snapshot into the next image and publishes it. Called on a worker thread.
+     */
+    void render();
+
+    /**
+     * Called on a worker thread once a render (whether it drew anything or not) is finished.
+     */
+    void renderFinished();
+
+    // MARK: juce::AsyncUpdater overrides -
+    void handleAsyncUpdate() override;
+};
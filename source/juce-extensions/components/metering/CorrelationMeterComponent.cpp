@@ -0,0 +1,65 @@
+#include "CorrelationMeterComponent.h"
+
+CorrelationMeterComponent::CorrelationMeterComponent() : Subscriber (LevelMeter::Scale::getDefaultScale(), 2) {}
+
+CorrelationMeterComponent::CorrelationMeterComponent (LevelMeter& levelMeter) : CorrelationMeterComponent()
+{
+    subscribeToLevelMeter (levelMeter);
+}
+
+void CorrelationMeterComponent::paint (juce::Graphics& g)
+{
+    auto bounds = getLocalBounds();
+    auto meterBounds = bounds.toFloat();
+
+    auto const isHorizontal = getWidth() > getHeight();
+    auto const proportion = static_cast<float> ((mCorrelation + 1.0) / 2.0);
+
+    // Negative correlation indicates phase problems.
+    g.setColour (mCorrelation < 0.0 ? juce::Colours::red : juce::Colours::darkgreen);
+
+    if (isHorizontal)
+    {
+        auto const centre = meterBounds.getCentreX();
+        auto const position = meterBounds.getX() + meterBounds.getWidth() * proportion;
+        g.fillRect (meterBounds.withLeft (std::min (centre, position)).withWidth (std::abs (position - centre)));
+
+        g.setColour (juce::Colours::black);
+        g.drawVerticalLine (juce::roundToInt (centre), meterBounds.getY(), meterBounds.getBottom());
+    }
+    else
+    {
+        auto const centre = meterBounds.getCentreY();
+        auto const position = meterBounds.getBottom() - meterBounds.getHeight() * proportion;
+        g.fillRect (meterBounds.withTop (std::min (centre, position)).withHeight (std::abs (position - centre)));
+
+        g.setColour (juce::Colours::black);
+        g.drawHorizontalLine (juce::roundToInt (centre), meterBounds.getX(), meterBounds.getRight());
+    }
+
+    g.setColour (juce::Colours::black);
+    g.drawRect (bounds);
+}
+
+void CorrelationMeterComponent::measurementUpdatesFinished()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    auto const correlation = getCorrelation();
+
+    if (std::abs (correlation - mCorrelation) > 0.001)
+    {
+        mCorrelation = correlation;
+        repaint();
+    }
+}
+
+void CorrelationMeterComponent::levelMeterPrepared ([[maybe_unused]] int numChannels)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+}
+
+bool CorrelationMeterComponent::isShowingMeasurements() const
+{
+    return isShowing();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "juce-extensions/audio/metering/LevelMeter.h"
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * Component which shows the correlation between the left and right channel of a level meter, ranging from -1 (out of
+ * phase) via 0 (uncorrelated) to +1 (mono). Requires stereo analysis to be enabled on the level meter.
+ */
+class CorrelationMeterComponent : public juce::Component, LevelMeter::Subscriber
+{
+public:
+    /// Expose as public members
+    using LevelMeter::Subscriber::subscribeToLevelMeter;
+    using LevelMeter::Subscriber::unsubscribeFromLevelMeter;
+
+    CorrelationMeterComponent();
+
+    /**
+     * Constructor.
+     * @param levelMeter The level meter to subscribe to.
+     */
+    explicit CorrelationMeterComponent (LevelMeter& levelMeter);
+
+    // MARK: juce::Component overrides -
+    void paint (juce::Graphics& g) override;
+
+private:
+    /// The correlation as shown during the last paint.
+    double mCorrelation = 0.0;
+
+    // MARK: LevelMeter::Subscriber overrides -
+    void measurementUpdatesFinished() override;
+    void levelMeterPrepared (int numChannels) override;
+    [[nodiscard]] bool isShowingMeasurements() const override;
+};
@@ -0,0 +1,59 @@
+#include "GoniometerComponent.h"
+
+GoniometerComponent::GoniometerComponent() : Subscriber (LevelMeter::Scale::getDefaultScale(), 2) {}
+
+GoniometerComponent::GoniometerComponent (LevelMeter& levelMeter) : GoniometerComponent()
+{
+    subscribeToLevelMeter (levelMeter);
+}
+
+void GoniometerComponent::paint (juce::Graphics& g)
+{
+    auto const bounds = getLocalBounds();
+    auto const size = static_cast<float> (std::min (getWidth(), getHeight()));
+    auto const centre = bounds.toFloat().getCentre();
+
+    // Rotate by 45 degrees, so mono ends up vertical. Full scale on both channels reaches the edge.
+    auto const scale = size / 2.0f / juce::MathConstants<float>::sqrt2;
+
+    g.setColour (juce::Colours::darkgrey);
+    g.drawVerticalLine (juce::roundToInt (centre.getX()), centre.getY() - size / 2.0f, centre.getY() + size / 2.0f);
+    g.drawHorizontalLine (juce::roundToInt (centre.getY()), centre.getX() - size / 2.0f, centre.getX() + size / 2.0f);
+
+    g.setColour (juce::Colours::darkgreen.brighter());
+
+    for (size_t i = 0; i < mPoints.left.size(); i++)
+    {
+        auto const left = mPoints.left[i];
+        auto const right = mPoints.right[i];
+
+        auto const x = centre.getX() + (right - left) * scale;
+        auto const y = centre.getY() - (left + right) * scale;
+
+        g.fillRect (x, y, 1.0f, 1.0f);
+    }
+
+    g.setColour (juce::Colours::black);
+    g.drawRect (bounds);
+}
+
+void GoniometerComponent::updateWithGoniometerPoints (const LevelMeter::GoniometerPoints& goniometerPoints)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    mPoints = goniometerPoints;
+    repaint();
+}
+
+void GoniometerComponent::levelMeterPrepared ([[maybe_unused]] int numChannels)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    mPoints = {};
+    repaint();
+}
+
+bool GoniometerComponent::isShowingMeasurements() const
+{
+    return isShowing();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "juce-extensions/audio/metering/LevelMeter.h"
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * Component which shows a goniometer (vectorscope) of the left and right channel of a level meter. Mono signals show
+ * up as a vertical line, out of phase signals as a horizontal line. Requires stereo analysis to be enabled on the level
+ * meter.
+ */
+class GoniometerComponent : public juce::Component, LevelMeter::Subscriber
+{
+public:
+    /// Expose as public members
+    using LevelMeter::Subscriber::subscribeToLevelMeter;
+    using LevelMeter::Subscriber::unsubscribeFromLevelMeter;
+
+    GoniometerComponent();
+
+    /**
+     * Constructor.
+     * @param levelMeter The level meter to subscribe to.
+     */
+    explicit GoniometerComponent (LevelMeter& levelMeter);
+
+    // MARK: juce::Component overrides -
+    void paint (juce::Graphics& g) override;
+
+private:
+    /// Copy of the most recent points, so painting never touches the level meter.
+    LevelMeter::GoniometerPoints mPoints;
+
+    // MARK: LevelMeter::Subscriber overrides -
+    void updateWithGoniometerPoints (const LevelMeter::GoniometerPoints& goniometerPoints) override;
+    void levelMeterPrepared (int numChannels) override;
+    [[nodiscard]] bool isShowingMeasurements() const override;
+};
@@ -0,0 +1,72 @@
+#include "LevelHistoryComponent.h"
+
+LevelHistoryComponent::LevelHistoryComponent (LevelHistory& levelHistory, const LevelMeter::Scale& scale) :
+    mLevelHistory (levelHistory),
+    mScale (scale)
+{
+    mLevelHistorySubscription = mLevelHistory.addListener (this);
+}
+
+void LevelHistoryComponent::setVisibleDuration (double const seconds)
+{
+    mVisibleDurationSeconds = std::max (seconds, 1.0 / LevelHistory::getTicksPerSecond());
+    repaint();
+}
+
+void LevelHistoryComponent::paint (juce::Graphics& g)
+{
+    auto bounds = getLocalBounds();
+    auto historyBounds = bounds.toFloat();
+
+    auto const numChannels = mLevelHistory.getNumChannels();
+    auto const numPixels = getWidth();
+
+    if (numChannels <= 0 || numPixels <= 0)
+        return;
+
+    mPixels.resize (static_cast<size_t> (numPixels));
+
+    auto const endTick = mLevelHistory.getNumTicksRecorded();
+    auto const startTick =
+        endTick - static_cast<int64_t> (std::ceil (mVisibleDurationSeconds * LevelHistory::getTicksPerSecond()));
+
+    auto laneSeparationSpace = 1.f;
+    float const laneSize = (historyBounds.getHeight() - (laneSeparationSpace * static_cast<float> (numChannels - 1))) /
+                           static_cast<float> (numChannels);
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        if (ch > 0)
+            historyBounds.removeFromTop (laneSeparationSpace);
+
+        auto laneBounds = historyBounds.removeFromTop (laneSize);
+
+        mLevelHistory.getMinMaxForPixels (ch, startTick, endTick, mPixels.data(), numPixels);
+
+        for (int x = 0; x < numPixels; x++)
+        {
+            auto const& pixel = mPixels[static_cast<size_t> (x)];
+            if (!pixel.isValid)
+                continue;
+
+            auto const minProportion = static_cast<float> (mScale.calculateProportionForLevel (pixel.min));
+            auto const maxProportion = static_cast<float> (mScale.calculateProportionForLevel (pixel.max));
+
+            auto const isOverloaded = pixel.max >= LevelMeterConstants::kOverloadTriggerLevel;
+            g.setColour (isOverloaded ? juce::Colours::red : juce::Colours::darkgreen);
+            g.drawVerticalLine (
+                x,
+                laneBounds.getBottom() - laneBounds.getHeight() * maxProportion,
+                laneBounds.getBottom() - laneBounds.getHeight() * minProportion + 1.f);
+        }
+    }
+
+    g.setColour (juce::Colours::black);
+    g.drawRect (bounds);
+}
+
+void LevelHistoryComponent::levelHistoryUpdated()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+    repaint();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "juce-extensions/audio/metering/LevelHistory.h"
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * Component which draws the recorded history of a LevelHistory as a scrolling min/max envelope per channel.
+ */
+class LevelHistoryComponent : public juce::Component, LevelHistory::Listener
+{
+public:
+    /// The default amount of time shown.
+    static constexpr double kDefaultVisibleDurationSeconds = 60.0;
+
+    /**
+     * Constructor.
+     * @param levelHistory The history to draw. Must outlive this component.
+     * @param scale The scale to use.
+     */
+    explicit LevelHistoryComponent (
+        LevelHistory& levelHistory,
+        const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale());
+
+    /**
+     * Sets the amount of time to show, ending at the most recent tick.
+     * @param seconds The amount of time in seconds.
+     */
+    void setVisibleDuration (double seconds);
+
+    // MARK: juce::Component overrides -
+    void paint (juce::Graphics& g) override;
+
+private:
+    LevelHistory& mLevelHistory;
+    const LevelMeter::Scale& mScale;
+    rdk::Subscription mLevelHistorySubscription;
+    double mVisibleDurationSeconds = kDefaultVisibleDurationSeconds;
+
+    /// Holds the values for each pixel, kept around to prevent allocations while painting.
+    std::vector<LevelHistory::MinMax> mPixels;
+
+    // MARK: LevelHistory::Listener overrides -
+    void levelHistoryUpdated() override;
+};
@@ -1,5 +1,41 @@
 #include "LevelMeterComponent.h"
 
+/**
+ * Renders the meter on the worker threads from a snapshot of the levels, taken after a tick.
+ */
+class LevelMeterComponent::BackgroundTarget final : public BackgroundRenderer::Target
+{
+public:
+    explicit BackgroundTarget (LevelMeterComponent& levelMeterComponent) :
+        Target (levelMeterComponent),
+        mLevelMeterComponent (levelMeterComponent)
+    {
+    }
+
+    ~BackgroundTarget() override
+    {
+        stopRendering();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (BackgroundTarget)
+    JUCE_DECLARE_NON_MOVEABLE (BackgroundTarget)
+
+private:
+    LevelMeterComponent& mLevelMeterComponent;
+    std::vector<ChannelLevels> mChannelLevels;
+
+    // MARK: BackgroundRenderer::Target overrides -
+    void takeSnapshot() override
+    {
+        mLevelMeterComponent.takeChannelLevels (mChannelLevels);
+    }
+
+    void renderSnapshot (juce::Graphics& g, juce::Rectangle<int> const bounds) override
+    {
+        drawMeter (g, bounds, mLevelMeterComponent.getScale(), mChannelLevels);
+    }
+};
+
 LevelMeterComponent::Options LevelMeterComponent::Options::getDefault()
 {
     return {};
@@ -12,9 +48,19 @@ LevelMeterComponent::Options LevelMeterComponent::Options::withMaxChannels (int
     return copy;
 }
 
-LevelMeterComponent::LevelMeterComponent (const LevelMeter::Scale& scale, [[maybe_unused]] const Options& options) :
-    Subscriber (scale, options.maxChannels)
+LevelMeterComponent::Options LevelMeterComponent::Options::withRenderingMode (
+    RenderingMode const newRenderingMode) const
 {
+    auto copy = *this;
+    copy.renderingMode = newRenderingMode;
+    return copy;
+}
+
+LevelMeterComponent::LevelMeterComponent (const LevelMeter::Scale& scale, const Options& options) :
+    Subscriber (scale, options.maxChannels),
+    mOptions (options)
+{
+    updateRenderingMode();
 }
 
 LevelMeterComponent::LevelMeterComponent (
@@ -26,24 +72,27 @@ LevelMeterComponent::LevelMeterComponent (
     subscribeToLevelMeter (levelMeter);
 }
 
+LevelMeterComponent::~LevelMeterComponent()
+{
+    // Waits for a render in flight, which reads the scale of this component.
+    mBackgroundTarget.reset();
+}
+
 void LevelMeterComponent::measurementUpdatesFinished()
 {
     JUCE_ASSERT_MESSAGE_THREAD;
 
-    bool isSilent { true };
+    // Only inspects the active channels, silent channels cost nothing.
+    auto const isSilent = Subscriber::isSilent();
 
-    for (int ch = 0; ch < getNumChannels(); ++ch)
+    if (!isSilent || !mWasSilent)
     {
-        if (getScale().calculateProportionForLevel (std::max (getPeakValue (ch), getPeakHoldValue (ch))) > .001)
-        {
-            isSilent = false;
-            break;
-        }
+        if (mBackgroundTarget != nullptr)
+            mBackgroundTarget->requestRender();
+        else
+            repaint();
     }
 
-    if (!isSilent || !mWasSilent)
-        repaint();
-
     mWasSilent = isSilent;
 }
 
@@ -52,37 +101,87 @@ void LevelMeterComponent::levelMeterPrepared ([[maybe_unused]] int numChannels)
     JUCE_ASSERT_MESSAGE_THREAD;
 }
 
+bool LevelMeterComponent::isShowingMeasurements() const
+{
+    return isShowing();
+}
+
 void LevelMeterComponent::setOptions (const LevelMeterComponent::Options& options)
 {
     mOptions = options;
+    updateRenderingMode();
     repaint();
 }
 
 void LevelMeterComponent::paint (juce::Graphics& g)
 {
-    auto isHorizontal = getWidth() > getHeight();
+    if (mBackgroundTarget != nullptr)
+    {
+        mBackgroundTarget->drawRenderedImage (g);
+        return;
+    }
+
+    takeChannelLevels (mChannelLevels);
+    drawMeter (g, getLocalBounds(), getScale(), mChannelLevels);
+}
+
+void LevelMeterComponent::resized()
+{
+    if (mBackgroundTarget != nullptr)
+        mBackgroundTarget->requestRender();
+}
+
+void LevelMeterComponent::visibilityChanged()
+{
+    if (mBackgroundTarget != nullptr)
+        mBackgroundTarget->requestRender();
+}
+
+void LevelMeterComponent::takeChannelLevels (std::vector<ChannelLevels>& channels)
+{
+    auto const numChannels = getNumChannels();
+    channels.resize (static_cast<size_t> (std::max (0, numChannels)));
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        auto& channel = channels[static_cast<size_t> (ch)];
+        channel.peakLevel = getPeakValue (ch);
+        channel.peakHoldLevel = getPeakHoldValue (ch);
+        channel.isReducedAccuracy = isReducedAccuracy (ch);
+    }
+}
+
+void LevelMeterComponent::drawMeter (
+    juce::Graphics& g,
+    juce::Rectangle<int> const bounds,
+    const LevelMeter::Scale& scale,
+    const std::vector<ChannelLevels>& channels)
+{
+    auto isHorizontal = bounds.getWidth() > bounds.getHeight();
 
-    auto bounds = getLocalBounds();
     auto meterBounds = bounds.toFloat();
 
-    auto numChannels = getNumChannels();
+    auto numChannels = static_cast<int> (channels.size());
 
     auto barSeparationSpace = 1.f;
     auto totalSize = isHorizontal ? meterBounds.getHeight() : meterBounds.getWidth();
     float const barSize = (totalSize - (barSeparationSpace * static_cast<float> (numChannels - 1))) /
                           static_cast<float> (numChannels);
 
-    const auto& scale = getScale();
-
     // Draw level bars and peak hold values.
     for (int ch = 0; ch < numChannels; ch++)
     {
-        auto const peak = getPeakValue (ch);
-        auto const peakProportion = scale.calculateProportionForLevel (peak);
+        const auto& channel = channels[static_cast<size_t> (ch)];
+
+        auto const peakProportion = scale.calculateProportionForLevel (channel.peakLevel);
 
-        auto const peakHold = getPeakHoldValue (ch);
+        auto const peakHold = channel.peakHoldLevel;
         auto const peakHoldProportion = scale.calculateProportionForLevel (peakHold);
 
+        // Dim the bar while the level meter sheds load, to show the level is less accurate.
+        auto const barColour = channel.isReducedAccuracy ? juce::Colours::darkgreen.withMultipliedAlpha (0.6f)
+                                                         : juce::Colours::darkgreen;
+
         if (ch > 0)
         {
             isHorizontal ? meterBounds.removeFromTop (barSeparationSpace)
@@ -99,7 +198,7 @@ void LevelMeterComponent::paint (juce::Graphics& g)
                 g.fillRect (barBounds.withLeft (barBounds.getWidth() - kOverloadAreaSize));
             }
 
-            g.setColour (juce::Colours::darkgreen);
+            g.setColour (barColour);
             g.fillRect (barBounds.withWidth (
                 (meterBounds.getWidth() - static_cast<float> (kOverloadAreaSize)) *
                 static_cast<float> (peakProportion)));
@@ -120,7 +219,7 @@ void LevelMeterComponent::paint (juce::Graphics& g)
                 g.fillRect (barBounds.withBottom (kOverloadAreaSize));
             }
 
-            g.setColour (juce::Colours::darkgreen);
+            g.setColour (barColour);
             g.fillRect (barBounds.withTrimmedTop (
                 meterBounds.getHeight() -
                 (meterBounds.getHeight() - kOverloadAreaSize) * static_cast<float> (peakProportion)));
@@ -143,3 +242,16 @@ void LevelMeterComponent::updateWithMeasurement (const LevelMeter::Measurement&
 {
     Subscriber::updateWithMeasurement (measurement);
 }
+
+void LevelMeterComponent::updateRenderingMode()
+{
+    auto const isRenderingOnWorkerThreads = mOptions.renderingMode == RenderingMode::workerThreads;
+
+    if (isRenderingOnWorkerThreads == (mBackgroundTarget != nullptr))
+        return;
+
+    mBackgroundTarget = isRenderingOnWorkerThreads ? std::make_unique<BackgroundTarget> (*this) : nullptr;
+
+    if (mBackgroundTarget != nullptr)
+        mBackgroundTarget->requestRender();
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "BackgroundRenderer.h"
 #include "juce-extensions/audio/metering/LevelMeter.h"
 
 #include <juce_gui_basics/juce_gui_basics.h>
@@ -13,6 +14,25 @@ public:
     /// The size of the overload area.
     static constexpr const int kOverloadAreaSize = 10;
 
+    /**
+     * Where the meter gets rasterised.
+     */
+    enum class RenderingMode
+    {
+        messageThread, ///< paint() draws the meter.
+        workerThreads, ///< A BackgroundRenderer draws the meter after every tick, paint() only draws the image.
+    };
+
+    /**
+     * The levels of a channel, as drawn.
+     */
+    struct ChannelLevels
+    {
+        double peakLevel = 0.0;
+        double peakHoldLevel = 0.0;
+        bool isReducedAccuracy = false;
+    };
+
     /**
      * Options to configure the behaviour of this meter.
      */
@@ -28,16 +48,24 @@ public:
         /// into a single mono channel.
         int maxChannels = kDefaultMaxChannels;
 
+        /// Where the meter gets rasterised. Rendering on worker threads keeps the message thread responsive when a lot
+        /// of meters repaint at once, at the cost of showing every tick a little later.
+        RenderingMode renderingMode = RenderingMode::messageThread;
+
         /**
          * @returns The default options.
          */
         static Options getDefault();
 
         Options withMaxChannels (int newMaxChannels) const;
+        Options withRenderingMode (RenderingMode newRenderingMode) const;
     };
 
     /// Expose as public members
     using LevelMeter::Subscriber::prepareToPlay;
+    using LevelMeter::Subscriber::setChannelMap;
+    using LevelMeter::Subscriber::setClock;
+    using LevelMeter::Subscriber::setOutputLatency;
     using LevelMeter::Subscriber::subscribeToLevelMeter;
     using LevelMeter::Subscriber::unsubscribeFromLevelMeter;
 
@@ -61,14 +89,31 @@ public:
         const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale(),
         const Options& options = Options::getDefault());
 
+    ~LevelMeterComponent() override;
+
     /**
      * Sets options for this meter.
      * @param options The new options to set.
      */
     void setOptions (const Options& options);
 
+    /**
+     * Draws a meter. Thread safe, so it can be used by a BackgroundRenderer.
+     * @param g The graphics context to draw to.
+     * @param bounds The bounds of the meter.
+     * @param scale The scale to use.
+     * @param channels The levels of every channel.
+     */
+    static void drawMeter (
+        juce::Graphics& g,
+        juce::Rectangle<int> bounds,
+        const LevelMeter::Scale& scale,
+        const std::vector<ChannelLevels>& channels);
+
     // MARK: juce::Component overrides -
     void paint (juce::Graphics& g) override;
+    void resized() override;
+    void visibilityChanged() override;
 
 protected:
     using LevelMeter::Subscriber::getNumChannels;
@@ -76,7 +121,15 @@ protected:
     using LevelMeter::Subscriber::getPeakValue;
     using LevelMeter::Subscriber::getScale;
 
+    /**
+     * Takes the levels of all channels, advancing the peak values to now.
+     * @param channels Receives the levels.
+     */
+    void takeChannelLevels (std::vector<ChannelLevels>& channels);
+
 private:
+    class BackgroundTarget;
+
     /// The amount of room left around the meter on the main axis.
     static constexpr int kMargin = 10;
 
@@ -85,8 +138,20 @@ private:
 
     bool mWasSilent { false };
 
+    /// Only exists when rendering on worker threads.
+    std::unique_ptr<BackgroundTarget> mBackgroundTarget;
+
+    /// The levels drawn by paint(), kept around to prevent allocations while painting.
+    std::vector<ChannelLevels> mChannelLevels;
+
+    /**
+     * Creates or destroys the background target to match the rendering mode of the options.
+     */
+    void updateRenderingMode();
+
     // MARK: LevelMeter::Subscriber overrides -
     void updateWithMeasurement (const LevelMeter::Measurement& measurement) override;
     void measurementUpdatesFinished() override;
     void levelMeterPrepared (int numChannels) override;
+    [[nodiscard]] bool isShowingMeasurements() const override;
 };
@@ -0,0 +1,219 @@
+#include "OfflineMeterRenderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+/**
+ * State shared by the stepping thread and all frame jobs.
+ */
+struct OfflineMeterRenderer::RenderContext
+{
+    RenderContext (const LevelMeter::Scale& scaleToUse, const FrameWriter& frameWriter, const Options& options) :
+        scale (scaleToUse),
+        writeFrame (frameWriter),
+        width (options.width),
+        height (options.height)
+    {
+    }
+
+    const LevelMeter::Scale& scale;
+    const FrameWriter& writeFrame;
+    int width = 0;
+    int height = 0;
+
+    std::atomic<int> numFramesInFlight { 0 };
+    std::atomic<bool> failed { false };
+
+    /// Signalled whenever a frame is finished.
+    juce::WaitableEvent frameFinished;
+};
+
+/**
+ * Draws and writes a single frame.
+ */
+class OfflineMeterRenderer::FrameJob : public juce::ThreadPoolJob
+{
+public:
+    FrameJob (
+        RenderContext& context,
+        int64_t const frameIndex,
+        std::vector<LevelMeterComponent::ChannelLevels> channelLevels) :
+        juce::ThreadPoolJob ("Offline meter frame"),
+        mContext (context),
+        mFrameIndex (frameIndex),
+        mChannelLevels (std::move (channelLevels))
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        if (!mContext.failed)
+        {
+            juce::Image image (juce::Image::ARGB, mContext.width, mContext.height, true, juce::SoftwareImageType());
+
+            {
+                juce::Graphics g (image);
+                LevelMeterComponent::drawMeter (g, image.getBounds(), mContext.scale, mChannelLevels);
+            }
+
+            if (!mContext.writeFrame (mFrameIndex, image))
+                mContext.failed = true;
+        }
+
+        mContext.numFramesInFlight--;
+        mContext.frameFinished.signal();
+        return jobHasFinished;
+    }
+
+private:
+    RenderContext& mContext;
+    int64_t mFrameIndex = 0;
+    std::vector<LevelMeterComponent::ChannelLevels> mChannelLevels;
+};
+
+/**
+ * The meter, fed with a measurement per channel per frame and driven by a virtual clock.
+ */
+class OfflineMeterRenderer::FrameSubscriber : public LevelMeter::Subscriber
+{
+public:
+    FrameSubscriber (const LevelMeter::Scale& scale, int const maxChannels, const MeterClock& clock, int numChannels) :
+        Subscriber (scale, maxChannels)
+    {
+        setClock (clock);
+        prepareToPlay (numChannels);
+    }
+
+    /**
+     * Takes the levels of all channels at the current time of the clock.
+     * @param channels Receives the levels.
+     */
+    void takeChannelLevels (std::vector<LevelMeterComponent::ChannelLevels>& channels)
+    {
+        auto const numChannels = getNumChannels();
+        channels.resize (static_cast<size_t> (std::max (0, numChannels)));
+
+        for (int ch = 0; ch < numChannels; ch++)
+        {
+            auto& channel = channels[static_cast<size_t> (ch)];
+            channel.peakLevel = getPeakValue (ch);
+            channel.peakHoldLevel = getPeakHoldValue (ch);
+            channel.isReducedAccuracy = false;
+        }
+    }
+
+private:
+    // MARK: LevelMeter::Subscriber overrides -
+    void levelMeterPrepared ([[maybe_unused]] int numChannels) override {}
+};
+
+OfflineMeterRenderer::Options OfflineMeterRenderer::Options::getDefault()
+{
+    return {};
+}
+
+bool OfflineMeterRenderer::render (
+    juce::AudioFormatReader& reader,
+    const FrameWriter& writeFrame,
+    const LevelMeter::Scale& scale,
+    const Options& options)
+{
+    if (reader.numChannels == 0 || reader.sampleRate <= 0.0 || options.frameRate <= 0.0 || options.width <= 0 ||
+        options.height <= 0)
+        return false;
+
+    auto const numChannels = static_cast<int> (reader.numChannels);
+    auto const samplesPerFrame = reader.sampleRate / options.frameRate;
+    auto const frameDurationMs = 1000.0 / options.frameRate;
+    auto const numFrames =
+        static_cast<int64_t> (std::ceil (static_cast<double> (reader.lengthInSamples) / samplesPerFrame));
+
+    auto const numThreads = std::max (1, options.numThreads > 0 ? options.numThreads : juce::SystemStats::getNumCpus());
+    auto const maxFramesInFlight = options.maxFramesInFlight > 0 ? options.maxFramesInFlight : 4 * numThreads;
+
+    RenderContext context (scale, writeFrame, options);
+
+    VirtualMeterClock clock;
+    FrameSubscriber subscriber (scale, options.maxChannels, clock, numChannels);
+    juce::AudioBuffer<float> buffer (numChannels, static_cast<int> (std::ceil (samplesPerFrame)) + 1);
+    auto readFailed = false;
+
+    {
+        // Declared after the context, so that the workers are stopped before the context goes away.
+        juce::ThreadPool pool (numThreads);
+
+        for (int64_t frame = 0; frame < numFrames && !context.failed; frame++)
+        {
+            // Rounding the boundaries (instead of the length) keeps frames from drifting away from the audio.
+            auto const start = static_cast<int64_t> (std::llround (static_cast<double> (frame) * samplesPerFrame));
+            auto const end = std::min (
+                static_cast<int64_t> (reader.lengthInSamples),
+                static_cast<int64_t> (std::llround (static_cast<double> (frame + 1) * samplesPerFrame)));
+            auto const numSamples = static_cast<int> (end - start);
+
+            if (!reader.read (buffer.getArrayOfWritePointers(), numChannels, start, numSamples))
+            {
+                readFailed = true;
+                break;
+            }
+
+            for (int ch = 0; ch < numChannels; ch++)
+            {
+                LevelMeter::Measurement measurement;
+                measurement.channelIndex = ch;
+                measurement.peakLevel = static_cast<double> (buffer.getMagnitude (ch, 0, numSamples));
+                measurement.samplePosition = end;
+                subscriber.updateWithMeasurement (measurement);
+            }
+
+            clock.setTimeMs (static_cast<double> (frame + 1) * frameDurationMs);
+
+            std::vector<LevelMeterComponent::ChannelLevels> channelLevels;
+            subscriber.takeChannelLevels (channelLevels);
+
+            while (context.numFramesInFlight.load() >= maxFramesInFlight)
+                context.frameFinished.wait (10);
+
+            context.numFramesInFlight++;
+            pool.addJob (new FrameJob (context, frame, std::move (channelLevels)), true);
+        }
+
+        while (context.numFramesInFlight.load() > 0)
+            context.frameFinished.wait (10);
+    }
+
+    return !readFailed && !context.failed;
+}
+
+bool OfflineMeterRenderer::renderFile (
+    const juce::File& audioFile,
+    juce::AudioFormatManager& formatManager,
+    const juce::File& outputDirectory,
+    const LevelMeter::Scale& scale,
+    const Options& options)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (audioFile));
+    if (reader == nullptr || outputDirectory.createDirectory().failed())
+        return false;
+
+    return render (
+        *reader,
+        [&outputDirectory] (int64_t const frameIndex, const juce::Image& image) {
+            juce::FileOutputStream stream (outputDirectory.getChildFile (getFrameFileName (frameIndex)));
+
+            // The stream appends to an existing file, which might be a frame of a previous rendering.
+            if (!stream.openedOk() || !stream.setPosition (0) || stream.truncate().failed())
+                return false;
+
+            juce::PNGImageFormat pngFormat;
+            return pngFormat.writeImageToStream (image, stream);
+        },
+        scale,
+        options);
+}
+
+juce::String OfflineMeterRenderer::getFrameFileName (int64_t const frameIndex)
+{
+    return "frame_" + juce::String (static_cast<juce::int64> (frameIndex)).paddedLeft ('0', 6) + ".png";
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "LevelMeterComponent.h"
+
+#include <functional>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * Renders a level meter for a stretch of audio into a sequence of images at a fixed frame rate, for example to overlay
+ * the meter on exported programme video. The meter runs on a VirtualMeterClock which advances a frame at a time, so
+ * rendering runs as fast as the CPU allows instead of in realtime.
+ *
+ * The ballistics of the meter carry over from frame to frame, so the audio gets read and the meter gets stepped on the
+ * calling thread. Every frame then becomes a job which draws a snapshot of the levels and writes the image, on a thread
+ * pool. The number of frames in flight is limited, so memory usage doesn't depend on the length of the audio.
+ */
+class OfflineMeterRenderer
+{
+public:
+    /**
+     * Options to configure the rendering.
+     */
+    struct Options
+    {
+        /// The number of frames per second.
+        double frameRate = 30.0;
+
+        /// The size of the images in pixels. The meter is horizontal when the images are wider than high.
+        int width = 40;
+        int height = 300;
+
+        /// The max number of channels to show. If the audio has more channels, they get folded into a single channel.
+        int maxChannels = LevelMeter::Subscriber::kDefaultMaxChannels;
+
+        /// The number of threads drawing and writing frames, or 0 for one thread per CPU.
+        int numThreads = 0;
+
+        /// The max number of frames being drawn or written at any moment, or 0 for four per thread.
+        int maxFramesInFlight = 0;
+
+        /**
+         * @returns The default options.
+         */
+        static Options getDefault();
+    };
+
+    /// Writes the image of a frame, returning false on failure (which stops the rendering). Gets called from multiple
+    /// threads at once, for different frames in no particular order.
+    using FrameWriter = std::function<bool (int64_t frameIndex, const juce::Image& image)>;
+
+    /**
+     * Renders the meter for all audio of given reader, calling given writer for every frame. Every frame shows the
+     * meter at the end of its stretch of audio. Returns when all frames are written.
+     * @param reader The audio to render the meter for. Only read from the calling thread.
+     * @param writeFrame Writes the image of a frame.
+     * @param scale The scale of the meter.
+     * @param options The options for the rendering.
+     * @return True if all frames were written, or false if reading or writing failed.
+     */
+    static bool render (
+        juce::AudioFormatReader& reader,
+        const FrameWriter& writeFrame,
+        const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale(),
+        const Options& options = Options::getDefault());
+
+    /**
+     * Renders the meter for an audio file into a directory of PNG files, named by getFrameFileName().
+     * @param audioFile The file to render the meter for.
+     * @param formatManager The format manager to create a reader with.
+     * @param outputDirectory The directory to write the images to, which gets created if it doesn't exist.
+     * @param scale The scale of the meter.
+     * @param options The options for the rendering.
+     * @return True if all frames were written, or false if the file couldn't be read or a frame couldn't be written.
+     */
+    static bool renderFile (
+        const juce::File& audioFile,
+        juce::AudioFormatManager& formatManager,
+        const juce::File& outputDirectory,
+        const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale(),
+        const Options& options = Options::getDefault());
+
+    /**
+     * @param frameIndex The index of the frame.
+     * @return The name of the image file of given frame, as written by renderFile().
+     */
+    static juce::String getFrameFileName (int64_t frameIndex);
+
+private:
+    struct RenderContext;
+    class FrameJob;
+    class FrameSubscriber;
+};
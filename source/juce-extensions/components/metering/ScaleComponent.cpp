@@ -1,12 +1,89 @@
 #include "ScaleComponent.h"
 #include "LevelMeterComponent.h"
 
+/**
+ * Renders the scale on the worker threads. The scale never changes, so there's nothing to take a snapshot of.
+ */
+class ScaleComponent::BackgroundTarget final : public BackgroundRenderer::Target
+{
+public:
+    explicit BackgroundTarget (ScaleComponent& scaleComponent) :
+        Target (scaleComponent),
+        mScaleComponent (scaleComponent)
+    {
+    }
+
+    ~BackgroundTarget() override
+    {
+        stopRendering();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (BackgroundTarget)
+    JUCE_DECLARE_NON_MOVEABLE (BackgroundTarget)
+
+private:
+    ScaleComponent& mScaleComponent;
+
+    // MARK: BackgroundRenderer::Target overrides -
+    void takeSnapshot() override {}
+
+    void renderSnapshot (juce::Graphics& g, juce::Rectangle<int> const bounds) override
+    {
+        drawScale (g, bounds, mScaleComponent.mScale);
+    }
+};
+
+ScaleComponent::ScaleComponent (const LevelMeter::Scale& scale) : mScale (scale)
+{
+}
+
+ScaleComponent::~ScaleComponent()
+{
+    // Waits for a render in flight, which reads the scale of this component.
+    mBackgroundTarget.reset();
+}
+
+void ScaleComponent::setRenderingMode (LevelMeterComponent::RenderingMode const renderingMode)
+{
+    auto const isRenderingOnWorkerThreads = renderingMode == LevelMeterComponent::RenderingMode::workerThreads;
+
+    if (isRenderingOnWorkerThreads == (mBackgroundTarget != nullptr))
+        return;
+
+    mBackgroundTarget = isRenderingOnWorkerThreads ? std::make_unique<BackgroundTarget> (*this) : nullptr;
+
+    if (mBackgroundTarget != nullptr)
+        mBackgroundTarget->requestRender();
+
+    repaint();
+}
+
 void ScaleComponent::paint (juce::Graphics& g)
 {
-    auto b = getLocalBounds().toFloat();
-    bool isHorizontal = getWidth() > getHeight();
+    if (mBackgroundTarget != nullptr)
+        mBackgroundTarget->drawRenderedImage (g);
+    else
+        drawScale (g, getLocalBounds(), mScale);
+}
+
+void ScaleComponent::resized()
+{
+    if (mBackgroundTarget != nullptr)
+        mBackgroundTarget->requestRender();
+}
+
+void ScaleComponent::visibilityChanged()
+{
+    if (mBackgroundTarget != nullptr)
+        mBackgroundTarget->requestRender();
+}
+
+void ScaleComponent::drawScale (juce::Graphics& g, juce::Rectangle<int> const bounds, const LevelMeter::Scale& scale)
+{
+    auto b = bounds.toFloat();
+    bool isHorizontal = bounds.getWidth() > bounds.getHeight();
 
-    const auto& divisions = mScale.getDivisions();
+    const auto& divisions = scale.getDivisions();
 
     const auto scaleLineLength = 6.f;
     for (auto division = divisions.begin(); division != divisions.end(); ++division)
@@ -18,7 +95,7 @@ void ScaleComponent::paint (juce::Graphics& g)
         if (isHorizontal)
         {
             auto xPos = b.getX() + (b.getWidth() - LevelMeterComponent::kOverloadAreaSize) *
-                                       mScale.calculateProportionForLevelDb (*division);
+                                       scale.calculateProportionForLevelDb (*division);
 
             if (!isFirst)
             {
@@ -37,7 +114,7 @@ void ScaleComponent::paint (juce::Graphics& g)
             const auto scaleNumberHeight = 20;
 
             auto yPos = b.getBottom() - (b.getHeight() - LevelMeterComponent::kOverloadAreaSize) *
-                                            mScale.calculateProportionForLevelDb (*division);
+                                            scale.calculateProportionForLevelDb (*division);
 
             if (!isFirst)
             {
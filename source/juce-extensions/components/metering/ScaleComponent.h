@@ -1,5 +1,7 @@
 #pragma once
 
+#include "LevelMeterComponent.h"
+
 #include <juce-extensions/audio/metering/LevelMeter.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 
@@ -9,10 +11,34 @@
 class ScaleComponent : public juce::Component
 {
 public:
-    explicit ScaleComponent (const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale()) : mScale (scale) {}
+    explicit ScaleComponent (const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale());
+
+    ~ScaleComponent() override;
+
+    /**
+     * Sets where the scale gets rasterised. On worker threads the scale only gets drawn when its size changes, paint()
+     * only draws the image.
+     * @param renderingMode The rendering mode.
+     */
+    void setRenderingMode (LevelMeterComponent::RenderingMode renderingMode);
+
+    /**
+     * Draws a scale. Thread safe, so it can be used by a BackgroundRenderer.
+     * @param g The graphics context to draw to.
+     * @param bounds The bounds of the scale.
+     * @param scale The scale to draw.
+     */
+    static void drawScale (juce::Graphics& g, juce::Rectangle<int> bounds, const LevelMeter::Scale& scale);
 
     void paint (juce::Graphics& g) override;
+    void resized() override;
+    void visibilityChanged() override;
 
 private:
+    class BackgroundTarget;
+
     const LevelMeter::Scale& mScale;
+
+    /// Only exists when rendering on worker threads.
+    std::unique_ptr<BackgroundTarget> mBackgroundTarget;
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "juce-extensions/audio/processing/FaderGainProcessor.h"
 #include <juce_gui_basics/juce_gui_basics.h>
 
 /**
@@ -46,6 +47,27 @@ public:
         return mScale.calculateProportionForLevelDb (value);
     }
 
+    /**
+     * Makes this slider drive the target of given gain processor, which must use the same scale. The target gets set
+     * right away and on every change of the value.
+     * @param gainProcessor The gain processor, or nullptr to stop driving one. It must outlive this slider, or be
+     * detached first.
+     */
+    void setGainProcessor (FaderGainProcessor* gainProcessor)
+    {
+        jassert (gainProcessor == nullptr || &gainProcessor->getScale() == &mScale); // The fader laws would differ.
+
+        mGainProcessor = gainProcessor;
+        valueChanged();
+    }
+
+    void valueChanged() override
+    {
+        if (mGainProcessor != nullptr)
+            mGainProcessor->setTargetProportion (valueToProportionOfLength (getValue()));
+    }
+
 private:
     const LevelMeter::Scale& mScale { LevelMeter::Scale::getDefaultScale() };
+    FaderGainProcessor* mGainProcessor = nullptr;
 };
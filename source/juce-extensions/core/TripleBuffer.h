@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Hands values from a single writer thread to a single reader thread without locks and without either side ever
+ * waiting for the other. The writer fills the back buffer and publishes it, the reader picks up the most recently
+ * published buffer. The third buffer sits in between, so both sides always have a buffer of their own.
+ * Values which get published faster than they are read are dropped, only the latest value is ever read.
+ * @tparam T The type of value. Allocate any storage up front (see prepare()) to keep publishing realtime safe.
+ */
+template <class T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    /**
+     * Assigns given value to all buffers. This is not thread safe and should only be used to (pre)allocate storage
+     * before the reader and writer start.
+     * @param value The value to assign.
+     */
+    void prepare (const T& value)
+    {
+        for (auto& buffer : mBuffers)
+            buffer = value;
+    }
+
+    /**
+     * @return The buffer to write to. Only to be called from the writer thread.
+     */
+    T& getWriteBuffer()
+    {
+        return mBuffers[mWriteIndex];
+    }
+
+    /**
+     * Publishes the write buffer, making it available to the reader. Only to be called from the writer thread.
+     */
+    void publish()
+    {
+        auto const middle = static_cast<uint8_t> (mWriteIndex | kNewDataFlag);
+        auto const previous = mMiddle.exchange (middle, std::memory_order_acq_rel);
+        mWriteIndex = previous & kIndexMask;
+    }
+
+    /**
+     * Picks up the most recently published buffer, if any. Only to be called from the reader thread.
+     * @return True if a new buffer was picked up, or false if nothing was published since the previous call.
+     */
+    bool update()
+    {
+        if ((mMiddle.load (std::memory_order_relaxed) & kNewDataFlag) == 0)
+            return false;
+
+        auto const previous = mMiddle.exchange (static_cast<uint8_t> (mReadIndex), std::memory_order_acq_rel);
+        mReadIndex = previous & kIndexMask;
+        return true;
+    }
+
+    /**
+     * @return The buffer which was picked up by the last call to update(). Only to be called from the reader thread.
+     */
+    const T& getReadBuffer() const
+    {
+        return mBuffers[mReadIndex];
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kNewDataFlag = 0x4;
+
+    std::array<T, 3> mBuffers {};
+
+    /// Index of the buffer between the writer and the reader, and whether it holds data the reader hasn't seen yet.
+    std::atomic<uint8_t> mMiddle { 1 };
+
+    /// Only accessed by the writer.
+    uint8_t mWriteIndex = 0;
+
+    /// Only accessed by the reader.
+    uint8_t mReadIndex = 2;
+};